@@ -0,0 +1,183 @@
+/*
+ * Benchmark of the face flux gather through vmapM/vmapP for the element
+ * orderings of bfam_pxest_elem_order_t
+ *
+ * For N = 3 to 7 (1 to 7 in 2D) the rotated cubes mesh (the star in 2D) is
+ * refined uniformly to the given level and split once with the elements in
+ * split order and once in reverse Cuthill-McKee order. For each ordering a
+ * flux kernel summing (q^- - q^+) over the fields is timed, and the mean and
+ * largest distance |k^- - k^+| between the two elements of a face node are
+ * reported; the latter is the bandwidth which reverse Cuthill-McKee reduces.
+ *
+ * The cache misses are measured by running a single ordering under perf, e.g.,
+ *
+ *   perf stat -e cache-misses,cache-references bench/gather3d 4 9 50 split
+ *   perf stat -e cache-misses,cache-references bench/gather3d 4 9 50 rcm
+ *
+ * usage: mpirun -np <ranks> bench/gather<dim>d [level [fields [reps [order]]]]
+ *   with order one of split, rcm, or both (default)
+ */
+#include <bfam.h>
+#include <math.h>
+
+#if BFAM_DGX_DIMENSION == 2
+#define BENCH_N_MIN 1
+#else
+#define BENCH_N_MIN 3
+#endif
+#define BENCH_N_MAX 7
+
+typedef struct
+{
+  double gather; /* flux through vmapM/vmapP */
+  double dist;   /* sum of the element distances */
+  int band;      /* largest element distance */
+  long nodes;    /* face nodes */
+} bench_gather_t;
+
+static void bench_gather_sub(bfam_subdomain_dgx_t *sub, const int num_fields,
+                             const int reps, bench_gather_t *b)
+{
+  const size_t nv = (size_t)sub->K * sub->Np;
+  const size_t nf = (size_t)sub->K * sub->Ngp[0] * sub->Ng[0];
+  bfam_real_t *q = bfam_malloc_aligned(num_fields * nv * sizeof(bfam_real_t));
+  bfam_real_t *flux = bfam_malloc_aligned(nf * sizeof(bfam_real_t));
+
+  for (size_t n = 0; n < num_fields * nv; ++n)
+    q[n] = (bfam_real_t)sin(0.001 * (double)n);
+
+  /* the first repetition warms up the caches and is not timed */
+  for (int r = 0; r <= reps; ++r)
+  {
+    const double t0 = MPI_Wtime();
+    for (size_t n = 0; n < nf; ++n)
+    {
+      bfam_real_t a = 0;
+      for (int f = 0; f < num_fields; ++f)
+      {
+        const bfam_real_t *restrict qf = q + f * nv;
+        a += (f + 1) * (qf[sub->vmapM[n]] - qf[sub->vmapP[n]]);
+      }
+      flux[n] = a;
+    }
+    const double t1 = MPI_Wtime();
+    if (r > 0)
+      b->gather += (t1 - t0) / reps;
+  }
+
+  for (size_t n = 0; n < nf; ++n)
+  {
+    const int d = abs(sub->vmapM[n] / sub->Np - sub->vmapP[n] / sub->Np);
+    b->dist += d;
+    b->band = BFAM_MAX(b->band, d);
+  }
+  b->nodes += (long)nf;
+
+  bfam_free_aligned(q);
+  bfam_free_aligned(flux);
+}
+
+static void bench_gather(const int N, const int level, const int num_fields,
+                         const int reps, const bfam_pxest_elem_order_t order,
+                         double *gather, double *dist, int *band)
+{
+#if BFAM_DGX_DIMENSION == 2
+  p4est_connectivity_t *conn = p4est_connectivity_new_star();
+#else
+  p4est_connectivity_t *conn = p8est_connectivity_new_rotcubes();
+#endif
+  bfam_domain_pxest_t *domain =
+      bfam_domain_pxest_new_ext(MPI_COMM_WORLD, conn, 0, level, 1);
+  p4est_t *pxest = domain->pxest;
+  domain->elem_order = order;
+
+  for (p4est_topidx_t t = pxest->first_local_tree; t <= pxest->last_local_tree;
+       ++t)
+  {
+    p4est_tree_t *tree = p4est_tree_array_index(pxest->trees, t);
+    for (size_t z = 0; z < tree->quadrants.elem_count; ++z)
+    {
+      p4est_quadrant_t *quad = p4est_quadrant_array_index(&tree->quadrants, z);
+      bfam_pxest_user_data_t *ud = quad->p.user_data;
+      ud->N = ud->Nold = (int8_t)N;
+      for (int f = 0; f < 2 * BFAM_DGX_DIMENSION; ++f)
+        ud->glue_id[f] = -1;
+    }
+  }
+
+  bfam_locidx_t num_subs, *sub_ids, *roots, *glue_ids;
+  int *sub_N;
+  bfam_domain_pxest_compute_split(pxest, 0, &num_subs, &sub_ids, &roots,
+                                  &sub_N, &glue_ids);
+  bfam_domain_pxest_split_dgx_subdomains(domain, num_subs, sub_ids, roots,
+                                         sub_N, glue_ids, NULL, NULL);
+
+  bench_gather_t b = {0, 0, 0, 0};
+  for (bfam_locidx_t s = 0; s < domain->base.num_subdomains; ++s)
+  {
+    bfam_subdomain_dgx_t *sub =
+        (bfam_subdomain_dgx_t *)domain->base.subdomains[s];
+    if (bfam_subdomain_has_tag(&sub->base, "_volume"))
+      bench_gather_sub(sub, num_fields, reps, &b);
+  }
+
+  /* slowest rank, mean distance over all face nodes, largest bandwidth */
+  double sum[2] = {b.dist, (double)b.nodes}, glo[2];
+  MPI_Reduce(&b.gather, gather, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+  MPI_Reduce(sum, glo, 2, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce(&b.band, band, 1, MPI_INT, MPI_MAX, 0, MPI_COMM_WORLD);
+  *dist = glo[0] / BFAM_MAX(glo[1], 1);
+
+  bfam_domain_pxest_free(domain);
+  bfam_free(domain);
+  p4est_connectivity_destroy(conn);
+}
+
+int main(int argc, char *argv[])
+{
+  MPI_Init(&argc, &argv);
+  int rank;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  bfam_log_init(rank, stdout, BFAM_LL_ERROR);
+  sc_init(MPI_COMM_WORLD, 0, 0, NULL, SC_LP_ERROR);
+  p4est_init(NULL, SC_LP_ERROR);
+
+  const int level = (argc > 1) ? atoi(argv[1]) : 3;
+  const int num_fields = (argc > 2) ? atoi(argv[2]) : 9;
+  const int reps = (argc > 3) ? atoi(argv[3]) : 20;
+  const char *order = (argc > 4) ? argv[4] : "both";
+  const int run_split = strcmp(order, "rcm") != 0;
+  const int run_rcm = strcmp(order, "split") != 0;
+  BFAM_ABORT_IF(!run_split && !run_rcm, "unknown order %s", order);
+
+  if (rank == 0)
+  {
+    printf("%d fields, level %d, %d repetitions, times in ms\n", num_fields,
+           level, reps);
+    printf("%3s %10s %10s %8s %10s %10s %10s %10s\n", "N", "split flux",
+           "rcm flux", "speedup", "split dist", "rcm dist", "split band",
+           "rcm band");
+  }
+
+  for (int N = BENCH_N_MIN; N <= BENCH_N_MAX; ++N)
+  {
+    double t_split = 0, t_rcm = 0, d_split = 0, d_rcm = 0;
+    int b_split = 0, b_rcm = 0;
+    if (run_split)
+      bench_gather(N, level, num_fields, reps, BFAM_PXEST_ELEM_ORDER_SPLIT,
+                   &t_split, &d_split, &b_split);
+    if (run_rcm)
+      bench_gather(N, level, num_fields, reps, BFAM_PXEST_ELEM_ORDER_RCM,
+                   &t_rcm, &d_rcm, &b_rcm);
+
+    if (rank == 0)
+      printf("%3d %10.3f %10.3f %8.2f %10.1f %10.1f %10d %10d\n", N,
+             1e3 * t_split, 1e3 * t_rcm,
+             (run_split && run_rcm) ? t_split / t_rcm : 0, d_split, d_rcm,
+             b_split, b_rcm);
+  }
+
+  sc_finalize();
+  MPI_Finalize();
+  return EXIT_SUCCESS;
+}
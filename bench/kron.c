@@ -0,0 +1,134 @@
+/*
+ * Benchmark of the Kronecker product kernels specialized for the orders
+ * N = 1 to 12 against the generic kernels taking the number of points at
+ * runtime
+ *
+ * For each order the volume kernels of the dimension (the 4 operators and
+ * their _pe variants in 2D, the 6 operators and their _pe variants in 3D)
+ * are applied to as many elements as fit in the given number of points, and
+ * the GFLOP/s of both tables are reported, counting 2 (N+1)^(dim+1) flops
+ * per element and kernel. The outputs of the two tables are compared.
+ *
+ * usage: bench/kron<dim>d [points [reps]]
+ */
+#include <bfam.h>
+#include <math.h>
+
+#define BENCH_N_MIN 1
+#define BENCH_N_MAX 12
+
+#if BFAM_DGX_DIMENSION == 2
+#define BENCH_NUM_KERNELS 8
+#define BENCH_KERNELS(k)                                                       \
+  {                                                                            \
+    (k)->ixa, (k)->ixat, (k)->axi, (k)->atxi, (k)->ixa_pe, (k)->ixat_pe,       \
+        (k)->axi_pe, (k)->atxi_pe                                              \
+  }
+#else
+#define BENCH_NUM_KERNELS 12
+#define BENCH_KERNELS(k)                                                       \
+  {                                                                            \
+    (k)->axixi, (k)->atxixi, (k)->ixaxi, (k)->ixatxi, (k)->ixixa,              \
+        (k)->ixixat, (k)->axixi_pe, (k)->atxixi_pe, (k)->ixaxi_pe,             \
+        (k)->ixatxi_pe, (k)->ixixa_pe, (k)->ixixat_pe                          \
+  }
+#endif
+
+/* seconds per application of all the kernels to the K elements */
+static double bench_kron(const bfam_kron_kernels_t *kron, const int Nq,
+                         const int Np, const bfam_locidx_t K, const int reps,
+                         const bfam_real_t *A, const bfam_real_t *x,
+                         bfam_real_t *y)
+{
+  const bfam_kron_kernel_t kernels[BENCH_NUM_KERNELS] = BENCH_KERNELS(kron);
+  double time = 0;
+
+  /* the first repetition warms up the caches and is not timed */
+  for (int r = 0; r <= reps; ++r)
+  {
+    /* the _pe kernels add to y, so start each repetition from zero */
+    memset(y, 0, BENCH_NUM_KERNELS * (size_t)K * Np * sizeof(bfam_real_t));
+
+    const double t0 = MPI_Wtime();
+    for (int i = 0; i < BENCH_NUM_KERNELS; ++i)
+    {
+      bfam_real_t *yi = y + i * (size_t)K * Np;
+      for (bfam_locidx_t k = 0; k < K; ++k)
+        kernels[i](Nq, A, x + k * Np, yi + k * Np);
+    }
+    const double t1 = MPI_Wtime();
+    if (r > 0)
+      time += (t1 - t0) / reps;
+  }
+
+  return time;
+}
+
+int main(int argc, char *argv[])
+{
+  MPI_Init(&argc, &argv);
+  int rank;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  bfam_log_init(rank, stdout, BFAM_LL_ERROR);
+
+  const long points = (argc > 1) ? atol(argv[1]) : 1L << 18;
+  const int reps = (argc > 2) ? atoi(argv[2]) : 20;
+
+  if (rank == 0)
+  {
+    printf("%ld points, %d repetitions, %d kernels\n", points, reps,
+           BENCH_NUM_KERNELS);
+    printf("%3s %10s %14s %14s %10s %12s\n", "N", "elements",
+           "generic GF/s", "special GF/s", "speedup", "rel diff");
+  }
+
+  for (int N = BENCH_N_MIN; N <= BENCH_N_MAX; ++N)
+  {
+    const int Nq = N + 1;
+    int Np = Nq;
+    for (int d = 1; d < BFAM_DGX_DIMENSION; ++d)
+      Np *= Nq;
+    const bfam_locidx_t K = (bfam_locidx_t)BFAM_MAX(points / Np, 1);
+    const size_t ny = BENCH_NUM_KERNELS * (size_t)K * Np;
+
+    bfam_real_t *A = bfam_malloc_aligned(Nq * Nq * sizeof(bfam_real_t));
+    bfam_real_t *x = bfam_malloc_aligned((size_t)K * Np * sizeof(bfam_real_t));
+    bfam_real_t *y0 = bfam_malloc_aligned(ny * sizeof(bfam_real_t));
+    bfam_real_t *y1 = bfam_malloc_aligned(ny * sizeof(bfam_real_t));
+
+    for (int n = 0; n < Nq * Nq; ++n)
+      A[n] = (bfam_real_t)cos(0.7 * n);
+    for (size_t n = 0; n < (size_t)K * Np; ++n)
+      x[n] = (bfam_real_t)sin(0.001 * (double)n);
+
+    const double t_gen = bench_kron(bfam_kron_get_generic_kernels(), Nq, Np,
+                                    K, reps, A, x, y0);
+    const double t_spec =
+        bench_kron(bfam_kron_get_kernels(N), Nq, Np, K, reps, A, x, y1);
+
+    /* the specialized kernels may sum in another order */
+    double diff = 0, scale = 0;
+    for (size_t n = 0; n < ny; ++n)
+    {
+      diff = BFAM_MAX(diff, fabs(y0[n] - y1[n]));
+      scale = BFAM_MAX(scale, fabs(y0[n]));
+    }
+    diff /= BFAM_MAX(scale, BFAM_REAL_MIN);
+
+    const double flops =
+        2.0 * BENCH_NUM_KERNELS * (double)K * Np * Nq / 1e9;
+    if (rank == 0)
+      printf("%3d %10ld %14.2f %14.2f %10.2f %12.2e\n", N, (long)K,
+             flops / t_gen, flops / t_spec, t_gen / t_spec, diff);
+    BFAM_ABORT_IF(diff > 100 * Nq * BFAM_REAL_EPS,
+                  "N %d: specialized kernels differ by %e", N, diff);
+
+    bfam_free_aligned(A);
+    bfam_free_aligned(x);
+    bfam_free_aligned(y0);
+    bfam_free_aligned(y1);
+  }
+
+  MPI_Finalize();
+  return EXIT_SUCCESS;
+}
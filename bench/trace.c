@@ -0,0 +1,190 @@
+/*
+ * Benchmark of the face flux gathers through vmapM/vmapP against the
+ * face-major trace storage (bfam_subdomain_dgx_trace_t)
+ *
+ * For N = 3 to 7 (1 to 7 in 2D) the rotated cubes mesh (the star in 2D) is
+ * refined uniformly to the given level and a flux kernel summing
+ * (q^- - q^+) over the fields is timed when gathering through the maps, and
+ * when reading the lifted traces linearly. The lift itself is timed
+ * separately, since it is amortized over all the face kernels which use the
+ * same traces.
+ *
+ * usage: mpirun -np <ranks> bench/trace<dim>d [level [fields [reps]]]
+ */
+#include <bfam.h>
+#include <math.h>
+
+#if BFAM_DGX_DIMENSION == 2
+#define BENCH_N_MIN 1
+#else
+#define BENCH_N_MIN 3
+#endif
+#define BENCH_N_MAX 7
+
+typedef struct
+{
+  double gather; /* flux through vmapM/vmapP */
+  double lift;   /* lift of the minus and plus traces */
+  double linear; /* flux from the lifted traces */
+  double err;    /* largest difference of the two fluxes */
+  long nodes;    /* face nodes */
+} bench_trace_t;
+
+static void bench_trace_sub(bfam_subdomain_dgx_t *sub, const int num_fields,
+                            const int reps, bench_trace_t *b)
+{
+  bfam_subdomain_dgx_trace_t trace;
+  bfam_subdomain_dgx_trace_init(&trace, sub);
+
+  const size_t nv = (size_t)sub->K * sub->Np;
+  const size_t nf = (size_t)sub->K * trace.Nfaces * trace.Nfp;
+  bfam_real_t *q = bfam_malloc_aligned(num_fields * nv * sizeof(bfam_real_t));
+  bfam_real_t *qM = bfam_malloc_aligned(num_fields * nf * sizeof(bfam_real_t));
+  bfam_real_t *qP = bfam_malloc_aligned(num_fields * nf * sizeof(bfam_real_t));
+  bfam_real_t *f0 = bfam_malloc_aligned(nf * sizeof(bfam_real_t));
+  bfam_real_t *f1 = bfam_malloc_aligned(nf * sizeof(bfam_real_t));
+
+  for (size_t n = 0; n < num_fields * nv; ++n)
+    q[n] = (bfam_real_t)sin(0.001 * (double)n);
+
+  /* the first repetition warms up the caches and is not timed */
+  for (int r = 0; r <= reps; ++r)
+  {
+    const double t0 = MPI_Wtime();
+    for (size_t n = 0; n < nf; ++n)
+    {
+      bfam_real_t flux = 0;
+      for (int f = 0; f < num_fields; ++f)
+      {
+        const bfam_real_t *restrict qf = q + f * nv;
+        flux += (f + 1) * (qf[sub->vmapM[n]] - qf[sub->vmapP[n]]);
+      }
+      f0[n] = flux;
+    }
+
+    const double t1 = MPI_Wtime();
+    for (int f = 0; f < num_fields; ++f)
+      bfam_subdomain_dgx_trace_lift(sub, &trace, q + f * nv, qM + f * nf,
+                                    qP + f * nf);
+
+    const double t2 = MPI_Wtime();
+    for (size_t n = 0; n < nf; ++n)
+    {
+      bfam_real_t flux = 0;
+      for (int f = 0; f < num_fields; ++f)
+        flux += (f + 1) * (qM[f * nf + n] - qP[f * nf + n]);
+      f1[n] = flux;
+    }
+
+    const double t3 = MPI_Wtime();
+    if (r > 0)
+    {
+      b->gather += (t1 - t0) / reps;
+      b->lift += (t2 - t1) / reps;
+      b->linear += (t3 - t2) / reps;
+    }
+  }
+
+  for (size_t n = 0; n < nf; ++n)
+    b->err = BFAM_MAX(b->err, fabs(f0[n] - f1[n]));
+  b->nodes += (long)nf;
+
+  bfam_free_aligned(q);
+  bfam_free_aligned(qM);
+  bfam_free_aligned(qP);
+  bfam_free_aligned(f0);
+  bfam_free_aligned(f1);
+  bfam_subdomain_dgx_trace_free(&trace);
+}
+
+int main(int argc, char *argv[])
+{
+  MPI_Init(&argc, &argv);
+  int rank;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  bfam_log_init(rank, stdout, BFAM_LL_ERROR);
+  sc_init(MPI_COMM_WORLD, 0, 0, NULL, SC_LP_ERROR);
+  p4est_init(NULL, SC_LP_ERROR);
+
+  const int level = (argc > 1) ? atoi(argv[1]) : 3;
+  const int num_fields = (argc > 2) ? atoi(argv[2]) : 9;
+  const int reps = (argc > 3) ? atoi(argv[3]) : 20;
+
+  if (rank == 0)
+  {
+    printf("%d fields, level %d, %d repetitions, times in ms\n", num_fields,
+           level, reps);
+    printf("%3s %12s %12s %12s %12s %12s\n", "N", "face nodes", "vmap flux",
+           "linear flux", "lift", "break even");
+  }
+
+  for (int N = BENCH_N_MIN; N <= BENCH_N_MAX; ++N)
+  {
+#if BFAM_DGX_DIMENSION == 2
+    p4est_connectivity_t *conn = p4est_connectivity_new_star();
+#else
+    p4est_connectivity_t *conn = p8est_connectivity_new_rotcubes();
+#endif
+    bfam_domain_pxest_t *domain =
+        bfam_domain_pxest_new_ext(MPI_COMM_WORLD, conn, 0, level, 1);
+    p4est_t *pxest = domain->pxest;
+
+    for (p4est_topidx_t t = pxest->first_local_tree;
+         t <= pxest->last_local_tree; ++t)
+    {
+      p4est_tree_t *tree = p4est_tree_array_index(pxest->trees, t);
+      for (size_t z = 0; z < tree->quadrants.elem_count; ++z)
+      {
+        p4est_quadrant_t *quad =
+            p4est_quadrant_array_index(&tree->quadrants, z);
+        bfam_pxest_user_data_t *ud = quad->p.user_data;
+        ud->N = ud->Nold = (int8_t)N;
+        for (int f = 0; f < 2 * BFAM_DGX_DIMENSION; ++f)
+          ud->glue_id[f] = -1;
+      }
+    }
+
+    bfam_locidx_t num_subs, *sub_ids, *roots, *glue_ids;
+    int *sub_N;
+    bfam_domain_pxest_compute_split(pxest, 0, &num_subs, &sub_ids, &roots,
+                                    &sub_N, &glue_ids);
+    bfam_domain_pxest_split_dgx_subdomains(domain, num_subs, sub_ids, roots,
+                                           sub_N, glue_ids, NULL, NULL);
+
+    bench_trace_t b = {0, 0, 0, 0, 0};
+    for (bfam_locidx_t s = 0; s < domain->base.num_subdomains; ++s)
+    {
+      bfam_subdomain_dgx_t *sub =
+          (bfam_subdomain_dgx_t *)domain->base.subdomains[s];
+      if (bfam_subdomain_has_tag(&sub->base, "_volume"))
+        bench_trace_sub(sub, num_fields, reps, &b);
+    }
+
+    /* slowest rank */
+    double loc[4] = {b.gather, b.lift, b.linear, b.err}, glo[4];
+    long nodes;
+    MPI_Reduce(loc, glo, 4, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&b.nodes, &nodes, 1, MPI_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+
+    /* face kernels reading the same traces for the lift to pay off */
+    const double gain = glo[0] - glo[2];
+    if (rank == 0)
+    {
+      printf("%3d %12ld %12.3f %12.3f %12.3f", N, nodes, 1e3 * glo[0],
+             1e3 * glo[2], 1e3 * glo[1]);
+      if (gain > 0)
+        printf(" %12.1f\n", glo[1] / gain);
+      else
+        printf(" %12s\n", "never");
+    }
+    BFAM_ABORT_IF(glo[3] > 0, "flux difference %e", glo[3]);
+
+    bfam_domain_pxest_free(domain);
+    bfam_free(domain);
+    p4est_connectivity_destroy(conn);
+  }
+
+  sc_finalize();
+  MPI_Finalize();
+  return EXIT_SUCCESS;
+}
@@ -223,6 +223,145 @@ void bfam_free_aligned(void *ptr)
   free(ptr);
 }
 
+/* smallest buffer of an arena */
+#define BFAM_ARENA_MIN_SIZE (64 * 1024)
+#define BFAM_ARENA_ALIGN 64
+
+void bfam_arena_init(bfam_arena_t *arena)
+{
+  memset(arena, 0, sizeof(bfam_arena_t));
+}
+
+void bfam_arena_free(bfam_arena_t *arena)
+{
+  bfam_arena_release(arena, 0);
+  if (arena->buf)
+    bfam_free_aligned(arena->buf);
+  bfam_free(arena->spill);
+  bfam_free(arena->spill_mark);
+  bfam_arena_init(arena);
+}
+
+void *bfam_arena_alloc(bfam_arena_t *arena, size_t size)
+{
+  size = (size + BFAM_ARENA_ALIGN - 1) / BFAM_ARENA_ALIGN * BFAM_ARENA_ALIGN;
+
+  /* grow the buffer while nothing is in it */
+  if (arena->top == 0 && arena->size < BFAM_MAX(arena->high, size))
+  {
+    if (arena->buf)
+      bfam_free_aligned(arena->buf);
+    arena->size = BFAM_MAX(BFAM_MAX(arena->high, size), BFAM_ARENA_MIN_SIZE);
+    arena->buf = bfam_malloc_aligned(arena->size);
+  }
+
+  void *ptr;
+  if (arena->num_spill == 0 && arena->used + size <= arena->size)
+  {
+    ptr = arena->buf + arena->used;
+    arena->used += size;
+  }
+  else
+  {
+    if (arena->num_spill == arena->max_spill)
+    {
+      arena->max_spill = BFAM_MAX(2 * arena->max_spill, 8);
+      arena->spill =
+          bfam_realloc(arena->spill, arena->max_spill * sizeof(void *));
+      arena->spill_mark =
+          bfam_realloc(arena->spill_mark, arena->max_spill * sizeof(size_t));
+    }
+    ptr = bfam_malloc_aligned(BFAM_MAX(size, 1));
+    arena->spill[arena->num_spill] = ptr;
+    arena->spill_mark[arena->num_spill] = arena->top;
+    ++arena->num_spill;
+  }
+
+  arena->top += size;
+  arena->high = BFAM_MAX(arena->high, arena->top);
+
+  return ptr;
+}
+
+size_t bfam_arena_mark(const bfam_arena_t *arena) { return arena->top; }
+
+void bfam_arena_release(bfam_arena_t *arena, size_t mark)
+{
+  BFAM_ASSERT(mark <= arena->top);
+
+  while (arena->num_spill > 0 &&
+         arena->spill_mark[arena->num_spill - 1] >= mark)
+    bfam_free_aligned(arena->spill[--arena->num_spill]);
+
+  arena->top = mark;
+  arena->used = BFAM_MIN(arena->used, mark);
+}
+
+/* the arena of a thread, on its own cache lines */
+typedef struct bfam_scratch
+{
+  bfam_arena_t arena;
+  struct bfam_scratch *next; /* next arena of bfam_scratch_list */
+} bfam_scratch_t;
+#define BFAM_SCRATCH_SIZE                                                      \
+  ((sizeof(bfam_scratch_t) + BFAM_ARENA_ALIGN - 1) / BFAM_ARENA_ALIGN *        \
+   BFAM_ARENA_ALIGN)
+
+/* all the arenas, so that bfam_scratch_free can release them */
+static bfam_scratch_t *bfam_scratch_list = NULL;
+/* bumped by bfam_scratch_free so that the threads drop their freed arenas */
+static unsigned bfam_scratch_generation = 0;
+static int bfam_scratch_atexit = 0;
+
+/* the arena of the calling thread; keyed on the thread rather than the
+ * OpenMP thread number, which is not unique in nested parallel regions */
+static __thread bfam_scratch_t *bfam_scratch_local = NULL;
+/* bfam_scratch_generation when bfam_scratch_local was made */
+static __thread unsigned bfam_scratch_local_generation = 0;
+
+bfam_arena_t *bfam_scratch_arena(void)
+{
+  bfam_scratch_t *scratch = bfam_scratch_local;
+  const unsigned generation =
+      __atomic_load_n(&bfam_scratch_generation, __ATOMIC_ACQUIRE);
+
+  if (scratch == NULL || bfam_scratch_local_generation != generation)
+  {
+    scratch = bfam_malloc_aligned(BFAM_SCRATCH_SIZE);
+    bfam_arena_init(&scratch->arena);
+
+    scratch->next = __atomic_load_n(&bfam_scratch_list, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&bfam_scratch_list, &scratch->next,
+                                        scratch, 1, __ATOMIC_RELEASE,
+                                        __ATOMIC_RELAXED))
+      ;
+
+    if (!__atomic_exchange_n(&bfam_scratch_atexit, 1, __ATOMIC_ACQ_REL))
+      BFAM_ABORT_IF(atexit(bfam_scratch_free),
+                    "Can't register bfam_scratch_free at exit");
+
+    bfam_scratch_local = scratch;
+    bfam_scratch_local_generation = generation;
+  }
+
+  return &scratch->arena;
+}
+
+void bfam_scratch_free(void)
+{
+  bfam_scratch_t *scratch =
+      __atomic_exchange_n(&bfam_scratch_list, NULL, __ATOMIC_ACQ_REL);
+  __atomic_add_fetch(&bfam_scratch_generation, 1, __ATOMIC_RELEASE);
+
+  while (scratch)
+  {
+    bfam_scratch_t *next = scratch->next;
+    bfam_arena_free(&scratch->arena);
+    bfam_free_aligned(scratch);
+    scratch = next;
+  }
+}
+
 /*
  * This signal handler code is a modified version of the one presented in
  *
@@ -1778,7 +1917,12 @@ int bfam_lua_global_function_call(lua_State *L, const char *name,
       lua_pushnumber(L, (double)va_arg(vl, bfam_long_real_t));
       break;
     case 'r':
+#ifdef BFAM_USE_FLOAT
+      /* float arguments are promoted to double */
+      lua_pushnumber(L, va_arg(vl, double));
+#else
       lua_pushnumber(L, (double)va_arg(vl, bfam_real_t));
+#endif
       break;
     case 'i':
       lua_pushinteger(L, va_arg(vl, int));
@@ -2213,26 +2357,37 @@ void bfam_domain_init(bfam_domain_t *thisDomain, MPI_Comm domComm)
   bfam_dictionary_init(&(thisDomain->name2num));
 }
 
-/** Clean up domain
+/** Free all the subdomains of a domain
  *
- * frees any mememory allocated by the domain and calls free command on all
- * subdomains
+ * The domain is left empty and new subdomains can be added to it.
  *
- * \param [in,out] domain domain to clean up
+ * \param [in,out] domain domain to clear
  */
-static void bfam_domain_free(bfam_domain_t *thisDomain)
+static void bfam_domain_clear_subdomains(bfam_domain_t *thisDomain)
 {
   for (bfam_locidx_t i = 0; i < thisDomain->num_subdomains; i++)
   {
     thisDomain->subdomains[i]->free(thisDomain->subdomains[i]);
     bfam_free(thisDomain->subdomains[i]);
   }
-  thisDomain->comm = MPI_COMM_NULL;
   thisDomain->num_subdomains = 0;
+  bfam_dictionary_clear(&thisDomain->name2num);
+}
+
+/** Clean up domain
+ *
+ * frees any mememory allocated by the domain and calls free command on all
+ * subdomains
+ *
+ * \param [in,out] domain domain to clean up
+ */
+static void bfam_domain_free(bfam_domain_t *thisDomain)
+{
+  bfam_domain_clear_subdomains(thisDomain);
+  thisDomain->comm = MPI_COMM_NULL;
   thisDomain->sizeSubdomains = 0;
   bfam_free(thisDomain->subdomains);
   thisDomain->subdomains = NULL;
-  bfam_dictionary_clear(&thisDomain->name2num);
 }
 
 static int bfam_domain_compare_subdomain_by_id(const void *a, const void *b)
@@ -2579,6 +2734,22 @@ static void bfam_communicator_init(bfam_communicator_t *communicator,
   communicator->recv_status =
       communicator->send_status + communicator->num_procs;
 
+  communicator->send_sub_offset =
+      bfam_malloc(2 * (communicator->num_procs + 1) * sizeof(bfam_locidx_t));
+  communicator->recv_sub_offset =
+      communicator->send_sub_offset + communicator->num_procs + 1;
+  communicator->send_sub_offset[0] = 0;
+  communicator->recv_sub_offset[0] = 0;
+
+  communicator->send_subs =
+      bfam_malloc(BFAM_MAX(2 * communicator->num_subs, 1) *
+                  sizeof(bfam_locidx_t));
+  communicator->recv_subs = communicator->send_subs + communicator->num_subs;
+
+  int provided;
+  BFAM_MPI_CHECK(MPI_Query_thread(&provided));
+  communicator->thread_multiple = provided == MPI_THREAD_MULTIPLE;
+
   for (int i = 0; communicator->num_procs > i; i++)
   {
     communicator->proc_data[i].send_sz = 0;
@@ -2614,6 +2785,8 @@ static void bfam_communicator_init(bfam_communicator_t *communicator,
     BFAM_ABORT_IF_NOT(communicator->proc_data[proc].rank == np,
                       "problem with local proc ID");
     communicator->proc_data[proc].send_sz += communicator->sub_data[t].send_sz;
+    communicator->send_subs[s] = t;
+    communicator->send_sub_offset[proc + 1] = s + 1;
 
     send_buf_ptr += communicator->sub_data[t].send_sz;
     send_offset += communicator->sub_data[t].send_sz;
@@ -2640,6 +2813,8 @@ static void bfam_communicator_init(bfam_communicator_t *communicator,
     BFAM_ABORT_IF_NOT(communicator->proc_data[proc].rank == np,
                       "problem with local proc ID");
     communicator->proc_data[proc].recv_sz += communicator->sub_data[t].recv_sz;
+    communicator->recv_subs[s] = t;
+    communicator->recv_sub_offset[proc + 1] = s + 1;
 
     recv_buf_ptr += communicator->sub_data[t].recv_sz;
     recv_offset += communicator->sub_data[t].recv_sz;
@@ -2674,8 +2849,485 @@ void bfam_communicator_free(bfam_communicator_t *communicator)
   bfam_free(communicator->proc_data);
   bfam_free(communicator->send_request);
   bfam_free(communicator->send_status);
+  bfam_free(communicator->send_sub_offset);
+  bfam_free(communicator->send_subs);
+}
+
+static int bfam_communicator_thread()
+{
+#ifdef _OPENMP
+  return omp_get_thread_num();
+#else
+  return 0;
+#endif
+}
+
+static void bfam_communicator_post_recv(bfam_communicator_t *comm,
+                                        bfam_locidx_t p)
+{
+  BFAM_MPI_CHECK(MPI_Irecv(comm->proc_data[p].recv_buf,
+                           (int)comm->proc_data[p].recv_sz, MPI_BYTE,
+                           comm->proc_data[p].rank, comm->tag, comm->comm,
+                           &comm->recv_request[p]));
+}
+
+static void bfam_communicator_post_send(bfam_communicator_t *comm,
+                                        bfam_locidx_t p)
+{
+  BFAM_MPI_CHECK(MPI_Isend(comm->proc_data[p].send_buf,
+                           (int)comm->proc_data[p].send_sz, MPI_BYTE,
+                           comm->proc_data[p].rank, comm->tag, comm->comm,
+                           &comm->send_request[p]));
+}
+
+static void bfam_communicator_buffers(bfam_communicator_t *comm,
+                                      const bfam_locidx_t *subs,
+                                      const bfam_locidx_t *offset,
+                                      bfam_locidx_t p,
+                                      bfam_communicator_buffer_t buffer,
+                                      void *arg)
+{
+  if (buffer == NULL)
+    return;
+
+  const int thread = bfam_communicator_thread();
+  for (bfam_locidx_t i = offset[p]; i < offset[p + 1]; ++i)
+    buffer(comm, subs[i], thread, arg);
+}
+
+void bfam_communicator_start(bfam_communicator_t *comm,
+                             bfam_communicator_buffer_t pack, void *arg)
+{
+  const bfam_locidx_t num_procs = comm->num_procs;
+
+  if (comm->thread_multiple)
+  {
+    BFAM_PRAGMA_OMP(parallel for schedule(dynamic, 1))
+    for (bfam_locidx_t p = 0; p < num_procs; ++p)
+    {
+      bfam_communicator_post_recv(comm, p);
+      bfam_communicator_buffers(comm, comm->send_subs, comm->send_sub_offset,
+                                p, pack, arg);
+      bfam_communicator_post_send(comm, p);
+    }
+    return;
+  }
+
+  for (bfam_locidx_t p = 0; p < num_procs; ++p)
+    bfam_communicator_post_recv(comm, p);
+
+  BFAM_PRAGMA_OMP(parallel for schedule(dynamic, 1))
+  for (bfam_locidx_t p = 0; p < num_procs; ++p)
+    bfam_communicator_buffers(comm, comm->send_subs, comm->send_sub_offset, p,
+                              pack, arg);
+
+  for (bfam_locidx_t p = 0; p < num_procs; ++p)
+    bfam_communicator_post_send(comm, p);
+}
+
+void bfam_communicator_finish(bfam_communicator_t *comm,
+                              bfam_communicator_buffer_t unpack, void *arg)
+{
+  const bfam_locidx_t num_procs = comm->num_procs;
+
+  if (comm->thread_multiple)
+  {
+    BFAM_PRAGMA_OMP(parallel)
+    {
+#ifdef _OPENMP
+      const int num_threads = omp_get_num_threads();
+#else
+      const int num_threads = 1;
+#endif
+      const int thread = bfam_communicator_thread();
+      const bfam_locidx_t p0 = num_procs * thread / num_threads;
+      const bfam_locidx_t p1 = num_procs * (thread + 1) / num_threads;
+
+      bfam_arena_t *scratch = bfam_scratch_arena();
+      const size_t mark = bfam_arena_mark(scratch);
+      int *done = bfam_arena_alloc(scratch, (p1 - p0) * sizeof(int));
+      MPI_Status *status =
+          bfam_arena_alloc(scratch, (p1 - p0) * sizeof(MPI_Status));
+
+      /* unpack the receives of this thread's share in the order they
+       * complete; completed requests become MPI_REQUEST_NULL so the loop
+       * ends with MPI_UNDEFINED once they all have */
+      for (;;)
+      {
+        int num_done;
+        BFAM_MPI_CHECK(MPI_Waitsome((int)(p1 - p0), comm->recv_request + p0,
+                                    &num_done, done, status));
+        if (num_done == MPI_UNDEFINED)
+          break;
+        for (int i = 0; i < num_done; ++i)
+        {
+          /* the statuses are in completion order */
+          comm->recv_status[p0 + done[i]] = status[i];
+          bfam_communicator_buffers(comm, comm->recv_subs,
+                                    comm->recv_sub_offset, p0 + done[i],
+                                    unpack, arg);
+        }
+      }
+
+      bfam_arena_release(scratch, mark);
+    }
+  }
+  else
+  {
+    BFAM_MPI_CHECK(
+        MPI_Waitall(num_procs, comm->recv_request, comm->recv_status));
+
+    BFAM_PRAGMA_OMP(parallel for schedule(dynamic, 1))
+    for (bfam_locidx_t p = 0; p < num_procs; ++p)
+      bfam_communicator_buffers(comm, comm->recv_subs, comm->recv_sub_offset,
+                                p, unpack, arg);
+  }
+
+  BFAM_MPI_CHECK(MPI_Waitall(num_procs, comm->send_request, comm->send_status));
+}
+
+// }}}
+
+// {{{ dag
+void bfam_dag_init(bfam_dag_t *dag) { memset(dag, 0, sizeof(bfam_dag_t)); }
+
+void bfam_dag_free(bfam_dag_t *dag)
+{
+  bfam_free(dag->nodes);
+  bfam_free(dag->edges);
+  bfam_dag_init(dag);
+}
+
+void bfam_dag_clear(bfam_dag_t *dag)
+{
+  dag->num_nodes = 0;
+  dag->num_edges = 0;
+}
+
+static bfam_locidx_t bfam_dag_add_node(bfam_dag_t *dag)
+{
+  if (dag->num_nodes == dag->max_nodes)
+  {
+    dag->max_nodes = BFAM_MAX(2 * dag->max_nodes, 16);
+    dag->nodes =
+        bfam_realloc(dag->nodes, dag->max_nodes * sizeof(bfam_dag_node_t));
+  }
+
+  bfam_dag_node_t *node = dag->nodes + dag->num_nodes;
+  node->task = NULL;
+  node->arg = NULL;
+  node->index = 0;
+  node->request = NULL;
+  node->pending = 0;
+
+  return dag->num_nodes++;
+}
+
+bfam_locidx_t bfam_dag_add_task(bfam_dag_t *dag, bfam_dag_task_t task,
+                                void *arg, bfam_locidx_t index)
+{
+  BFAM_ASSERT(task);
+  const bfam_locidx_t n = bfam_dag_add_node(dag);
+  dag->nodes[n].task = task;
+  dag->nodes[n].arg = arg;
+  dag->nodes[n].index = index;
+  return n;
+}
+
+bfam_locidx_t bfam_dag_add_request(bfam_dag_t *dag, MPI_Request *request)
+{
+  BFAM_ASSERT(request);
+  const bfam_locidx_t n = bfam_dag_add_node(dag);
+  dag->nodes[n].request = request;
+  return n;
+}
+
+void bfam_dag_add_dependency(bfam_dag_t *dag, bfam_locidx_t before,
+                             bfam_locidx_t after)
+{
+  BFAM_ASSERT(0 <= before && before < dag->num_nodes);
+  BFAM_ASSERT(0 <= after && after < dag->num_nodes);
+
+  if (dag->num_edges == dag->max_edges)
+  {
+    dag->max_edges = BFAM_MAX(2 * dag->max_edges, 16);
+    dag->edges =
+        bfam_realloc(dag->edges, 2 * dag->max_edges * sizeof(bfam_locidx_t));
+  }
+  dag->edges[2 * dag->num_edges + 0] = before;
+  dag->edges[2 * dag->num_edges + 1] = after;
+  ++dag->num_edges;
+}
+
+/* the ready nodes are kept in a binary min heap so that the node added first
+ * runs first */
+static void bfam_dag_heap_push(bfam_locidx_t *heap, bfam_locidx_t *num,
+                               bfam_locidx_t n)
+{
+  bfam_locidx_t i = (*num)++;
+  for (; i > 0 && heap[(i - 1) / 2] > n; i = (i - 1) / 2)
+    heap[i] = heap[(i - 1) / 2];
+  heap[i] = n;
+}
+
+static bfam_locidx_t bfam_dag_heap_pop(bfam_locidx_t *heap, bfam_locidx_t *num)
+{
+  const bfam_locidx_t top = heap[0];
+  const bfam_locidx_t last = heap[--(*num)];
+  bfam_locidx_t i = 0;
+  for (;;)
+  {
+    bfam_locidx_t c = 2 * i + 1;
+    if (c >= *num)
+      break;
+    if (c + 1 < *num && heap[c + 1] < heap[c])
+      ++c;
+    if (last <= heap[c])
+      break;
+    heap[i] = heap[c];
+    i = c;
+  }
+  heap[i] = last;
+  return top;
+}
+
+void bfam_dag_run(bfam_dag_t *dag)
+{
+  const bfam_locidx_t num_nodes = dag->num_nodes;
+  const bfam_locidx_t num_edges = dag->num_edges;
+  bfam_dag_node_t *nodes = dag->nodes;
+
+  /* successors of each node in compressed rows */
+  bfam_locidx_t *succ_offset =
+      bfam_calloc(num_nodes + 1, sizeof(bfam_locidx_t));
+  bfam_locidx_t *succ = bfam_malloc(BFAM_MAX(num_edges, 1) *
+                                    sizeof(bfam_locidx_t));
+  for (bfam_locidx_t n = 0; n < num_nodes; ++n)
+    nodes[n].pending = 0;
+  for (bfam_locidx_t e = 0; e < num_edges; ++e)
+  {
+    ++succ_offset[dag->edges[2 * e] + 1];
+    ++nodes[dag->edges[2 * e + 1]].pending;
+  }
+  for (bfam_locidx_t n = 0; n < num_nodes; ++n)
+    succ_offset[n + 1] += succ_offset[n];
+  for (bfam_locidx_t e = 0; e < num_edges; ++e)
+    succ[succ_offset[dag->edges[2 * e]]++] = dag->edges[2 * e + 1];
+  for (bfam_locidx_t n = num_nodes; n > 0; --n)
+    succ_offset[n] = succ_offset[n - 1];
+  succ_offset[0] = 0;
+
+  bfam_locidx_t *heap =
+      bfam_malloc(BFAM_MAX(num_nodes, 1) * sizeof(bfam_locidx_t));
+  bfam_locidx_t num_heap = 0;
+  for (bfam_locidx_t n = 0; n < num_nodes; ++n)
+    if (nodes[n].pending == 0)
+      bfam_dag_heap_push(heap, &num_heap, n);
+
+  /* copies of the requests being waited on, MPI needs them contiguous */
+  MPI_Request *requests =
+      bfam_malloc(BFAM_MAX(num_nodes, 1) * sizeof(MPI_Request));
+  bfam_locidx_t *waiting =
+      bfam_malloc(BFAM_MAX(num_nodes, 1) * sizeof(bfam_locidx_t));
+  int *done = bfam_malloc(BFAM_MAX(num_nodes, 1) * sizeof(int));
+  int num_waiting = 0;
+
+  bfam_locidx_t num_finished = 0;
+  bfam_locidx_t *finished =
+      bfam_malloc(BFAM_MAX(num_nodes, 1) * sizeof(bfam_locidx_t));
+  bfam_locidx_t num_new = 0;
+
+  while (num_finished < num_nodes)
+  {
+    num_new = 0;
+
+    if (num_waiting > 0)
+    {
+      /* block only when there is nothing else to do */
+      int outcount;
+      if (num_heap == 0)
+        BFAM_MPI_CHECK(MPI_Waitsome(num_waiting, requests, &outcount, done,
+                                    MPI_STATUSES_IGNORE));
+      else
+        BFAM_MPI_CHECK(MPI_Testsome(num_waiting, requests, &outcount, done,
+                                    MPI_STATUSES_IGNORE));
+
+      if (outcount != MPI_UNDEFINED && outcount > 0)
+      {
+        for (int i = 0; i < outcount; ++i)
+        {
+          const bfam_locidx_t n = waiting[done[i]];
+          *nodes[n].request = MPI_REQUEST_NULL;
+          finished[num_new++] = n;
+        }
+
+        /* compact the waiting list */
+        int j = 0;
+        for (int i = 0; i < num_waiting; ++i)
+          if (requests[i] != MPI_REQUEST_NULL)
+          {
+            requests[j] = requests[i];
+            waiting[j] = waiting[i];
+            ++j;
+          }
+        num_waiting = j;
+      }
+    }
+
+    if (num_new == 0)
+    {
+      BFAM_ABORT_IF(num_heap == 0, "Cycle in the task graph");
+      const bfam_locidx_t n = bfam_dag_heap_pop(heap, &num_heap);
+      if (nodes[n].task)
+      {
+        nodes[n].task(nodes[n].arg, nodes[n].index);
+        finished[num_new++] = n;
+      }
+      else if (*nodes[n].request == MPI_REQUEST_NULL)
+        finished[num_new++] = n;
+      else
+      {
+        requests[num_waiting] = *nodes[n].request;
+        waiting[num_waiting] = n;
+        ++num_waiting;
+      }
+    }
+
+    for (bfam_locidx_t i = 0; i < num_new; ++i)
+    {
+      const bfam_locidx_t n = finished[i];
+      for (bfam_locidx_t e = succ_offset[n]; e < succ_offset[n + 1]; ++e)
+        if (--nodes[succ[e]].pending == 0)
+          bfam_dag_heap_push(heap, &num_heap, succ[e]);
+    }
+    num_finished += num_new;
+  }
+
+  bfam_free(finished);
+  bfam_free(done);
+  bfam_free(waiting);
+  bfam_free(requests);
+  bfam_free(heap);
+  bfam_free(succ);
+  bfam_free(succ_offset);
+}
+
+typedef struct
+{
+  bfam_communicator_t *comm;
+  const bfam_communicator_stage_t *stage;
+} bfam_communicator_stage_arg_t;
+
+static void bfam_communicator_stage_post_recv(void *arg, bfam_locidx_t index)
+{
+  bfam_communicator_stage_arg_t *a = arg;
+  for (bfam_locidx_t p = 0; p < a->comm->num_procs; ++p)
+    bfam_communicator_post_recv(a->comm, p);
+}
+
+static void bfam_communicator_stage_pack(void *arg, bfam_locidx_t p)
+{
+  bfam_communicator_stage_arg_t *a = arg;
+  bfam_communicator_buffers(a->comm, a->comm->send_subs,
+                            a->comm->send_sub_offset, p, a->stage->pack,
+                            a->stage->arg);
+}
+
+static void bfam_communicator_stage_post_send(void *arg, bfam_locidx_t p)
+{
+  bfam_communicator_stage_arg_t *a = arg;
+  bfam_communicator_post_send(a->comm, p);
+}
+
+static void bfam_communicator_stage_unpack(void *arg, bfam_locidx_t p)
+{
+  bfam_communicator_stage_arg_t *a = arg;
+  bfam_communicator_buffers(a->comm, a->comm->recv_subs,
+                            a->comm->recv_sub_offset, p, a->stage->unpack,
+                            a->stage->arg);
 }
 
+static void bfam_communicator_stage_surface(void *arg, bfam_locidx_t s)
+{
+  bfam_communicator_stage_arg_t *a = arg;
+  a->stage->surface(a->comm, s, bfam_communicator_thread(), a->stage->arg);
+}
+
+void bfam_communicator_stage_run(bfam_communicator_t *comm,
+                                 const bfam_communicator_stage_t *stage,
+                                 bfam_dag_t *dag)
+{
+  bfam_communicator_stage_arg_t a = {comm, stage};
+  const bfam_locidx_t num_procs = comm->num_procs;
+
+  bfam_dag_clear(dag);
+
+  /*
+   * The node numbers are the priorities: communication first, then the
+   * work on arrived messages, then the interior
+   */
+  const bfam_locidx_t recv = bfam_dag_add_task(
+      dag, bfam_communicator_stage_post_recv, &a, 0);
+
+  const bfam_locidx_t pack = dag->num_nodes;
+  for (bfam_locidx_t p = 0; p < num_procs; ++p)
+  {
+    const bfam_locidx_t pk =
+        bfam_dag_add_task(dag, bfam_communicator_stage_pack, &a, p);
+    const bfam_locidx_t ps =
+        bfam_dag_add_task(dag, bfam_communicator_stage_post_send, &a, p);
+    bfam_dag_add_dependency(dag, recv, pk);
+    bfam_dag_add_dependency(dag, pk, ps);
+  }
+
+  const bfam_locidx_t unpack = dag->num_nodes;
+  for (bfam_locidx_t p = 0; p < num_procs; ++p)
+  {
+    const bfam_locidx_t w = bfam_dag_add_request(dag, comm->recv_request + p);
+    const bfam_locidx_t u =
+        bfam_dag_add_task(dag, bfam_communicator_stage_unpack, &a, p);
+    bfam_dag_add_dependency(dag, recv, w);
+    bfam_dag_add_dependency(dag, w, u);
+  }
+
+  const bfam_locidx_t update =
+      stage->update ? bfam_dag_add_task(dag, stage->update, stage->arg, 0) : -1;
+
+  for (bfam_locidx_t p = 0; p < num_procs; ++p)
+  {
+    /* unpack of neighbor p is node unpack + 2 p + 1 */
+    const bfam_locidx_t u = unpack + 2 * p + 1;
+    if (stage->surface)
+      for (bfam_locidx_t i = comm->recv_sub_offset[p];
+           i < comm->recv_sub_offset[p + 1]; ++i)
+      {
+        const bfam_locidx_t f = bfam_dag_add_task(
+            dag, bfam_communicator_stage_surface, &a, comm->recv_subs[i]);
+        bfam_dag_add_dependency(dag, u, f);
+        if (update >= 0)
+          bfam_dag_add_dependency(dag, f, update);
+      }
+    else if (update >= 0)
+      bfam_dag_add_dependency(dag, u, update);
+  }
+
+  for (bfam_locidx_t i = 0; stage->interior && i < stage->num_interior; ++i)
+  {
+    const bfam_locidx_t t =
+        bfam_dag_add_task(dag, stage->interior, stage->arg, i);
+    if (update >= 0)
+      bfam_dag_add_dependency(dag, t, update);
+  }
+
+  for (bfam_locidx_t p = 0; p < num_procs; ++p)
+  {
+    /* post send of neighbor p is node pack + 2 p + 1 */
+    const bfam_locidx_t w = bfam_dag_add_request(dag, comm->send_request + p);
+    bfam_dag_add_dependency(dag, pack + 2 * p + 1, w);
+  }
+
+  bfam_dag_run(dag);
+}
 // }}}
 
 // {{{ jacobi
@@ -3623,30 +4275,590 @@ static void bfam_jacobi_p_mass(bfam_long_real_t alpha, bfam_long_real_t beta,
                 (x)[(N) * ((N)*bfam_kron_l + bfam_kron_k) + bfam_kron_i];      \
   } while (0)
 
-/* // }}} */
+/*
+ * Kronecker product kernels as functions, both for a runtime number of points
+ * and specialized for a fixed number of points so that the compiler can
+ * unroll and vectorize the loops
+ */
+#define BFAM_KRON_KERNEL_LIST(X, a)                                            \
+  X(ixa, BFAM_KRON_IXA, a)                                                     \
+  X(ixat, BFAM_KRON_IXAT, a)                                                   \
+  X(axi, BFAM_KRON_AXI, a)                                                     \
+  X(atxi, BFAM_KRON_ATXI, a)                                                   \
+  X(ixa_pe, BFAM_KRON_IXA_PE, a)                                               \
+  X(ixat_pe, BFAM_KRON_IXAT_PE, a)                                             \
+  X(axi_pe, BFAM_KRON_AXI_PE, a)                                               \
+  X(atxi_pe, BFAM_KRON_ATXI_PE, a)                                             \
+  X(axixi, BFAM_KRON_AXIXI, a)                                                 \
+  X(atxixi, BFAM_KRON_ATXIXI, a)                                               \
+  X(ixaxi, BFAM_KRON_IXAXI, a)                                                 \
+  X(ixatxi, BFAM_KRON_IXATXI, a)                                               \
+  X(ixixa, BFAM_KRON_IXIXA, a)                                                 \
+  X(ixixat, BFAM_KRON_IXIXAT, a)                                               \
+  X(axixi_pe, BFAM_KRON_AXIXI_PE, a)                                           \
+  X(atxixi_pe, BFAM_KRON_ATXIXI_PE, a)                                         \
+  X(ixaxi_pe, BFAM_KRON_IXAXI_PE, a)                                           \
+  X(ixatxi_pe, BFAM_KRON_IXATXI_PE, a)                                         \
+  X(ixixa_pe, BFAM_KRON_IXIXA_PE, a)                                           \
+  X(ixixat_pe, BFAM_KRON_IXIXAT_PE, a)
+
+#define BFAM_KRON_GENERIC(name, KRON, a)                                       \
+  static void bfam_kron_##name(const int N, const bfam_real_t *restrict A,     \
+                               const bfam_real_t *restrict x,                  \
+                               bfam_real_t *restrict y)                        \
+  {                                                                            \
+    KRON(N, A, x, y);                                                          \
+  }
+BFAM_KRON_KERNEL_LIST(BFAM_KRON_GENERIC, )
+#undef BFAM_KRON_GENERIC
 
-// {{{ domain pxest
+#define BFAM_KRON_FIXED(name, KRON, NQ)                                        \
+  static void bfam_kron_##name##_##NQ(                                         \
+      const int N, const bfam_real_t *restrict A,                              \
+      const bfam_real_t *restrict x, bfam_real_t *restrict y)                  \
+  {                                                                            \
+    BFAM_ASSERT(N == NQ);                                                      \
+    KRON(NQ, A, x, y);                                                         \
+  }
+#define BFAM_KRON_TABLE_ENTRY(name, KRON, NQ) .name = bfam_kron_##name##_##NQ,
 
-/* conversions between p4est and standard orientation */
-static const int8_t bfam_p8est_FToF_code[6][6] = {
-    {0, 1, 1, 0, 0, 1}, {2, 0, 0, 1, 1, 0}, {2, 0, 0, 1, 1, 0},
-    {0, 2, 2, 0, 0, 1}, {0, 2, 2, 0, 0, 1}, {2, 0, 0, 2, 2, 0}};
+/* define the kernels and dispatch table for NQ points */
+#define BFAM_KRON_SPECIALIZE(NQ)                                               \
+  BFAM_KRON_KERNEL_LIST(BFAM_KRON_FIXED, NQ)                                   \
+  static const bfam_kron_kernels_t bfam_kron_kernels_##NQ = {                  \
+      .Nq = NQ, .width = 1,                                                    \
+      BFAM_KRON_KERNEL_LIST(BFAM_KRON_TABLE_ENTRY, NQ)};
 
-static const int8_t bfam_p8est_code_to_perm[3][4] = {
-    {1, 2, 5, 6}, {0, 3, 4, 7}, {0, 4, 3, 7}};
+/* orders N = 1 to 12 */
+BFAM_KRON_SPECIALIZE(2)
+BFAM_KRON_SPECIALIZE(3)
+BFAM_KRON_SPECIALIZE(4)
+BFAM_KRON_SPECIALIZE(5)
+BFAM_KRON_SPECIALIZE(6)
+BFAM_KRON_SPECIALIZE(7)
+BFAM_KRON_SPECIALIZE(8)
+BFAM_KRON_SPECIALIZE(9)
+BFAM_KRON_SPECIALIZE(10)
+BFAM_KRON_SPECIALIZE(11)
+BFAM_KRON_SPECIALIZE(12)
+BFAM_KRON_SPECIALIZE(13)
 
-#if DIM == 3
-static const int8_t bfam_p8est_perm_to_order[8][4] = {
-    {0, 1, 2, 3}, {0, 2, 1, 3}, {1, 0, 3, 2}, {1, 3, 0, 2},
-    {2, 0, 3, 1}, {2, 3, 0, 1}, {3, 1, 2, 0}, {3, 2, 1, 0}};
+#define BFAM_KRON_GENERIC_ENTRY(name, KRON, a) .name = bfam_kron_##name,
+static const bfam_kron_kernels_t bfam_kron_kernels_generic = {
+    .Nq = 0, .width = 1, BFAM_KRON_KERNEL_LIST(BFAM_KRON_GENERIC_ENTRY, )};
+#undef BFAM_KRON_GENERIC_ENTRY
 
-static const int8_t bfam_p8est_perm_to_order_inv[8][4] = {
-    {0, 1, 2, 3}, {0, 2, 1, 3}, {1, 0, 3, 2}, {2, 0, 3, 1},
-    {1, 3, 0, 2}, {2, 3, 0, 1}, {3, 1, 2, 0}, {3, 2, 1, 0}};
-#endif
+static const bfam_kron_kernels_t *bfam_kron_kernels_fixed[] = {
+    &bfam_kron_kernels_2,  &bfam_kron_kernels_3,  &bfam_kron_kernels_4,
+    &bfam_kron_kernels_5,  &bfam_kron_kernels_6,  &bfam_kron_kernels_7,
+    &bfam_kron_kernels_8,  &bfam_kron_kernels_9,  &bfam_kron_kernels_10,
+    &bfam_kron_kernels_11, &bfam_kron_kernels_12, &bfam_kron_kernels_13};
 
-/** BFAM_P8EST_ORIENTATION
- * f    my face
+#undef BFAM_KRON_SPECIALIZE
+#undef BFAM_KRON_TABLE_ENTRY
+#undef BFAM_KRON_FIXED
+
+#define BFAM_KRON_NUM_FIXED                                                    \
+  ((int)(sizeof(bfam_kron_kernels_fixed) / sizeof(bfam_kron_kernels_fixed[0])))
+
+/* kernel tables assembled by bfam_kron_autotune (Nq is 0 until then) */
+static bfam_kron_kernels_t bfam_kron_kernels_tuned[BFAM_KRON_NUM_FIXED];
+
+const bfam_kron_kernels_t *bfam_kron_get_kernels(const int N)
+{
+  if (N >= 1 && N <= BFAM_KRON_NUM_FIXED)
+  {
+    BFAM_ASSERT(bfam_kron_kernels_fixed[N - 1]->Nq == N + 1);
+    if (bfam_kron_kernels_tuned[N - 1].Nq == N + 1)
+      return &bfam_kron_kernels_tuned[N - 1];
+    return bfam_kron_kernels_fixed[N - 1];
+  }
+  return &bfam_kron_kernels_generic;
+}
+
+const bfam_kron_kernels_t *bfam_kron_get_generic_kernels(void)
+{
+  return &bfam_kron_kernels_generic;
+}
+
+/*
+ * Element batched Kronecker product kernels
+ *
+ * The data for W elements is interleaved, i.e., node n of element e of the
+ * batch is at x[n * W + e], so the innermost loop is over the elements of the
+ * batch and fills a SIMD register even for low orders.
+ */
+static inline void bfam_kron_batch_apply(const int Nq, const int W,
+                                         const int dim, const int dir,
+                                         const int trans, const int pe,
+                                         const bfam_real_t *restrict A,
+                                         const bfam_real_t *restrict x,
+                                         bfam_real_t *restrict y)
+{
+  const int outer = bfam_ipow(Nq, dim - 1 - dir);
+  const int inner = bfam_ipow(Nq, dir) * W;
+
+  for (int o = 0; o < outer; ++o)
+    for (int m = 0; m < Nq; ++m)
+    {
+      bfam_real_t *restrict y_m = y + (o * Nq + m) * inner;
+      if (!pe)
+        for (int p = 0; p < inner; ++p)
+          y_m[p] = 0;
+      for (int l = 0; l < Nq; ++l)
+      {
+        const bfam_real_t a = trans ? A[l + m * Nq] : A[m + l * Nq];
+        const bfam_real_t *restrict x_l = x + (o * Nq + l) * inner;
+        for (int p = 0; p < inner; ++p)
+          y_m[p] += a * x_l[p];
+      }
+    }
+}
+
+/* name, dimension, direction (0 is fastest), transpose, plus equal */
+#define BFAM_KRON_BATCH_LIST(X, W)                                             \
+  X(ixa, 2, 0, 0, 0, W)                                                        \
+  X(ixat, 2, 0, 1, 0, W)                                                       \
+  X(axi, 2, 1, 0, 0, W)                                                        \
+  X(atxi, 2, 1, 1, 0, W)                                                       \
+  X(ixa_pe, 2, 0, 0, 1, W)                                                     \
+  X(ixat_pe, 2, 0, 1, 1, W)                                                    \
+  X(axi_pe, 2, 1, 0, 1, W)                                                     \
+  X(atxi_pe, 2, 1, 1, 1, W)                                                    \
+  X(axixi, 3, 2, 0, 0, W)                                                      \
+  X(atxixi, 3, 2, 1, 0, W)                                                     \
+  X(ixaxi, 3, 1, 0, 0, W)                                                      \
+  X(ixatxi, 3, 1, 1, 0, W)                                                     \
+  X(ixixa, 3, 0, 0, 0, W)                                                      \
+  X(ixixat, 3, 0, 1, 0, W)                                                     \
+  X(axixi_pe, 3, 2, 0, 1, W)                                                   \
+  X(atxixi_pe, 3, 2, 1, 1, W)                                                  \
+  X(ixaxi_pe, 3, 1, 0, 1, W)                                                   \
+  X(ixatxi_pe, 3, 1, 1, 1, W)                                                  \
+  X(ixixa_pe, 3, 0, 0, 1, W)                                                   \
+  X(ixixat_pe, 3, 0, 1, 1, W)
+
+#define BFAM_KRON_BATCH_KERNEL(name, dim, dir, trans, pe, W)                   \
+  static BFAM_KRON_BATCH_TARGET_##W void bfam_kron_batch_##name##_##W(         \
+      const int N, const bfam_real_t *restrict A,                              \
+      const bfam_real_t *restrict x, bfam_real_t *restrict y)                  \
+  {                                                                            \
+    bfam_kron_batch_apply(N, W, dim, dir, trans, pe, A, x, y);                 \
+  }
+#define BFAM_KRON_BATCH_ENTRY(name, dim, dir, trans, pe, W)                    \
+  .name = bfam_kron_batch_##name##_##W,
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+/* batch widths filling a 256 and a 512 bit register */
+#ifdef BFAM_USE_FLOAT
+#define BFAM_KRON_BATCH_W256 8
+#define BFAM_KRON_BATCH_W512 16
+#define BFAM_KRON_BATCH_TARGET_8 __attribute__((target("avx2,fma")))
+#define BFAM_KRON_BATCH_TARGET_16 __attribute__((target("avx512f")))
+#else
+#define BFAM_KRON_BATCH_W256 4
+#define BFAM_KRON_BATCH_W512 8
+#define BFAM_KRON_BATCH_TARGET_4 __attribute__((target("avx2,fma")))
+#define BFAM_KRON_BATCH_TARGET_8 __attribute__((target("avx512f")))
+#endif
+
+#define BFAM_KRON_BATCH_TABLE(isa, W)                                          \
+  BFAM_KRON_BATCH_LIST(BFAM_KRON_BATCH_KERNEL, W)                              \
+  static const bfam_kron_kernels_t bfam_kron_batch_kernels_##isa = {           \
+      .Nq = 0, .width = W, BFAM_KRON_BATCH_LIST(BFAM_KRON_BATCH_ENTRY, W)};
+
+BFAM_KRON_BATCH_TABLE(avx2, BFAM_KRON_BATCH_W256)
+BFAM_KRON_BATCH_TABLE(avx512, BFAM_KRON_BATCH_W512)
+
+#undef BFAM_KRON_BATCH_TABLE
+#endif
+
+#undef BFAM_KRON_BATCH_ENTRY
+#undef BFAM_KRON_BATCH_KERNEL
+
+const bfam_kron_kernels_t *bfam_kron_get_batch_kernels(const int N)
+{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f"))
+    return &bfam_kron_batch_kernels_avx512;
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    return &bfam_kron_batch_kernels_avx2;
+#endif
+  return bfam_kron_get_kernels(N);
+}
+
+/* batched kernels for order N if a line of one element is shorter than the
+ * batch (so the per element kernels would not fill a vector register), and
+ * NULL otherwise */
+static const bfam_kron_kernels_t *bfam_kron_get_low_order_kernels(const int N)
+{
+  const bfam_kron_kernels_t *batch = bfam_kron_get_batch_kernels(N);
+  return (batch->width > 1 && N + 1 < batch->width) ? batch : NULL;
+}
+
+/*
+ * Autotuned Kronecker product kernels
+ *
+ * Besides the loop nests of the BFAM_KRON_* macros, two other loop orders
+ * are compiled for every specialized number of points: "axpy", which
+ * updates whole rows of the output with the innermost loop over the
+ * contiguous index (bfam_kron_batch_apply with one element), and "dot",
+ * which accumulates each output value over the contracted index in the
+ * innermost loop. The fastest of the three is picked per kernel and order.
+ */
+static inline void bfam_kron_dot_apply(const int Nq, const int dim,
+                                       const int dir, const int trans,
+                                       const int pe,
+                                       const bfam_real_t *restrict A,
+                                       const bfam_real_t *restrict x,
+                                       bfam_real_t *restrict y)
+{
+  const int outer = bfam_ipow(Nq, dim - 1 - dir);
+  const int inner = bfam_ipow(Nq, dir);
+
+  for (int o = 0; o < outer; ++o)
+    for (int m = 0; m < Nq; ++m)
+      for (int p = 0; p < inner; ++p)
+      {
+        const bfam_real_t *restrict x_p = x + o * Nq * inner + p;
+        bfam_real_t *restrict y_p = y + (o * Nq + m) * inner + p;
+        bfam_real_t s = pe ? *y_p : 0;
+        for (int l = 0; l < Nq; ++l)
+          s += (trans ? A[l + m * Nq] : A[m + l * Nq]) * x_p[l * inner];
+        *y_p = s;
+      }
+}
+
+#define BFAM_KRON_TUNE_KERNEL(name, dim, dir, trans, pe, NQ)                   \
+  static void bfam_kron_axpy_##name##_##NQ(                                    \
+      const int N, const bfam_real_t *restrict A,                              \
+      const bfam_real_t *restrict x, bfam_real_t *restrict y)                  \
+  {                                                                            \
+    BFAM_ASSERT(N == NQ);                                                      \
+    bfam_kron_batch_apply(NQ, 1, dim, dir, trans, pe, A, x, y);                \
+  }                                                                            \
+  static void bfam_kron_dot_##name##_##NQ(                                     \
+      const int N, const bfam_real_t *restrict A,                              \
+      const bfam_real_t *restrict x, bfam_real_t *restrict y)                  \
+  {                                                                            \
+    BFAM_ASSERT(N == NQ);                                                      \
+    bfam_kron_dot_apply(NQ, dim, dir, trans, pe, A, x, y);                     \
+  }
+#define BFAM_KRON_TUNE_AXPY_ENTRY(name, dim, dir, trans, pe, NQ)               \
+  .name = bfam_kron_axpy_##name##_##NQ,
+#define BFAM_KRON_TUNE_DOT_ENTRY(name, dim, dir, trans, pe, NQ)                \
+  .name = bfam_kron_dot_##name##_##NQ,
+
+/* the candidate kernels for NQ points in the order of bfam_kron_orders */
+#define BFAM_KRON_TUNE_SPECIALIZE(NQ)                                          \
+  BFAM_KRON_BATCH_LIST(BFAM_KRON_TUNE_KERNEL, NQ)                              \
+  static const bfam_kron_kernels_t bfam_kron_axpy_kernels_##NQ = {             \
+      .Nq = NQ, .width = 1,                                                    \
+      BFAM_KRON_BATCH_LIST(BFAM_KRON_TUNE_AXPY_ENTRY, NQ)};                    \
+  static const bfam_kron_kernels_t bfam_kron_dot_kernels_##NQ = {              \
+      .Nq = NQ, .width = 1,                                                    \
+      BFAM_KRON_BATCH_LIST(BFAM_KRON_TUNE_DOT_ENTRY, NQ)};
+
+BFAM_KRON_TUNE_SPECIALIZE(2)
+BFAM_KRON_TUNE_SPECIALIZE(3)
+BFAM_KRON_TUNE_SPECIALIZE(4)
+BFAM_KRON_TUNE_SPECIALIZE(5)
+BFAM_KRON_TUNE_SPECIALIZE(6)
+BFAM_KRON_TUNE_SPECIALIZE(7)
+BFAM_KRON_TUNE_SPECIALIZE(8)
+BFAM_KRON_TUNE_SPECIALIZE(9)
+BFAM_KRON_TUNE_SPECIALIZE(10)
+BFAM_KRON_TUNE_SPECIALIZE(11)
+BFAM_KRON_TUNE_SPECIALIZE(12)
+BFAM_KRON_TUNE_SPECIALIZE(13)
+
+#undef BFAM_KRON_TUNE_SPECIALIZE
+#undef BFAM_KRON_TUNE_DOT_ENTRY
+#undef BFAM_KRON_TUNE_AXPY_ENTRY
+#undef BFAM_KRON_TUNE_KERNEL
+
+#define BFAM_KRON_NUM_ORDERS 3
+static const char *bfam_kron_orders[BFAM_KRON_NUM_ORDERS] = {"loop", "axpy",
+                                                             "dot"};
+
+#define BFAM_KRON_TUNE_CANDIDATES(NQ)                                          \
+  {&bfam_kron_kernels_##NQ, &bfam_kron_axpy_kernels_##NQ,                      \
+   &bfam_kron_dot_kernels_##NQ}
+static const bfam_kron_kernels_t
+    *bfam_kron_candidates[BFAM_KRON_NUM_FIXED][BFAM_KRON_NUM_ORDERS] = {
+        BFAM_KRON_TUNE_CANDIDATES(2),  BFAM_KRON_TUNE_CANDIDATES(3),
+        BFAM_KRON_TUNE_CANDIDATES(4),  BFAM_KRON_TUNE_CANDIDATES(5),
+        BFAM_KRON_TUNE_CANDIDATES(6),  BFAM_KRON_TUNE_CANDIDATES(7),
+        BFAM_KRON_TUNE_CANDIDATES(8),  BFAM_KRON_TUNE_CANDIDATES(9),
+        BFAM_KRON_TUNE_CANDIDATES(10), BFAM_KRON_TUNE_CANDIDATES(11),
+        BFAM_KRON_TUNE_CANDIDATES(12), BFAM_KRON_TUNE_CANDIDATES(13)};
+#undef BFAM_KRON_TUNE_CANDIDATES
+
+/* name, dimension, and table slot of each kernel */
+typedef struct
+{
+  const char *name;
+  int dim;
+  size_t offset;
+} bfam_kron_kernel_info_t;
+
+#define BFAM_KRON_INFO_ENTRY(name, dim, dir, trans, pe, W)                     \
+  {#name, dim, offsetof(bfam_kron_kernels_t, name)},
+static const bfam_kron_kernel_info_t bfam_kron_kernel_info[] = {
+    BFAM_KRON_BATCH_LIST(BFAM_KRON_INFO_ENTRY, )};
+#undef BFAM_KRON_INFO_ENTRY
+#define BFAM_KRON_NUM_KERNELS                                                  \
+  ((int)(sizeof(bfam_kron_kernel_info) / sizeof(bfam_kron_kernel_info[0])))
+
+/* loop order plus one of each tuned kernel (0 where it has not been tuned) */
+static int8_t bfam_kron_tuned_order[BFAM_KRON_NUM_FIXED][BFAM_KRON_NUM_KERNELS];
+
+#define BFAM_KRON_KERNEL(table, n)                                             \
+  (*(bfam_kron_kernel_t *)((char *)(table) + bfam_kron_kernel_info[n].offset))
+
+/* elements the kernels are timed on (small enough to stay in cache) */
+#define BFAM_KRON_TUNE_ELEMS 16
+#define BFAM_KRON_TUNE_TRIALS 5
+#define BFAM_KRON_TUNE_MIN_TIME 2e-4
+
+#define BFAM_KRON_TUNE_CACHE_MAGIC "bfam_kron_tune"
+#define BFAM_KRON_TUNE_CACHE_VERSION 1
+
+/* best of several trials of the seconds per element of a kernel */
+static double bfam_kron_tune_time(const bfam_kron_kernel_t kernel,
+                                  const int Nq, const int Np,
+                                  const bfam_real_t *restrict A,
+                                  const bfam_real_t *restrict x,
+                                  bfam_real_t *restrict y)
+{
+  int reps = 1;
+  double best = HUGE_VAL;
+  for (int t = 0; t < BFAM_KRON_TUNE_TRIALS;)
+  {
+    const double start = MPI_Wtime();
+    for (int r = 0; r < reps; ++r)
+      for (int e = 0; e < BFAM_KRON_TUNE_ELEMS; ++e)
+        kernel(Nq, A, x + Np * e, y + Np * e);
+    const double time = MPI_Wtime() - start;
+
+    /* calibrate the repetitions before counting trials */
+    if (time < BFAM_KRON_TUNE_MIN_TIME)
+    {
+      reps *= 2;
+      continue;
+    }
+    best = BFAM_MIN(best, time / ((double)reps * BFAM_KRON_TUNE_ELEMS));
+    ++t;
+  }
+  return best;
+}
+
+/* pick the fastest loop order of each kernel of dimension dim_min to DIM */
+static void bfam_kron_tune_order(const int N, const int dim_min,
+                                 int8_t *choice)
+{
+  const int Nq = N + 1;
+  const int Np = bfam_ipow(Nq, DIM);
+  const size_t num = (size_t)Np * BFAM_KRON_TUNE_ELEMS;
+
+  bfam_real_t *A = bfam_malloc_aligned(sizeof(bfam_real_t) * Nq * Nq);
+  bfam_real_t *x = bfam_malloc_aligned(sizeof(bfam_real_t) * num);
+  bfam_real_t *y = bfam_malloc_aligned(sizeof(bfam_real_t) * num);
+  for (int n = 0; n < Nq * Nq; ++n)
+    A[n] = (bfam_real_t)((0.5 - (double)((n * 7919) % 101) / 101) / Nq);
+  for (size_t n = 0; n < num; ++n)
+  {
+    x[n] = (bfam_real_t)(0.5 - (double)((n * 104729) % 211) / 211);
+    y[n] = 0;
+  }
+
+  for (int k = 0; k < BFAM_KRON_NUM_KERNELS; ++k)
+  {
+    const int dim = bfam_kron_kernel_info[k].dim;
+    if (choice[k] >= 0 || dim < dim_min || dim > DIM)
+      continue;
+
+    double best = HUGE_VAL;
+    for (int o = 0; o < BFAM_KRON_NUM_ORDERS; ++o)
+    {
+      const double time = bfam_kron_tune_time(
+          BFAM_KRON_KERNEL(bfam_kron_candidates[N - 1][o], k), Nq,
+          bfam_ipow(Nq, dim), A, x, y);
+      if (time < best)
+      {
+        best = time;
+        choice[k] = (int8_t)o;
+      }
+    }
+
+    BFAM_LDEBUG("Kron N %2d %-9s: %s (%.3e s)", N,
+                bfam_kron_kernel_info[k].name, bfam_kron_orders[choice[k]],
+                best);
+  }
+
+  bfam_free_aligned(A);
+  bfam_free_aligned(x);
+  bfam_free_aligned(y);
+}
+
+/* read the loop orders of a tuning cache file, leaving unknown entries */
+static void bfam_kron_tune_read(const char *filename,
+                                int8_t choice[][BFAM_KRON_NUM_KERNELS])
+{
+  FILE *stream = fopen(filename, "r");
+  if (stream == NULL)
+    return;
+
+  char magic[BFAM_BUFSIZ];
+  int version, real_size;
+  if (fscanf(stream, "%63s %d %d", magic, &version, &real_size) != 3 ||
+      strcmp(magic, BFAM_KRON_TUNE_CACHE_MAGIC) ||
+      version != BFAM_KRON_TUNE_CACHE_VERSION ||
+      real_size != (int)sizeof(bfam_real_t))
+  {
+    BFAM_LDEBUG("Kron tuning cache '%s' does not match, retuning", filename);
+    fclose(stream);
+    return;
+  }
+
+  int N;
+  char name[BFAM_BUFSIZ], order[BFAM_BUFSIZ];
+  while (fscanf(stream, "%d %63s %63s", &N, name, order) == 3)
+  {
+    if (N < 1 || N > BFAM_KRON_NUM_FIXED)
+      continue;
+    for (int k = 0; k < BFAM_KRON_NUM_KERNELS; ++k)
+      if (!strcmp(name, bfam_kron_kernel_info[k].name))
+        for (int o = 0; o < BFAM_KRON_NUM_ORDERS; ++o)
+          if (!strcmp(order, bfam_kron_orders[o]))
+            choice[N - 1][k] = (int8_t)o;
+  }
+
+  fclose(stream);
+}
+
+/* write all the known loop orders to a tuning cache file */
+static void bfam_kron_tune_write(const char *filename,
+                                 int8_t choice[][BFAM_KRON_NUM_KERNELS])
+{
+  char tmpname[BFAM_BUFSIZ];
+  snprintf(tmpname, BFAM_BUFSIZ, "%s.%jd", filename, (intmax_t)getpid());
+
+  FILE *stream = fopen(tmpname, "w");
+  if (stream == NULL)
+  {
+    BFAM_WARNING("Can't write kron tuning cache '%s'", tmpname);
+    return;
+  }
+
+  int ok = fprintf(stream, "%s %d %d\n", BFAM_KRON_TUNE_CACHE_MAGIC,
+                   BFAM_KRON_TUNE_CACHE_VERSION, (int)sizeof(bfam_real_t)) > 0;
+  for (int N = 1; N <= BFAM_KRON_NUM_FIXED; ++N)
+    for (int k = 0; k < BFAM_KRON_NUM_KERNELS; ++k)
+      if (choice[N - 1][k] >= 0)
+        ok = fprintf(stream, "%d %s %s\n", N, bfam_kron_kernel_info[k].name,
+                     bfam_kron_orders[choice[N - 1][k]]) > 0 &&
+             ok;
+  ok = (fclose(stream) == 0) && ok;
+
+  if (ok && rename(tmpname, filename) == 0)
+    BFAM_LDEBUG("Wrote kron tuning cache '%s'", filename);
+  else
+  {
+    BFAM_WARNING("Can't write kron tuning cache '%s'", filename);
+    remove(tmpname);
+  }
+}
+
+void bfam_kron_autotune(MPI_Comm comm, const int num_N, const int *N,
+                        const char *filename)
+{
+  /* start from the loop orders of earlier calls */
+  int8_t choice[BFAM_KRON_NUM_FIXED][BFAM_KRON_NUM_KERNELS];
+  for (int n = 0; n < BFAM_KRON_NUM_FIXED; ++n)
+    for (int k = 0; k < BFAM_KRON_NUM_KERNELS; ++k)
+      choice[n][k] = (int8_t)(bfam_kron_tuned_order[n][k] - 1);
+
+  /* the tuning is done on the root and used by all the ranks */
+  int rank;
+  BFAM_MPI_CHECK(MPI_Comm_rank(comm, &rank));
+  if (rank == 0)
+  {
+    int8_t cached[BFAM_KRON_NUM_FIXED][BFAM_KRON_NUM_KERNELS];
+    memset(cached, -1, sizeof(cached));
+    if (filename)
+      bfam_kron_tune_read(filename, cached);
+
+    /* the cache file is rewritten unless it has all the requested kernels */
+    int missing = 0;
+    for (int n = 0; n < num_N; ++n)
+    {
+      if (N[n] < 1 || N[n] > BFAM_KRON_NUM_FIXED)
+        continue;
+      int8_t *c = choice[N[n] - 1];
+      for (int k = 0; k < BFAM_KRON_NUM_KERNELS; ++k)
+      {
+        const int dim = bfam_kron_kernel_info[k].dim;
+        if (cached[N[n] - 1][k] >= 0)
+          c[k] = cached[N[n] - 1][k];
+        else if (dim >= DIM - 1 && dim <= DIM)
+          missing = 1;
+      }
+      /* the glue kernels are one dimension lower than the volume */
+      bfam_kron_tune_order(N[n], DIM - 1, c);
+    }
+
+    if (filename && missing)
+    {
+      /* keep the entries of the file for the orders not requested */
+      for (int n = 0; n < BFAM_KRON_NUM_FIXED; ++n)
+        for (int k = 0; k < BFAM_KRON_NUM_KERNELS; ++k)
+          if (choice[n][k] < 0)
+            choice[n][k] = cached[n][k];
+      bfam_kron_tune_write(filename, choice);
+    }
+  }
+  BFAM_MPI_CHECK(MPI_Bcast(choice, (int)sizeof(choice), MPI_BYTE, 0, comm));
+
+  for (int n = 0; n < BFAM_KRON_NUM_FIXED; ++n)
+  {
+    bfam_kron_kernels_t *table = &bfam_kron_kernels_tuned[n];
+    *table = *bfam_kron_kernels_fixed[n];
+    for (int k = 0; k < BFAM_KRON_NUM_KERNELS; ++k)
+    {
+      bfam_kron_tuned_order[n][k] = (int8_t)(choice[n][k] + 1);
+      if (choice[n][k] >= 0)
+        BFAM_KRON_KERNEL(table, k) =
+            BFAM_KRON_KERNEL(bfam_kron_candidates[n][choice[n][k]], k);
+    }
+  }
+}
+
+/* // }}} */
+
+// {{{ domain pxest
+
+/* conversions between p4est and standard orientation */
+static const int8_t bfam_p8est_FToF_code[6][6] = {
+    {0, 1, 1, 0, 0, 1}, {2, 0, 0, 1, 1, 0}, {2, 0, 0, 1, 1, 0},
+    {0, 2, 2, 0, 0, 1}, {0, 2, 2, 0, 0, 1}, {2, 0, 0, 2, 2, 0}};
+
+static const int8_t bfam_p8est_code_to_perm[3][4] = {
+    {1, 2, 5, 6}, {0, 3, 4, 7}, {0, 4, 3, 7}};
+
+#if DIM == 3
+static const int8_t bfam_p8est_perm_to_order[8][4] = {
+    {0, 1, 2, 3}, {0, 2, 1, 3}, {1, 0, 3, 2}, {1, 3, 0, 2},
+    {2, 0, 3, 1}, {2, 3, 0, 1}, {3, 1, 2, 0}, {3, 2, 1, 0}};
+
+static const int8_t bfam_p8est_perm_to_order_inv[8][4] = {
+    {0, 1, 2, 3}, {0, 2, 1, 3}, {1, 0, 3, 2}, {2, 0, 3, 1},
+    {1, 3, 0, 2}, {2, 3, 0, 1}, {3, 1, 2, 0}, {3, 2, 1, 0}};
+#endif
+
+/** BFAM_P8EST_ORIENTATION
+ * f    my face
  * nf   neighbor face
  * o    p8est orientation code
  */
@@ -3756,6 +4968,36 @@ static void bfam_domain_pxest_init_callback(p4est_t *p4est,
 #endif
 }
 
+/** initializes a domain around a forest
+ *
+ * \param [in,out] domain  pointer to the pxest managed domain
+ * \param [in]     domComm pointer to the communicator for the domain
+ * \param [in]     conn    pointer to the pxest connectivity for the domain
+ * \param [in]     pxest   forest, owned by the domain from now on
+ */
+static void bfam_domain_pxest_init_forest(bfam_domain_pxest_t *domain,
+                                          MPI_Comm domComm,
+                                          p4est_connectivity_t *conn,
+                                          p4est_t *pxest)
+{
+  bfam_domain_init(&domain->base, domComm);
+
+  domain->conn = conn;
+  domain->pxest = pxest;
+  domain->N2N = bfam_malloc(sizeof(bfam_dictionary_t));
+  bfam_dictionary_init(domain->N2N);
+
+  domain->dgx_ops = bfam_malloc(sizeof(bfam_dictionary_t));
+  bfam_dictionary_init(domain->dgx_ops);
+
+  domain->elem_order = BFAM_PXEST_ELEM_ORDER_SPLIT;
+
+  domain->ops_comm = MPI_COMM_NULL;
+  domain->ops_win = MPI_WIN_NULL;
+  domain->ops_base = NULL;
+  domain->ops_size = 0;
+}
+
 /** initializes a domain
  *
  * \param [in,out] domain          pointer to the pxest managed domain
@@ -3786,18 +5028,11 @@ static void bfam_domain_pxest_init_ext(bfam_domain_pxest_t *domain,
 #if defined(__clang__)
 #pragma clang diagnostic pop
 #endif
-  bfam_domain_init(&domain->base, domComm);
-
-  domain->conn = conn;
-  domain->pxest =
+  p4est_t *pxest =
       p4est_new_ext(domComm, conn, min_quadrants, min_level, fill_uniform,
                     sizeof(bfam_pxest_user_data_t),
                     bfam_domain_pxest_init_callback, &default_user_data);
-  domain->N2N = bfam_malloc(sizeof(bfam_dictionary_t));
-  bfam_dictionary_init(domain->N2N);
-
-  domain->dgx_ops = bfam_malloc(sizeof(bfam_dictionary_t));
-  bfam_dictionary_init(domain->dgx_ops);
+  bfam_domain_pxest_init_forest(domain, domComm, conn, pxest);
 }
 
 /* Domain managed by pxest based functions */
@@ -3813,12 +5048,22 @@ bfam_domain_pxest_t *bfam_domain_pxest_new_ext(MPI_Comm domComm,
   return newDomain;
 }
 
+/* true if ptr is in the shared operator tables of the domain */
+static int bfam_domain_pxest_ops_shared(const bfam_domain_pxest_t *domain,
+                                        const void *ptr)
+{
+  const char *p = ptr;
+  return domain->ops_base && p >= domain->ops_base &&
+         p < domain->ops_base + domain->ops_size;
+}
+
 /** free the dgx_ops data put in the dgx_ops dictionary
  */
 static int bfam_subdomain_dgx_clear_dgx_ops_dict(const char *key, void *val,
                                                  void *args)
 {
-  bfam_free_aligned(val);
+  if (!bfam_domain_pxest_ops_shared(args, val))
+    bfam_free_aligned(val);
   return 1;
 }
 
@@ -3871,16 +5116,17 @@ static int bfam_subdomain_dgx_clear_interpolation_dict(const char *key,
 {
   bfam_subdomain_dgx_interpolator_t *interp =
       (bfam_subdomain_dgx_interpolator_t *)val;
+  const int shared = bfam_domain_pxest_ops_shared(args, interp->mass_prj[0]);
   for (bfam_locidx_t k = 0; k < interp->num_prj; k++)
-    if (interp->prj[k])
+    if (interp->prj[k] && !shared)
       bfam_free_aligned(interp->prj[k]);
   bfam_free(interp->prj);
   for (bfam_locidx_t k = 0; k < interp->num_prj; k++)
-    if (interp->mass_prj[k])
+    if (interp->mass_prj[k] && !shared)
       bfam_free_aligned(interp->mass_prj[k]);
   bfam_free(interp->mass_prj);
   for (bfam_locidx_t k = 0; k < interp->num_prj; k++)
-    if (interp->wi_mass_prj[k])
+    if (interp->wi_mass_prj[k] && !shared)
       bfam_free_aligned(interp->wi_mass_prj[k]);
   bfam_free(interp->wi_mass_prj);
   bfam_free(val);
@@ -3900,7 +5146,7 @@ void bfam_domain_pxest_free(bfam_domain_pxest_t *domain)
   if (domain->N2N)
   {
     bfam_dictionary_allprefixed_ptr(
-        domain->N2N, "", bfam_subdomain_dgx_clear_interpolation_dict, NULL);
+        domain->N2N, "", bfam_subdomain_dgx_clear_interpolation_dict, domain);
     bfam_dictionary_clear(domain->N2N);
     bfam_free(domain->N2N);
   }
@@ -3909,12 +5155,21 @@ void bfam_domain_pxest_free(bfam_domain_pxest_t *domain)
   if (domain->dgx_ops)
   {
     bfam_dictionary_allprefixed_ptr(
-        domain->dgx_ops, "", bfam_subdomain_dgx_clear_dgx_ops_dict, NULL);
+        domain->dgx_ops, "", bfam_subdomain_dgx_clear_dgx_ops_dict, domain);
     bfam_dictionary_clear(domain->dgx_ops);
     bfam_free(domain->dgx_ops);
   }
   domain->dgx_ops = NULL;
 
+  if (domain->ops_win != MPI_WIN_NULL)
+    BFAM_MPI_CHECK(MPI_Win_free(&domain->ops_win));
+  else if (domain->ops_base)
+    bfam_free_aligned(domain->ops_base);
+  if (domain->ops_comm != MPI_COMM_NULL)
+    BFAM_MPI_CHECK(MPI_Comm_free(&domain->ops_comm));
+  domain->ops_base = NULL;
+  domain->ops_size = 0;
+
   bfam_domain_free(&domain->base);
 }
 
@@ -5175,12 +6430,12 @@ typedef struct
 static int quadrant_compare(const p4est_quadrant_t *quad_dst,
                             const p4est_quadrant_t *quad_src)
 {
-  if (p4est_quadrant_is_parent(quad_dst, quad_src))
+  if (p4est_quadrant_is_ancestor(quad_dst, quad_src))
   {
     /* h-coarsening */
     return -1;
   }
-  else if (p4est_quadrant_is_parent(quad_src, quad_dst))
+  else if (p4est_quadrant_is_ancestor(quad_src, quad_dst))
   {
     /* h-refining */
     return 1;
@@ -5192,16 +6447,22 @@ static int quadrant_compare(const p4est_quadrant_t *quad_dst,
   }
   else
   {
-    if (p4est_quadrant_overlaps(quad_dst, quad_src))
-      BFAM_ABORT("Transfer aborted: more than one level of refinement "
-                 "between quadrants");
-    else
-      BFAM_ABORT("Transfer aborted: Strange Things are Afoot at the Circle "
-                 "K, we should never reach here");
+    BFAM_ABORT("Transfer aborted: Strange Things are Afoot at the Circle "
+               "K, we should never reach here");
     return 0;
   }
 }
 
+/* path of child ids from the ancestor of fine at level lvl down to fine */
+static uint64_t quadrant_path(const p4est_quadrant_t *fine, int lvl)
+{
+  BFAM_ASSERT(P4EST_DIM * (fine->level - lvl) <= 64);
+  uint64_t path = 0;
+  for (int l = lvl + 1; l <= fine->level; ++l)
+    path = (path << P4EST_DIM) | (uint64_t)p4est_quadrant_ancestor_id(fine, l);
+  return path;
+}
+
 void bfam_domain_pxest_transfer_maps_init(
     bfam_domain_pxest_transfer_maps_t *maps, bfam_domain_pxest_t *domain_dst,
     bfam_domain_pxest_t *domain_src)
@@ -5210,9 +6471,9 @@ void bfam_domain_pxest_transfer_maps_init(
   p4est_t *pxest_src = domain_src->pxest;
 
   p4est_topidx_t t;
-  p4est_locidx_t k_src;
   p4est_locidx_t k_dst;
   p4est_locidx_t coarse_k_dst;
+  p4est_locidx_t coarse_k_src;
 
   BFAM_ABORT_IF(pxest_dst->first_local_tree != pxest_src->first_local_tree ||
                     pxest_dst->last_local_tree != pxest_src->last_local_tree,
@@ -5222,6 +6483,7 @@ void bfam_domain_pxest_transfer_maps_init(
    * Count coarsened
    */
   size_t num_coarsened = 0;
+  size_t num_coarse_src = 0;
   for (t = pxest_dst->first_local_tree; t <= pxest_dst->last_local_tree; ++t)
   {
     p4est_tree_t *tree_dst = p4est_tree_array_index(pxest_dst->trees, t);
@@ -5245,12 +6507,21 @@ void bfam_domain_pxest_transfer_maps_init(
       {
       case -1: /* h-coarsened */
         ++num_coarsened;
-        z_src += P4EST_CHILDREN;
+        while (z_src < quadrants_src->elem_count &&
+               p4est_quadrant_is_ancestor(
+                   quad_dst, p4est_quadrant_array_index(quadrants_src, z_src)))
+        {
+          ++num_coarse_src;
+          z_src += 1;
+        }
         z_dst += 1;
         break;
       case 1: /* h-refined */
+        while (z_dst < quadrants_dst->elem_count &&
+               p4est_quadrant_is_ancestor(
+                   quad_src, p4est_quadrant_array_index(quadrants_dst, z_dst)))
+          z_dst += 1;
         z_src += 1;
-        z_dst += P4EST_CHILDREN;
         break;
       case 0: /* h-same */
         z_src += 1;
@@ -5262,8 +6533,8 @@ void bfam_domain_pxest_transfer_maps_init(
     }
   }
 
-  BFAM_VERBOSE("Building transfer maps with %zd coarsened elements",
-               num_coarsened);
+  BFAM_VERBOSE("Building transfer maps with %zd coarsened elements from %zd",
+               num_coarsened, num_coarse_src);
 
   maps->num_dst = pxest_dst->local_num_quadrants;
   maps->dst_to_adapt_flags =
@@ -5274,21 +6545,32 @@ void bfam_domain_pxest_transfer_maps_init(
       bfam_malloc_aligned(maps->num_dst * sizeof(bfam_locidx_t));
   maps->dst_to_src_elem_id =
       bfam_malloc_aligned(maps->num_dst * sizeof(bfam_locidx_t));
+  maps->dst_to_src_lvl_diff =
+      bfam_malloc_aligned(maps->num_dst * sizeof(int8_t));
+  maps->dst_to_src_path = bfam_malloc_aligned(maps->num_dst * sizeof(uint64_t));
 
   maps->num_coarse_dst = (bfam_locidx_t)num_coarsened;
+  maps->num_coarse_src = (bfam_locidx_t)num_coarse_src;
+  maps->coarse_dst_to_src_offset =
+      bfam_malloc_aligned((num_coarsened + 1) * sizeof(bfam_locidx_t));
   maps->coarse_dst_to_src_chld_id =
-      bfam_malloc_aligned(P4EST_CHILDREN * num_coarsened * sizeof(int8_t));
-  maps->coarse_dst_to_src_subd_id = bfam_malloc_aligned(
-      P4EST_CHILDREN * num_coarsened * sizeof(bfam_locidx_t));
-  maps->coarse_dst_to_src_elem_id = bfam_malloc_aligned(
-      P4EST_CHILDREN * num_coarsened * sizeof(bfam_locidx_t));
+      bfam_malloc_aligned(num_coarse_src * sizeof(int8_t));
+  maps->coarse_dst_to_src_subd_id =
+      bfam_malloc_aligned(num_coarse_src * sizeof(bfam_locidx_t));
+  maps->coarse_dst_to_src_elem_id =
+      bfam_malloc_aligned(num_coarse_src * sizeof(bfam_locidx_t));
+  maps->coarse_dst_to_src_lvl_diff =
+      bfam_malloc_aligned(num_coarse_src * sizeof(int8_t));
+  maps->coarse_dst_to_src_path =
+      bfam_malloc_aligned(num_coarse_src * sizeof(uint64_t));
 
   /*
    * Fill Maps
    */
-  k_src = 0;
   k_dst = 0;
   coarse_k_dst = 0;
+  coarse_k_src = 0;
+  maps->coarse_dst_to_src_offset[0] = 0;
   for (t = pxest_dst->first_local_tree; t <= pxest_dst->last_local_tree; ++t)
   {
     p4est_tree_t *tree_dst = p4est_tree_array_index(pxest_dst->trees, t);
@@ -5318,51 +6600,61 @@ void bfam_domain_pxest_transfer_maps_init(
         maps->dst_to_adapt_flags[k_dst] = BFAM_FLAG_COARSEN;
         maps->dst_to_dst_chld_id[k_dst] =
             (int8_t)p4est_quadrant_child_id(quad_dst);
+        maps->dst_to_src_lvl_diff[k_dst] = 0;
+        maps->dst_to_src_path[k_dst] = 0;
 
         /* Store index into coarse maps */
         maps->dst_to_src_subd_id[k_dst] = -1 - coarse_k_dst;
         maps->dst_to_src_elem_id[k_dst] = -1 - coarse_k_dst;
 
-        for (int c = 0; c < P4EST_CHILDREN; ++c)
+        for (; z_src < quadrants_src->elem_count; ++z_src, ++coarse_k_src)
         {
-          size_t c_id = P4EST_CHILDREN * coarse_k_dst + c;
-          BFAM_ASSERT(c_id < P4EST_CHILDREN * num_coarsened);
-          quad_src = p4est_quadrant_array_index(quadrants_src, z_src + c);
+          quad_src = p4est_quadrant_array_index(quadrants_src, z_src);
+          if (!p4est_quadrant_is_ancestor(quad_dst, quad_src))
+            break;
+
+          BFAM_ASSERT(coarse_k_src < maps->num_coarse_src);
           ud_src = quad_src->p.user_data;
 
           BFAM_ASSERT(ud_src->subd_id >= 0);
           BFAM_ASSERT(ud_src->elem_id >= 0);
 
-          maps->coarse_dst_to_src_chld_id[c_id] =
+          maps->coarse_dst_to_src_chld_id[coarse_k_src] =
               (int8_t)p4est_quadrant_child_id(quad_src);
-          maps->coarse_dst_to_src_subd_id[c_id] = ud_src->subd_id;
-          maps->coarse_dst_to_src_elem_id[c_id] = ud_src->elem_id;
+          maps->coarse_dst_to_src_subd_id[coarse_k_src] = ud_src->subd_id;
+          maps->coarse_dst_to_src_elem_id[coarse_k_src] = ud_src->elem_id;
+          maps->coarse_dst_to_src_lvl_diff[coarse_k_src] =
+              (int8_t)(quad_src->level - quad_dst->level);
+          maps->coarse_dst_to_src_path[coarse_k_src] =
+              quadrant_path(quad_src, quad_dst->level);
         }
 
         coarse_k_dst += 1;
-        k_src += P4EST_CHILDREN;
+        maps->coarse_dst_to_src_offset[coarse_k_dst] = coarse_k_src;
         k_dst += 1;
-        z_src += P4EST_CHILDREN;
         z_dst += 1;
         break;
       case 1: /* h-refined */
         BFAM_ASSERT(ud_src->subd_id >= 0);
         BFAM_ASSERT(ud_src->elem_id >= 0);
 
-        for (int c = 0; c < P4EST_CHILDREN; ++c)
+        for (; z_dst < quadrants_dst->elem_count; ++z_dst, ++k_dst)
         {
-          quad_dst = p4est_quadrant_array_index(quadrants_dst, z_dst + c);
+          quad_dst = p4est_quadrant_array_index(quadrants_dst, z_dst);
+          if (!p4est_quadrant_is_ancestor(quad_src, quad_dst))
+            break;
 
-          maps->dst_to_adapt_flags[k_dst + c] = BFAM_FLAG_REFINE;
-          maps->dst_to_dst_chld_id[k_dst + c] =
+          maps->dst_to_adapt_flags[k_dst] = BFAM_FLAG_REFINE;
+          maps->dst_to_dst_chld_id[k_dst] =
               (int8_t)p4est_quadrant_child_id(quad_dst);
-          maps->dst_to_src_subd_id[k_dst + c] = ud_src->subd_id;
-          maps->dst_to_src_elem_id[k_dst + c] = ud_src->elem_id;
+          maps->dst_to_src_subd_id[k_dst] = ud_src->subd_id;
+          maps->dst_to_src_elem_id[k_dst] = ud_src->elem_id;
+          maps->dst_to_src_lvl_diff[k_dst] =
+              (int8_t)(quad_dst->level - quad_src->level);
+          maps->dst_to_src_path[k_dst] =
+              quadrant_path(quad_dst, quad_src->level);
         }
-        k_src += 1;
-        k_dst += P4EST_CHILDREN;
         z_src += 1;
-        z_dst += P4EST_CHILDREN;
         break;
       case 0: /* h-same */
         BFAM_ASSERT(ud_src->subd_id >= 0);
@@ -5373,8 +6665,9 @@ void bfam_domain_pxest_transfer_maps_init(
             (int8_t)p4est_quadrant_child_id(quad_dst);
         maps->dst_to_src_subd_id[k_dst] = ud_src->subd_id;
         maps->dst_to_src_elem_id[k_dst] = ud_src->elem_id;
+        maps->dst_to_src_lvl_diff[k_dst] = 0;
+        maps->dst_to_src_path[k_dst] = 0;
 
-        k_src += 1;
         k_dst += 1;
         z_src += 1;
         z_dst += 1;
@@ -5384,6 +6677,8 @@ void bfam_domain_pxest_transfer_maps_init(
       }
     }
   }
+  BFAM_ASSERT(k_dst == maps->num_dst);
+  BFAM_ASSERT(coarse_k_src == maps->num_coarse_src);
 }
 
 void bfam_domain_pxest_transfer_maps_free(
@@ -5393,9 +6688,14 @@ void bfam_domain_pxest_transfer_maps_free(
   bfam_free_aligned(maps->dst_to_dst_chld_id);
   bfam_free_aligned(maps->dst_to_src_subd_id);
   bfam_free_aligned(maps->dst_to_src_elem_id);
+  bfam_free_aligned(maps->dst_to_src_lvl_diff);
+  bfam_free_aligned(maps->dst_to_src_path);
+  bfam_free_aligned(maps->coarse_dst_to_src_offset);
   bfam_free_aligned(maps->coarse_dst_to_src_chld_id);
   bfam_free_aligned(maps->coarse_dst_to_src_subd_id);
   bfam_free_aligned(maps->coarse_dst_to_src_elem_id);
+  bfam_free_aligned(maps->coarse_dst_to_src_lvl_diff);
+  bfam_free_aligned(maps->coarse_dst_to_src_path);
 }
 
 // }}}
@@ -5480,8 +6780,12 @@ static void fill_interp_proj_data(bfam_locidx_t N_a, bfam_locidx_t N_g,
 
   bfam_jacobi_p_interpolation(0, 0, N_a, Np_g, lr_g, V_a, I_a2g);
 
-  bfam_long_real_t MP_g2a[Np_g * Np_a];
-  bfam_long_real_t Vt_MP_g2a[Np_g * Np_a];
+  bfam_arena_t *scratch = bfam_scratch_arena();
+  const size_t mark = bfam_arena_mark(scratch);
+  bfam_long_real_t *MP_g2a =
+      bfam_arena_alloc(scratch, Np_g * Np_a * sizeof(bfam_long_real_t));
+  bfam_long_real_t *Vt_MP_g2a =
+      bfam_arena_alloc(scratch, Np_g * Np_a * sizeof(bfam_long_real_t));
   for (bfam_locidx_t n = 0; n < Np_g * Np_a; n++)
   {
     MP_g2a[n] = 0;
@@ -5501,6 +6805,8 @@ static void fill_interp_proj_data(bfam_locidx_t N_a, bfam_locidx_t N_g,
   /* [Np_a X Np_g] = [Np_a X Np_a] [Np_a X Np_g] */
   bfam_util_mmmult(Np_a, Np_g, Np_a, V_a, Np_a, Vt_MP_g2a, Np_a, P_g2a, Np_a);
 
+  bfam_arena_release(scratch, mark);
+
   /*
   if (N_g != N_a)
   {
@@ -5521,9 +6827,14 @@ static void fill_hanging_data(bfam_locidx_t N, bfam_locidx_t Np,
 {
   const bfam_long_real_t HALF = BFAM_LONG_REAL(0.5);
 
+  bfam_arena_t *scratch = bfam_scratch_arena();
+  const size_t mark = bfam_arena_mark(scratch);
+
   /* Grid for the top and bottom */
-  bfam_long_real_t lr_t[Np];
-  bfam_long_real_t lr_b[Np];
+  bfam_long_real_t *lr_t =
+      bfam_arena_alloc(scratch, Np * sizeof(bfam_long_real_t));
+  bfam_long_real_t *lr_b =
+      bfam_arena_alloc(scratch, Np * sizeof(bfam_long_real_t));
 
   for (bfam_locidx_t k = 0; k < Np; k++)
   {
@@ -5532,12 +6843,15 @@ static void fill_hanging_data(bfam_locidx_t N, bfam_locidx_t Np,
   }
 
   /* Mass matrix for the top and bottom */
-  bfam_long_real_t Mh[Np * Np];
+  bfam_long_real_t *Mh =
+      bfam_arena_alloc(scratch, Np * Np * sizeof(bfam_long_real_t));
   for (bfam_locidx_t k = 0; k < Np * Np; k++)
     Mh[k] = HALF * M[k];
 
   fill_interp_proj_data(N, N, lV, M, Mh, lr_t, I_f2t, P_t2f);
   fill_interp_proj_data(N, N, lV, M, Mh, lr_b, I_f2b, P_b2f);
+
+  bfam_arena_release(scratch, mark);
 }
 
 static void multiply_projections(const int N_b, const int N_a, const int N_g,
@@ -5567,9 +6881,14 @@ static void multiply_projections(const int N_b, const int N_a, const int N_g,
 
   /* First set up the long storage for multiplication */
 
-  bfam_long_real_t tmp[Np_b * Np_a];
+  bfam_arena_t *scratch = bfam_scratch_arena();
+  const size_t mark = bfam_arena_mark(scratch);
+
+  bfam_long_real_t *tmp =
+      bfam_arena_alloc(scratch, Np_b * Np_a * sizeof(bfam_long_real_t));
   bfam_long_real_t *l_P = tmp;
-  bfam_long_real_t l_MP[Np_b * Np_a];
+  bfam_long_real_t *l_MP =
+      bfam_arena_alloc(scratch, Np_b * Np_a * sizeof(bfam_long_real_t));
 
   for (bfam_locidx_t n = 0; n < Np_a * Np_b; n++)
   {
@@ -5601,6 +6920,8 @@ static void multiply_projections(const int N_b, const int N_a, const int N_g,
   for (bfam_locidx_t j = 0; j < Np_a; j++)
     for (bfam_locidx_t i = 0; i < Np_b; i++)
       wiMP_a2b[i + j * Np_b] = (bfam_real_t)(l_MP[i + j * Np_b] / w_b[i]);
+
+  bfam_arena_release(scratch, mark);
 }
 
 static void create_interpolators(bfam_subdomain_dgx_interpolator_t *interp_a2b,
@@ -5618,32 +6939,36 @@ static void create_interpolators(bfam_subdomain_dgx_interpolator_t *interp_a2b,
   if (interp_b2a)
     init_interpolator(interp_b2a, N_b, N_a);
 
+  bfam_arena_t *scratch = bfam_scratch_arena();
+  const size_t mark = bfam_arena_mark(scratch);
+  const size_t sz = sizeof(bfam_long_real_t);
+
   /* Set up the reference grids for the side a */
-  bfam_long_real_t lr_a[Np_a];
-  bfam_long_real_t lw_a[Np_a];
-  bfam_long_real_t V_a[Np_a * Np_a];
-  bfam_long_real_t M_a[Np_a * Np_a];
+  bfam_long_real_t *lr_a = bfam_arena_alloc(scratch, sz * Np_a);
+  bfam_long_real_t *lw_a = bfam_arena_alloc(scratch, sz * Np_a);
+  bfam_long_real_t *V_a = bfam_arena_alloc(scratch, sz * Np_a * Np_a);
+  bfam_long_real_t *M_a = bfam_arena_alloc(scratch, sz * Np_a * Np_a);
   fill_grid_data(N_a, lr_a, lw_a, V_a, M_a);
 
   /* Set up the reference grids for the side b */
-  bfam_long_real_t lr_b[Np_b];
-  bfam_long_real_t lw_b[Np_b];
-  bfam_long_real_t V_b[Np_b * Np_b];
-  bfam_long_real_t M_b[Np_b * Np_b];
+  bfam_long_real_t *lr_b = bfam_arena_alloc(scratch, sz * Np_b);
+  bfam_long_real_t *lw_b = bfam_arena_alloc(scratch, sz * Np_b);
+  bfam_long_real_t *V_b = bfam_arena_alloc(scratch, sz * Np_b * Np_b);
+  bfam_long_real_t *M_b = bfam_arena_alloc(scratch, sz * Np_b * Np_b);
   fill_grid_data(N_b, lr_b, lw_b, V_b, M_b);
 
   /* Set up the reference grids for the glue space */
-  bfam_long_real_t lr_g[Np_g];
-  bfam_long_real_t lw_g[Np_g];
-  bfam_long_real_t V_g[Np_g * Np_g];
-  bfam_long_real_t M_g[Np_g * Np_g];
+  bfam_long_real_t *lr_g = bfam_arena_alloc(scratch, sz * Np_g);
+  bfam_long_real_t *lw_g = bfam_arena_alloc(scratch, sz * Np_g);
+  bfam_long_real_t *V_g = bfam_arena_alloc(scratch, sz * Np_g * Np_g);
+  bfam_long_real_t *M_g = bfam_arena_alloc(scratch, sz * Np_g * Np_g);
   fill_grid_data(N_g, lr_g, lw_g, V_g, M_g);
 
   /* Interpolate to the hanging faces */
   bfam_long_real_t *prj_g[5];
   prj_g[0] = NULL;
   for (bfam_locidx_t k = 1; k < 5; k++)
-    prj_g[k] = bfam_malloc_aligned(sizeof(bfam_long_real_t) * Np_g * Np_g);
+    prj_g[k] = bfam_arena_alloc(scratch, sz * Np_g * Np_g);
 
   fill_hanging_data(N_g, Np_g, lr_g, M_g, V_g, prj_g[1], prj_g[2], prj_g[3],
                     prj_g[4]);
@@ -5655,14 +6980,14 @@ static void create_interpolators(bfam_subdomain_dgx_interpolator_t *interp_a2b,
   bfam_long_real_t *P_g2b = NULL;
   if (N_a < N_g && N_b == N_g)
   {
-    I_a2g = bfam_malloc_aligned(sizeof(bfam_long_real_t) * Np_g * Np_a);
-    P_g2a = bfam_malloc_aligned(sizeof(bfam_long_real_t) * Np_g * Np_a);
+    I_a2g = bfam_arena_alloc(scratch, sz * Np_g * Np_a);
+    P_g2a = bfam_arena_alloc(scratch, sz * Np_g * Np_a);
     fill_interp_proj_data(N_a, N_g, V_a, M_a, M_g, lr_g, I_a2g, P_g2a);
   }
   if (N_a == N_g && N_b < N_g)
   {
-    I_b2g = bfam_malloc_aligned(sizeof(bfam_long_real_t) * Np_g * Np_b);
-    P_g2b = bfam_malloc_aligned(sizeof(bfam_long_real_t) * Np_g * Np_b);
+    I_b2g = bfam_arena_alloc(scratch, sz * Np_g * Np_b);
+    P_g2b = bfam_arena_alloc(scratch, sz * Np_g * Np_b);
     fill_interp_proj_data(N_b, N_g, V_b, M_b, M_g, lr_g, I_b2g, P_g2b);
   }
 
@@ -5676,18 +7001,7 @@ static void create_interpolators(bfam_subdomain_dgx_interpolator_t *interp_a2b,
                            interp_b2a->prj[k], M_a, interp_b2a->mass_prj[k],
                            lw_a, interp_b2a->wi_mass_prj[k]);
 
-  if (I_a2g)
-    bfam_free_aligned(I_a2g);
-  if (P_g2a)
-    bfam_free_aligned(P_g2a);
-  if (I_b2g)
-    bfam_free_aligned(I_b2g);
-  if (P_g2b)
-    bfam_free_aligned(P_g2b);
-  bfam_free_aligned(prj_g[1]);
-  bfam_free_aligned(prj_g[2]);
-  bfam_free_aligned(prj_g[3]);
-  bfam_free_aligned(prj_g[4]);
+  bfam_arena_release(scratch, mark);
 }
 
 /** return a pointer to the interpolator for the given orders (created and
@@ -5869,50 +7183,178 @@ static void bfam_subdomain_dgx_comm_info(bfam_subdomain_t *thisSubdomain,
       *recv_sz);
 }
 
+/** Apply a 1D operator along one direction of a batch of tensor product data
+ *
+ * The input is \c in[outer][Nq_s][inner] and the output is
+ * \c out[outer][Nq_d][inner] with \c out = \a A applied along the middle
+ * index; \a A is \c Nq_d \c x \c Nq_s in column-major order and if \c NULL
+ * is taken to be the identity.
+ */
+static void bfam_subdomain_dgx_tensor_contract(
+    const bfam_locidx_t outer, const int Nq_s, const int Nq_d, const int inner,
+    const bfam_real_t *restrict A, const bfam_real_t *restrict in,
+    bfam_real_t *restrict out)
+{
+  if (!A)
+  {
+    BFAM_ASSERT(Nq_s == Nq_d);
+    memcpy(out, in, (size_t)outer * Nq_s * inner * sizeof(bfam_real_t));
+    return;
+  }
+
+  BFAM_PRAGMA_OMP(parallel for schedule(static))
+  for (bfam_locidx_t o = 0; o < outer; ++o)
+  {
+    const bfam_real_t *restrict in_o = in + (size_t)o * Nq_s * inner;
+    bfam_real_t *restrict out_o = out + (size_t)o * Nq_d * inner;
+    for (int m = 0; m < Nq_d; ++m)
+    {
+      bfam_real_t *restrict out_m = out_o + m * inner;
+      for (int p = 0; p < inner; ++p)
+        out_m[p] = 0;
+      for (int l = 0; l < Nq_s; ++l)
+      {
+        const bfam_real_t a = A[m + l * Nq_d];
+        const bfam_real_t *restrict in_l = in_o + l * inner;
+        for (int p = 0; p < inner; ++p)
+          out_m[p] += a * in_l[p];
+      }
+    }
+  }
+}
+
+/** Apply the tensor product of the square 1D operators \a A to \a num
+ *  elements with the element batched kernels \a batch.
+ *
+ * The elements are gathered interleaved in groups of the batch width (the
+ * unused lanes of the last group are zero) into scratch from the arena of
+ * each thread.
+ */
+static void bfam_subdomain_dgx_tensor_apply_batch(
+    const bfam_kron_kernels_t *batch, const int inDIM,
+    const bfam_locidx_t num, const int Nq, const bfam_real_t *A[3],
+    const bfam_real_t *src, bfam_real_t *dst)
+{
+  const int width = batch->width;
+  const int Np = bfam_ipow(Nq, inDIM);
+  const size_t line = (size_t)Np * width;
+
+  /* direction 0 is the fastest */
+  const bfam_kron_kernel_t D[3] = {
+      (inDIM == 2) ? batch->ixa : batch->ixixa,
+      (inDIM == 2) ? batch->axi : batch->ixaxi, batch->axixi};
+
+  const bfam_locidx_t num_groups = (num + width - 1) / width;
+
+  BFAM_PRAGMA_OMP(parallel)
+  {
+    bfam_arena_t *scratch = bfam_scratch_arena();
+    const size_t mark = bfam_arena_mark(scratch);
+    bfam_real_t *x = bfam_arena_alloc(scratch, 2 * line * sizeof(bfam_real_t));
+    bfam_real_t *y = x + line;
+
+    BFAM_PRAGMA_OMP(for schedule(static))
+    for (bfam_locidx_t g = 0; g < num_groups; ++g)
+    {
+      const bfam_locidx_t e0 = g * width;
+      const int nb = (int)BFAM_MIN(width, num - e0);
+
+      const bfam_real_t *restrict in = src + (size_t)e0 * Np;
+      for (int n = 0; n < Np; ++n)
+        for (int b = 0; b < width; ++b)
+          x[n * width + b] = (b < nb) ? in[(size_t)Np * b + n] : 0;
+
+      for (int d = 0; d < inDIM; ++d)
+        if (A[d])
+        {
+          D[d](Nq, A[d], x, y);
+          bfam_real_t *t = x;
+          x = y;
+          y = t;
+        }
+
+      bfam_real_t *restrict out = dst + (size_t)e0 * Np;
+      for (int b = 0; b < nb; ++b)
+        for (int n = 0; n < Np; ++n)
+          out[(size_t)Np * b + n] = x[n * width + b];
+    }
+
+    bfam_arena_release(scratch, mark);
+  }
+}
+
+/** Apply the tensor product of the 1D operators \a A to a batch of \a num
+ *  elements using sum factorization.
+ *
+ * Square operators of low order in 2D and 3D use the element batched
+ * kernels of \c bfam_kron_get_low_order_kernels. Otherwise \a work1 and
+ * \a work2 must hold \c num*max(Nq_s,Nq_d)^inDIM reals.
+ */
+static void bfam_subdomain_dgx_tensor_apply(
+    const int inDIM, const bfam_locidx_t num, const int Nq_s, const int Nq_d,
+    const bfam_real_t *A[3], const bfam_real_t *src, bfam_real_t *dst,
+    bfam_real_t *work1, bfam_real_t *work2)
+{
+  if (Nq_s == Nq_d && (inDIM == 2 || inDIM == 3))
+  {
+    const bfam_kron_kernels_t *batch =
+        bfam_kron_get_low_order_kernels(Nq_s - 1);
+    if (batch)
+    {
+      bfam_subdomain_dgx_tensor_apply_batch(batch, inDIM, num, Nq_s, A, src,
+                                            dst);
+      return;
+    }
+  }
+
+  const bfam_real_t *in = src;
+  int inner = 1;
+  int outer_q = bfam_ipow(Nq_s, inDIM - 1);
+  for (int d = 0; d < inDIM; ++d)
+  {
+    bfam_real_t *out = (d == inDIM - 1) ? dst : ((d % 2) ? work2 : work1);
+    bfam_subdomain_dgx_tensor_contract(num * outer_q, Nq_s, Nq_d, inner, A[d],
+                                       in, out);
+    in = out;
+    inner *= Nq_d;
+    outer_q /= Nq_s;
+  }
+}
+
+/* number of elements resampled per pass for vtk output */
+#define BFAM_VTK_INTERP_BATCH 256
+
+/** Resample \a K elements of order \a N_s to order \a N_d for vtk output
+ *
+ * The tensor product of the 1D operator \a interp is applied with sum
+ * factorization, \a BFAM_VTK_INTERP_BATCH elements at a time. The scratch
+ * \a work is shared by all fields being written and must hold
+ * <tt>2*min(K,BFAM_VTK_INTERP_BATCH)*max(N_s+1,N_d+1)^inDIM</tt> reals.
+ */
 static void bfam_subdomain_dgx_vtk_interp(bfam_locidx_t K, int N_d,
                                           bfam_real_t *restrict d, int N_s,
                                           const bfam_real_t *restrict s,
                                           const bfam_real_t *restrict interp,
-                                          int inDIM)
+                                          int inDIM, bfam_real_t *work)
 {
   BFAM_ASSUME_ALIGNED(d, 32);
   BFAM_ASSUME_ALIGNED(s, 32);
   BFAM_ASSUME_ALIGNED(interp, 32);
-  for (bfam_locidx_t elem = 0; elem < K; ++elem)
-  {
-    const int Np_d = bfam_ipow(N_d + 1, inDIM);
-    const int Np_s = bfam_ipow(N_s + 1, inDIM);
-
-    const bfam_locidx_t o_d = elem * Np_d;
-    const bfam_locidx_t o_s = elem * Np_s;
-
-    for (bfam_locidx_t n = 0; n < Np_d; n++)
-      d[o_d + n] = 0;
-    if (inDIM == 1)
-      for (int l = 0; l < N_s + 1; l++)
-        for (int i = 0; i < N_d + 1; i++)
-          d[o_d + i] += interp[(N_d + 1) * l + i] * s[o_s + l];
-    else if (inDIM == 2)
-      for (int m = 0; m < N_s + 1; m++)
-        for (int l = 0; l < N_s + 1; l++)
-          for (int j = 0; j < N_d + 1; j++)
-            for (int i = 0; i < N_d + 1; i++)
-              d[o_d + j * (N_d + 1) + i] += interp[(N_d + 1) * m + j] *
-                                            interp[(N_d + 1) * l + i] *
-                                            s[o_s + m * (N_s + 1) + l];
-    else if (inDIM == 3)
-      for (int n = 0; n < N_s + 1; n++)
-        for (int m = 0; m < N_s + 1; m++)
-          for (int l = 0; l < N_s + 1; l++)
-            for (int k = 0; k < N_d + 1; k++)
-              for (int j = 0; j < N_d + 1; j++)
-                for (int i = 0; i < N_d + 1; i++)
-                  d[o_d + k * (N_d + 1) * (N_d + 1) + j * (N_d + 1) + i] +=
-                      interp[(N_d + 1) * l + i] * interp[(N_d + 1) * m + j] *
-                      interp[(N_d + 1) * n + k] *
-                      s[o_s + n * (N_s + 1) * (N_s + 1) + m * (N_s + 1) + l];
-    else
-      BFAM_ABORT("Cannot handle dim = %d", inDIM);
+  BFAM_ABORT_IF(inDIM < 1 || inDIM > 3, "Cannot handle dim = %d", inDIM);
+
+  const int Np_d = bfam_ipow(N_d + 1, inDIM);
+  const int Np_s = bfam_ipow(N_s + 1, inDIM);
+  const size_t work_sz =
+      (size_t)BFAM_MIN(K, BFAM_VTK_INTERP_BATCH) *
+      (size_t)bfam_ipow(BFAM_MAX(N_s, N_d) + 1, inDIM);
+  const bfam_real_t *A[3] = {interp, interp, interp};
+
+  for (bfam_locidx_t k = 0; k < K; k += BFAM_VTK_INTERP_BATCH)
+  {
+    const bfam_locidx_t num = BFAM_MIN(K - k, BFAM_VTK_INTERP_BATCH);
+    bfam_subdomain_dgx_tensor_apply(inDIM, num, N_s + 1, N_d + 1, A,
+                                    s + (size_t)k * Np_s, d + (size_t)k * Np_d,
+                                    work, work + work_sz);
   }
 }
 
@@ -6072,6 +7514,7 @@ static int bfam_subdomain_dgx_vtk_write_vtu_piece(
   bfam_real_t *restrict stor1 = NULL;
   bfam_real_t *restrict stor2 = NULL;
   bfam_real_t *restrict stor3 = NULL;
+  bfam_real_t *work = NULL;
 
   if (Np_write > 0)
   {
@@ -6100,6 +7543,9 @@ static int bfam_subdomain_dgx_vtk_write_vtu_piece(
     stor1 = bfam_malloc_aligned(sizeof(bfam_real_t) * Np_vtk * K);
     stor2 = bfam_malloc_aligned(sizeof(bfam_real_t) * Np_vtk * K);
     stor3 = bfam_malloc_aligned(sizeof(bfam_real_t) * Np_vtk * K);
+    const int Np_max = bfam_ipow(BFAM_MAX(sub->N, N_vtk) + 1, sub->dim);
+    work = bfam_malloc_aligned(sizeof(bfam_real_t) * 2 * Np_max *
+                               BFAM_MIN(K, BFAM_VTK_INTERP_BATCH));
 
     bfam_free_aligned(lr);
     bfam_free_aligned(cal_interp);
@@ -6125,11 +7571,13 @@ static int bfam_subdomain_dgx_vtk_write_vtu_piece(
   }
   else
   {
-    bfam_subdomain_dgx_vtk_interp(K, N_vtk, stor1, sub->N, x, interp, sub->dim);
-    bfam_subdomain_dgx_vtk_interp(K, N_vtk, stor2, sub->N, y, interp, sub->dim);
+    bfam_subdomain_dgx_vtk_interp(K, N_vtk, stor1, sub->N, x, interp, sub->dim,
+                                  work);
+    bfam_subdomain_dgx_vtk_interp(K, N_vtk, stor2, sub->N, y, interp, sub->dim,
+                                  work);
     if (z != NULL)
       bfam_subdomain_dgx_vtk_interp(K, N_vtk, stor3, sub->N, z, interp,
-                                    sub->dim);
+                                    sub->dim, work);
     else
       for (bfam_locidx_t k = 0; k < Np_vtk * K; k++)
         stor3[k] = 0;
@@ -6510,7 +7958,7 @@ static int bfam_subdomain_dgx_vtk_write_vtu_piece(
       else
       {
         bfam_subdomain_dgx_vtk_interp(K, N_vtk, stor1, sub->N, sdata, interp,
-                                      sub->dim);
+                                      sub->dim, work);
       }
 
       bfam_vtk_write_real_scalar_data_array(file, scalars[s], writeBinary,
@@ -6545,11 +7993,11 @@ static int bfam_subdomain_dgx_vtk_write_vtu_piece(
       else
       {
         bfam_subdomain_dgx_vtk_interp(K, N_vtk, stor1, sub->N, v1, interp,
-                                      sub->dim);
+                                      sub->dim, work);
         bfam_subdomain_dgx_vtk_interp(K, N_vtk, stor2, sub->N, v2, interp,
-                                      sub->dim);
+                                      sub->dim, work);
         bfam_subdomain_dgx_vtk_interp(K, N_vtk, stor3, sub->N, v3, interp,
-                                      sub->dim);
+                                      sub->dim, work);
       }
 
       bfam_vtk_write_real_vector_data_array(file, vectors[v], writeBinary,
@@ -6567,6 +8015,7 @@ static int bfam_subdomain_dgx_vtk_write_vtu_piece(
     bfam_free_aligned(stor1);
     bfam_free_aligned(stor2);
     bfam_free_aligned(stor3);
+    bfam_free_aligned(work);
   }
   return 1;
 }
@@ -6893,6 +8342,7 @@ static void bfam_subdomain_dgx_null_all_values(bfam_subdomain_dgx_t *sub)
   sub->lr = NULL;
   sub->lw = NULL;
   sub->lV = NULL;
+  sub->kron = NULL;
   sub->K = 0;
   sub->vmapM = NULL;
   sub->vmapP = NULL;
@@ -7015,22 +8465,91 @@ static void bfam_subdomain_dgx_free(bfam_subdomain_t *thisSubdomain)
       (bfam_subdomain_dgx_glue_data_t *)sub->base.glue_p);
 }
 
-static void
-bfam_subdomain_dgx_generic_init(bfam_subdomain_dgx_t *subdomain,
-                                const bfam_locidx_t id, const bfam_locidx_t uid,
-                                const char *name, const int N,
-                                const bfam_locidx_t K, bfam_dictionary_t *N2N,
-                                bfam_dictionary_t *dgx_ops, const int inDIM)
+/* operator tables of each order stored in the dgx_ops dictionary as
+ * name_N */
+#define BFAM_DGX_NUM_OPS 8
+static const char *bfam_dgx_ops_names[BFAM_DGX_NUM_OPS] = {
+    "lr", "lw", "lV", "lDr", "Dr", "r", "w", "wi"};
+
+/* size in bytes of operator table i of order N */
+static size_t bfam_subdomain_dgx_ops_size(const int N, const int i)
 {
-  BFAM_ABORT_IF(inDIM < 0, "dimension %d is not possible in bfam", inDIM);
-  BFAM_ABORT_IF(inDIM == 0 && N != 0,
-                "if inDIM < 1 then N must be zero (i.e., constant");
+  const size_t Nrp = (size_t)N + 1;
+  switch (i)
+  {
+  case 0: /* lr */
+  case 1: /* lw */
+    return Nrp * sizeof(bfam_long_real_t);
+  case 2: /* lV */
+  case 3: /* lDr */
+    return Nrp * Nrp * sizeof(bfam_long_real_t);
+  case 4: /* Dr */
+    return Nrp * Nrp * sizeof(bfam_real_t);
+  default: /* r, w, wi */
+    return Nrp * sizeof(bfam_real_t);
+  }
+}
 
-  bfam_subdomain_init(&subdomain->base, id, uid, name);
-  bfam_subdomain_add_tag(&subdomain->base, "_subdomain_dgx");
-  char dim_str[BFAM_BUFSIZ];
-  snprintf(dim_str, BFAM_BUFSIZ, "_dimension_%d", inDIM);
-  bfam_subdomain_add_tag(&subdomain->base, dim_str);
+/* fill the operator tables of order N */
+static void bfam_subdomain_dgx_fill_ops(const int N, void **ops)
+{
+  const int Nrp = N + 1;
+  bfam_long_real_t *lr = ops[0];
+  bfam_long_real_t *lw = ops[1];
+  bfam_long_real_t *lV = ops[2];
+  bfam_long_real_t *lDr = ops[3];
+  bfam_real_t *Dr = ops[4];
+  bfam_real_t *r = ops[5];
+  bfam_real_t *w = ops[6];
+  bfam_real_t *wi = ops[7];
+
+  bfam_jacobi_gauss_lobatto_quadrature(0, 0, N, lr, lw);
+  bfam_jacobi_p_vandermonde(0, 0, N, Nrp, lr, lV);
+  bfam_jacobi_p_differentiation(0, 0, N, Nrp, lr, lV, lDr);
+
+  /* store the volume stuff */
+  for (int n = 0; n < Nrp; ++n)
+  {
+    r[n] = (bfam_real_t)lr[n];
+    w[n] = (bfam_real_t)lw[n];
+    wi[n] = (bfam_real_t)(1.0l / lw[n]);
+  }
+  for (int n = 0; n < Nrp * Nrp; ++n)
+  {
+    Dr[n] = (bfam_real_t)lDr[n];
+  }
+}
+
+/* insert the operator tables of order N into the dictionary */
+static void bfam_subdomain_dgx_insert_ops(bfam_dictionary_t *dgx_ops,
+                                          const int N, void **ops)
+{
+  char name[BFAM_BUFSIZ];
+  for (int i = 0; i < BFAM_DGX_NUM_OPS; ++i)
+  {
+    snprintf(name, BFAM_BUFSIZ, "%s_%d", bfam_dgx_ops_names[i], N);
+    int BFAM_UNUSED_VAR rval =
+        bfam_dictionary_insert_ptr(dgx_ops, name, ops[i]);
+    BFAM_ASSERT(rval != 1);
+  }
+}
+
+static void
+bfam_subdomain_dgx_generic_init(bfam_subdomain_dgx_t *subdomain,
+                                const bfam_locidx_t id, const bfam_locidx_t uid,
+                                const char *name, const int N,
+                                const bfam_locidx_t K, bfam_dictionary_t *N2N,
+                                bfam_dictionary_t *dgx_ops, const int inDIM)
+{
+  BFAM_ABORT_IF(inDIM < 0, "dimension %d is not possible in bfam", inDIM);
+  BFAM_ABORT_IF(inDIM == 0 && N != 0,
+                "if inDIM < 1 then N must be zero (i.e., constant");
+
+  bfam_subdomain_init(&subdomain->base, id, uid, name);
+  bfam_subdomain_add_tag(&subdomain->base, "_subdomain_dgx");
+  char dim_str[BFAM_BUFSIZ];
+  snprintf(dim_str, BFAM_BUFSIZ, "_dimension_%d", inDIM);
+  bfam_subdomain_add_tag(&subdomain->base, dim_str);
 
   bfam_subdomain_dgx_null_all_values(subdomain);
 
@@ -7078,80 +8597,17 @@ bfam_subdomain_dgx_generic_init(bfam_subdomain_dgx_t *subdomain,
       subdomain->lvl[k] = -1;
     }
 
-    /*
-     * TODO: query dictionary to see if we need to create this, otherwise used
-     * stored values
-     */
     BFAM_ASSERT(dgx_ops);
 
     char name[BFAM_BUFSIZ];
     snprintf(name, BFAM_BUFSIZ, "lr_%d", N);
     if (!bfam_dictionary_contains(dgx_ops, name))
     {
-
-      const int Nrp = N + 1;
-      bfam_long_real_t *lr =
-          bfam_malloc_aligned(Nrp * sizeof(bfam_long_real_t));
-      bfam_long_real_t *lw =
-          bfam_malloc_aligned(Nrp * sizeof(bfam_long_real_t));
-      bfam_long_real_t *lV =
-          bfam_malloc_aligned(Nrp * Nrp * sizeof(bfam_long_real_t));
-      bfam_long_real_t *lDr =
-          bfam_malloc_aligned(Nrp * Nrp * sizeof(bfam_long_real_t));
-      bfam_real_t *Dr = bfam_malloc_aligned(Nrp * Nrp * sizeof(bfam_real_t));
-      bfam_real_t *r = bfam_malloc_aligned(Nrp * sizeof(bfam_real_t));
-      bfam_real_t *w = bfam_malloc_aligned(Nrp * sizeof(bfam_real_t));
-      bfam_real_t *wi = bfam_malloc_aligned(Nrp * sizeof(bfam_real_t));
-
-      bfam_jacobi_gauss_lobatto_quadrature(0, 0, N, lr, lw);
-      bfam_jacobi_p_vandermonde(0, 0, N, Nrp, lr, lV);
-      bfam_jacobi_p_differentiation(0, 0, N, Nrp, lr, lV, lDr);
-
-      /* store the volume stuff */
-      for (int n = 0; n < Nrp; ++n)
-      {
-        r[n] = (bfam_real_t)lr[n];
-        w[n] = (bfam_real_t)lw[n];
-        wi[n] = (bfam_real_t)(1.0l / lw[n]);
-      }
-      for (int n = 0; n < Nrp * Nrp; ++n)
-      {
-        Dr[n] = (bfam_real_t)lDr[n];
-      }
-
-      int BFAM_UNUSED_VAR rval = 1;
-
-      snprintf(name, BFAM_BUFSIZ, "lr_%d", N);
-      rval = bfam_dictionary_insert_ptr(dgx_ops, name, lr);
-      BFAM_ASSERT(rval != 1);
-
-      snprintf(name, BFAM_BUFSIZ, "lw_%d", N);
-      rval = bfam_dictionary_insert_ptr(dgx_ops, name, lw);
-      BFAM_ASSERT(rval != 1);
-
-      snprintf(name, BFAM_BUFSIZ, "lV_%d", N);
-      rval = bfam_dictionary_insert_ptr(dgx_ops, name, lV);
-      BFAM_ASSERT(rval != 1);
-
-      snprintf(name, BFAM_BUFSIZ, "lDr_%d", N);
-      rval = bfam_dictionary_insert_ptr(dgx_ops, name, lDr);
-      BFAM_ASSERT(rval != 1);
-
-      snprintf(name, BFAM_BUFSIZ, "Dr_%d", N);
-      rval = bfam_dictionary_insert_ptr(dgx_ops, name, Dr);
-      BFAM_ASSERT(rval != 1);
-
-      snprintf(name, BFAM_BUFSIZ, "r_%d", N);
-      rval = bfam_dictionary_insert_ptr(dgx_ops, name, r);
-      BFAM_ASSERT(rval != 1);
-
-      snprintf(name, BFAM_BUFSIZ, "w_%d", N);
-      rval = bfam_dictionary_insert_ptr(dgx_ops, name, w);
-      BFAM_ASSERT(rval != 1);
-
-      snprintf(name, BFAM_BUFSIZ, "wi_%d", N);
-      rval = bfam_dictionary_insert_ptr(dgx_ops, name, wi);
-      BFAM_ASSERT(rval != 1);
+      void *ops[BFAM_DGX_NUM_OPS];
+      for (int i = 0; i < BFAM_DGX_NUM_OPS; ++i)
+        ops[i] = bfam_malloc_aligned(bfam_subdomain_dgx_ops_size(N, i));
+      bfam_subdomain_dgx_fill_ops(N, ops);
+      bfam_subdomain_dgx_insert_ops(dgx_ops, N, ops);
     }
 
     snprintf(name, BFAM_BUFSIZ, "lr_%d", N);
@@ -7166,6 +8622,8 @@ bfam_subdomain_dgx_generic_init(bfam_subdomain_dgx_t *subdomain,
     subdomain->lV = bfam_dictionary_get_value_ptr(dgx_ops, name);
     BFAM_ASSERT(subdomain->lV != NULL);
 
+    subdomain->kron = bfam_kron_get_kernels(N);
+
     snprintf(name, BFAM_BUFSIZ, "lDr_%d", N);
     subdomain->lDr = bfam_dictionary_get_value_ptr(dgx_ops, name);
     BFAM_ASSERT(subdomain->lDr != NULL);
@@ -7562,6 +9020,479 @@ static bfam_subdomain_dgx_t *bfam_subdomain_dgx_glue_new(
   return newSubdomain;
 }
 
+/** Reorder the elements of a subdomain with reverse Cuthill-McKee
+ *
+ * The element connectivity \a EToE (which contains the element itself for
+ * faces without a local neighbor) is used as the graph. On return \a EToQ,
+ * \a EToE, and \a EToF have been permuted to the new ordering and the
+ * neighbor numbers in \a EToE renumbered.
+ */
+static void bfam_domain_pxest_rcm_reorder(bfam_locidx_t K, bfam_locidx_t *EToQ,
+                                          bfam_locidx_t *EToE, int8_t *EToF)
+{
+  if (K < 3)
+    return;
+
+  const int NFACES = P4EST_FACES;
+
+  bfam_locidx_t *perm = bfam_malloc(K * sizeof(bfam_locidx_t));
+  bfam_locidx_t *iperm = bfam_malloc(K * sizeof(bfam_locidx_t));
+  int8_t *degree = bfam_malloc(K * sizeof(int8_t));
+
+  for (bfam_locidx_t k = 0; k < K; ++k)
+  {
+    int8_t d = 0;
+    for (int f = 0; f < NFACES; ++f)
+      if (EToE[NFACES * k + f] != k)
+        ++d;
+    degree[k] = d;
+    iperm[k] = -1;
+  }
+
+  /*
+   * Cuthill-McKee: breadth first search started from a minimum degree
+   * element of each connected component with the neighbors visited in order
+   * of increasing degree; iperm is used as the visited marker
+   */
+  bfam_locidx_t head = 0, tail = 0;
+  for (bfam_locidx_t start = 0; tail < K;)
+  {
+    bfam_locidx_t root = -1;
+    for (bfam_locidx_t k = start; k < K; ++k)
+      if (iperm[k] < 0 && (root < 0 || degree[k] < degree[root]))
+        root = k;
+    BFAM_ASSERT(root >= 0);
+    while (start < K && iperm[start] >= 0)
+      ++start;
+
+    iperm[root] = tail;
+    perm[tail++] = root;
+
+    for (; head < tail; ++head)
+    {
+      const bfam_locidx_t k = perm[head];
+      bfam_locidx_t nbrs[P4EST_FACES];
+      int num_nbrs = 0;
+
+      for (int f = 0; f < NFACES; ++f)
+      {
+        const bfam_locidx_t nk = EToE[NFACES * k + f];
+        if (iperm[nk] >= 0)
+          continue;
+
+        /* insertion sort by degree */
+        int n = num_nbrs++;
+        for (; n > 0 && degree[nbrs[n - 1]] > degree[nk]; --n)
+          nbrs[n] = nbrs[n - 1];
+        nbrs[n] = nk;
+        iperm[nk] = K; /* mark as queued */
+      }
+
+      for (int n = 0; n < num_nbrs; ++n)
+      {
+        iperm[nbrs[n]] = tail;
+        perm[tail++] = nbrs[n];
+      }
+    }
+  }
+  BFAM_ASSERT(tail == K);
+
+  /* reverse */
+  for (bfam_locidx_t k = 0; k < K / 2; ++k)
+  {
+    const bfam_locidx_t tmp = perm[k];
+    perm[k] = perm[K - 1 - k];
+    perm[K - 1 - k] = tmp;
+  }
+  for (bfam_locidx_t k = 0; k < K; ++k)
+    iperm[perm[k]] = k;
+
+  /*
+   * Apply the permutation
+   */
+  bfam_locidx_t *oldEToQ = bfam_malloc(K * sizeof(bfam_locidx_t));
+  bfam_locidx_t *oldEToE = bfam_malloc(K * NFACES * sizeof(bfam_locidx_t));
+  int8_t *oldEToF = bfam_malloc(K * NFACES * sizeof(int8_t));
+  memcpy(oldEToQ, EToQ, K * sizeof(bfam_locidx_t));
+  memcpy(oldEToE, EToE, K * NFACES * sizeof(bfam_locidx_t));
+  memcpy(oldEToF, EToF, K * NFACES * sizeof(int8_t));
+
+  for (bfam_locidx_t k = 0; k < K; ++k)
+  {
+    const bfam_locidx_t ok = perm[k];
+    EToQ[k] = oldEToQ[ok];
+    for (int f = 0; f < NFACES; ++f)
+    {
+      EToE[NFACES * k + f] = iperm[oldEToE[NFACES * ok + f]];
+      EToF[NFACES * k + f] = oldEToF[NFACES * ok + f];
+    }
+  }
+
+  bfam_free(oldEToQ);
+  bfam_free(oldEToE);
+  bfam_free(oldEToF);
+  bfam_free(degree);
+  bfam_free(iperm);
+  bfam_free(perm);
+}
+
+/* tables in the shared window start on cache line boundaries */
+#define BFAM_OPS_ALIGN 64
+
+static size_t bfam_domain_pxest_ops_pad(const size_t size)
+{
+  return (size + BFAM_OPS_ALIGN - 1) / BFAM_OPS_ALIGN * BFAM_OPS_ALIGN;
+}
+
+/*
+ * Walk the layout of the shared operator tables starting at base: the
+ * tables of each order followed by the projections, mass projections, and
+ * LGL mass projections of each pair of orders. With fill the tables are
+ * computed, with attach they are inserted into the dictionaries of the
+ * domain. Returns the size of the layout.
+ */
+static size_t bfam_domain_pxest_ops_walk(bfam_domain_pxest_t *domain,
+                                         const int N_min, const int N_max,
+                                         char *base, const int fill,
+                                         const int attach)
+{
+  char *p = base;
+  size_t size = 0;
+
+  for (int N = N_min; N <= N_max; ++N)
+  {
+    void *ops[BFAM_DGX_NUM_OPS];
+    const size_t start = size;
+    for (int i = 0; i < BFAM_DGX_NUM_OPS; ++i)
+    {
+      ops[i] = p + size;
+      size += bfam_domain_pxest_ops_pad(bfam_subdomain_dgx_ops_size(N, i));
+    }
+    if (fill)
+    {
+      memset(p + start, 0, size - start);
+      bfam_subdomain_dgx_fill_ops(N, ops);
+    }
+    if (attach)
+      bfam_subdomain_dgx_insert_ops(domain->dgx_ops, N, ops);
+  }
+
+  for (int N_a = N_min; N_a <= N_max; ++N_a)
+    for (int N_b = N_min; N_b <= N_max; ++N_b)
+    {
+      /* the tables are len bytes, each padded to bytes */
+      const size_t len = (size_t)(N_a + 1) * (N_b + 1) * sizeof(bfam_real_t);
+      const size_t bytes = bfam_domain_pxest_ops_pad(len);
+
+      bfam_subdomain_dgx_interpolator_t *src = NULL;
+      if (fill)
+      {
+        src = bfam_malloc(sizeof(bfam_subdomain_dgx_interpolator_t));
+        create_interpolators(src, NULL, N_a, N_b);
+      }
+
+      bfam_subdomain_dgx_interpolator_t *interp = NULL;
+      if (attach)
+      {
+        interp = bfam_malloc(sizeof(bfam_subdomain_dgx_interpolator_t));
+        interp->N_src = N_a;
+        interp->N_dst = N_b;
+        interp->num_prj = 5;
+        interp->prj = bfam_malloc(5 * sizeof(bfam_real_t *));
+        interp->mass_prj = bfam_malloc(5 * sizeof(bfam_real_t *));
+        interp->wi_mass_prj = bfam_malloc(5 * sizeof(bfam_real_t *));
+      }
+
+      for (int k = 0; k < 5; ++k)
+      {
+        bfam_real_t *prj = (bfam_real_t *)(p + size);
+        bfam_real_t *mass_prj = (bfam_real_t *)(p + size + bytes);
+        bfam_real_t *wi_mass_prj = (bfam_real_t *)(p + size + 2 * bytes);
+        size += 3 * bytes;
+
+        /* no projection without a change of order or level */
+        if (k == 0 && N_a == N_b)
+          prj = NULL;
+
+        if (fill)
+        {
+          /* zero the padding so that the cache file is deterministic */
+          memset(p + size - 3 * bytes, 0, 3 * bytes);
+          if (prj)
+            memcpy(prj, src->prj[k], len);
+          memcpy(mass_prj, src->mass_prj[k], len);
+          memcpy(wi_mass_prj, src->wi_mass_prj[k], len);
+        }
+        if (attach)
+        {
+          interp->prj[k] = prj;
+          interp->mass_prj[k] = mass_prj;
+          interp->wi_mass_prj[k] = wi_mass_prj;
+        }
+      }
+
+      if (fill)
+        bfam_subdomain_dgx_clear_interpolation_dict(NULL, src, domain);
+
+      if (attach)
+      {
+        char name[BFAM_BUFSIZ];
+        snprintf(name, BFAM_BUFSIZ, "%d_to_%d", N_a, N_b);
+        int BFAM_UNUSED_VAR rval =
+            bfam_dictionary_insert_ptr(domain->N2N, name, interp);
+        BFAM_ASSERT(rval != 1);
+      }
+    }
+
+  return size;
+}
+
+/*
+ * Operator cache file layout: magic, header (version, sizeof(bfam_real_t),
+ * sizeof(bfam_long_real_t), N_min, N_max, size of the tables) followed by
+ * the tables in the layout of bfam_domain_pxest_ops_walk
+ */
+#define BFAM_OPS_CACHE_MAGIC "bfam_ops"
+#define BFAM_OPS_CACHE_MAGIC_LEN 8
+#define BFAM_OPS_CACHE_VERSION 1
+#define BFAM_OPS_CACHE_NUM_HEAD 6
+
+/* read the tables from a cache file; returns 0 if the file does not match */
+static int bfam_domain_pxest_ops_read(const char *filename, const int N_min,
+                                      const int N_max, char *base,
+                                      const size_t size)
+{
+  FILE *stream = fopen(filename, "rb");
+  if (stream == NULL)
+    return 0;
+
+  const bfam_gloidx_t expected[BFAM_OPS_CACHE_NUM_HEAD] = {
+      BFAM_OPS_CACHE_VERSION, sizeof(bfam_real_t), sizeof(bfam_long_real_t),
+      N_min,                  N_max,               (bfam_gloidx_t)size};
+  char magic[BFAM_OPS_CACHE_MAGIC_LEN];
+  bfam_gloidx_t vals[BFAM_OPS_CACHE_NUM_HEAD];
+
+  int ok = fread(magic, 1, BFAM_OPS_CACHE_MAGIC_LEN, stream) ==
+               BFAM_OPS_CACHE_MAGIC_LEN &&
+           !memcmp(magic, BFAM_OPS_CACHE_MAGIC, BFAM_OPS_CACHE_MAGIC_LEN) &&
+           fread(vals, sizeof(vals), 1, stream) == 1 &&
+           !memcmp(vals, expected, sizeof(vals)) &&
+           fread(base, 1, size, stream) == size;
+
+  fclose(stream);
+
+  if (!ok)
+    BFAM_LDEBUG("Operator cache '%s' does not match, recomputing", filename);
+  return ok;
+}
+
+/* write the tables to a cache file, which is replaced atomically */
+static void bfam_domain_pxest_ops_write(const char *filename, const int N_min,
+                                        const int N_max, const char *base,
+                                        const size_t size)
+{
+  char tmpname[BFAM_BUFSIZ];
+  snprintf(tmpname, BFAM_BUFSIZ, "%s.%jd", filename, (intmax_t)getpid());
+
+  FILE *stream = fopen(tmpname, "wb");
+  if (stream == NULL)
+  {
+    BFAM_WARNING("Can't write operator cache '%s'", tmpname);
+    return;
+  }
+
+  const bfam_gloidx_t vals[BFAM_OPS_CACHE_NUM_HEAD] = {
+      BFAM_OPS_CACHE_VERSION, sizeof(bfam_real_t), sizeof(bfam_long_real_t),
+      N_min,                  N_max,               (bfam_gloidx_t)size};
+
+  int ok = fwrite(BFAM_OPS_CACHE_MAGIC, 1, BFAM_OPS_CACHE_MAGIC_LEN, stream) ==
+               BFAM_OPS_CACHE_MAGIC_LEN &&
+           fwrite(vals, sizeof(vals), 1, stream) == 1 &&
+           fwrite(base, 1, size, stream) == size;
+  ok = (fclose(stream) == 0) && ok;
+
+  if (ok && rename(tmpname, filename) == 0)
+    BFAM_LDEBUG("Wrote operator cache '%s'", filename);
+  else
+  {
+    BFAM_WARNING("Can't write operator cache '%s'", filename);
+    remove(tmpname);
+  }
+}
+
+/* fill the tables at base, from the cache file if there is a matching one */
+static void bfam_domain_pxest_ops_produce(bfam_domain_pxest_t *domain,
+                                          const int N_min, const int N_max,
+                                          char *base, const size_t size,
+                                          const char *filename)
+{
+  if (filename &&
+      bfam_domain_pxest_ops_read(filename, N_min, N_max, base, size))
+    return;
+
+  bfam_domain_pxest_ops_walk(domain, N_min, N_max, base, 1, 0);
+
+  if (filename)
+    bfam_domain_pxest_ops_write(filename, N_min, N_max, base, size);
+}
+
+/* broadcast the tables in chunks that fit an int count */
+static void bfam_domain_pxest_ops_bcast(char *base, const size_t size,
+                                        MPI_Comm comm)
+{
+  const size_t chunk = (size_t)1 << 30;
+  for (size_t o = 0; o < size; o += chunk)
+    BFAM_MPI_CHECK(MPI_Bcast(base + o, (int)BFAM_MIN(chunk, size - o),
+                             MPI_BYTE, 0, comm));
+}
+
+static void bfam_domain_pxest_ops_check(bfam_domain_pxest_t *domain,
+                                        const int N_min, const int N_max)
+{
+  BFAM_ABORT_IF(N_min < 0 || N_max < N_min, "Invalid orders %d to %d", N_min,
+                N_max);
+  BFAM_ABORT_IF(domain->ops_base != NULL,
+                "Operator tables are already precomputed");
+
+  char name[BFAM_BUFSIZ];
+  for (int N_a = N_min; N_a <= N_max; ++N_a)
+  {
+    snprintf(name, BFAM_BUFSIZ, "lr_%d", N_a);
+    BFAM_ABORT_IF(bfam_dictionary_contains(domain->dgx_ops, name),
+                  "Operators of order %d already created", N_a);
+    for (int N_b = N_min; N_b <= N_max; ++N_b)
+    {
+      snprintf(name, BFAM_BUFSIZ, "%d_to_%d", N_a, N_b);
+      BFAM_ABORT_IF(bfam_dictionary_contains(domain->N2N, name),
+                    "Interpolator %s already created", name);
+    }
+  }
+}
+
+void bfam_domain_pxest_load_ops(bfam_domain_pxest_t *domain, int N_min,
+                                int N_max, const char *filename)
+{
+  bfam_domain_pxest_ops_check(domain, N_min, N_max);
+
+  const size_t size =
+      bfam_domain_pxest_ops_walk(domain, N_min, N_max, NULL, 0, 0);
+  char *base = bfam_malloc_aligned(size);
+
+  int rank;
+  BFAM_MPI_CHECK(MPI_Comm_rank(domain->base.comm, &rank));
+  if (rank == 0)
+    bfam_domain_pxest_ops_produce(domain, N_min, N_max, base, size, filename);
+  bfam_domain_pxest_ops_bcast(base, size, domain->base.comm);
+
+  domain->ops_base = base;
+  domain->ops_size = size;
+  bfam_domain_pxest_ops_walk(domain, N_min, N_max, base, 0, 1);
+}
+
+void bfam_domain_pxest_kron_autotune(bfam_domain_pxest_t *domain,
+                                     const char *filename)
+{
+  bfam_domain_t *dbase = &domain->base;
+  bfam_subdomain_t **subdomains =
+      bfam_malloc(dbase->num_subdomains * sizeof(bfam_subdomain_t *));
+  bfam_locidx_t num_subdomains = 0;
+
+  const char *tags[] = {"_volume", "_glue", NULL};
+  bfam_domain_get_subdomains(dbase, BFAM_DOMAIN_OR, tags,
+                             dbase->num_subdomains, subdomains,
+                             &num_subdomains);
+
+  int has_N[BFAM_KRON_NUM_FIXED], any_N[BFAM_KRON_NUM_FIXED];
+  for (int n = 0; n < BFAM_KRON_NUM_FIXED; ++n)
+    has_N[n] = 0;
+  for (bfam_locidx_t s = 0; s < num_subdomains; ++s)
+  {
+    const int N = ((bfam_subdomain_dgx_t *)subdomains[s])->N;
+    if (N >= 1 && N <= BFAM_KRON_NUM_FIXED)
+      has_N[N - 1] = 1;
+  }
+  BFAM_MPI_CHECK(MPI_Allreduce(has_N, any_N, BFAM_KRON_NUM_FIXED, MPI_INT,
+                               MPI_MAX, dbase->comm));
+
+  int num_N = 0, N[BFAM_KRON_NUM_FIXED];
+  for (int n = 0; n < BFAM_KRON_NUM_FIXED; ++n)
+    if (any_N[n])
+      N[num_N++] = n + 1;
+
+  bfam_kron_autotune(dbase->comm, num_N, N, filename);
+
+  for (bfam_locidx_t s = 0; s < num_subdomains; ++s)
+  {
+    bfam_subdomain_dgx_t *sub = (bfam_subdomain_dgx_t *)subdomains[s];
+    sub->kron = bfam_kron_get_kernels(sub->N);
+  }
+
+  bfam_free(subdomains);
+}
+
+void bfam_domain_pxest_share_ops(bfam_domain_pxest_t *domain, int N_min,
+                                 int N_max, const char *filename)
+{
+  bfam_domain_pxest_ops_check(domain, N_min, N_max);
+
+  const size_t size =
+      bfam_domain_pxest_ops_walk(domain, N_min, N_max, NULL, 0, 0);
+
+  int rank;
+  BFAM_MPI_CHECK(MPI_Comm_rank(domain->base.comm, &rank));
+  BFAM_MPI_CHECK(MPI_Comm_split_type(domain->base.comm, MPI_COMM_TYPE_SHARED,
+                                     rank, MPI_INFO_NULL, &domain->ops_comm));
+  int node_rank;
+  BFAM_MPI_CHECK(MPI_Comm_rank(domain->ops_comm, &node_rank));
+
+  /* the first ranks of the nodes, rank 0 of the domain among them */
+  MPI_Comm roots_comm;
+  BFAM_MPI_CHECK(MPI_Comm_split(domain->base.comm,
+                                (node_rank == 0) ? 0 : MPI_UNDEFINED, rank,
+                                &roots_comm));
+
+  /* the first rank of the node owns the whole window */
+  char *base;
+  const MPI_Aint alloc = (node_rank == 0) ? (MPI_Aint)size + BFAM_OPS_ALIGN : 0;
+  BFAM_MPI_CHECK(MPI_Win_allocate_shared(alloc, 1, MPI_INFO_NULL,
+                                         domain->ops_comm, &base,
+                                         &domain->ops_win));
+  MPI_Aint win_size;
+  int disp_unit;
+  BFAM_MPI_CHECK(
+      MPI_Win_shared_query(domain->ops_win, 0, &win_size, &disp_unit, &base));
+
+  /* every rank uses the offset to the first aligned byte of the owner */
+  size_t offset = 0;
+  if (node_rank == 0)
+    offset = (BFAM_OPS_ALIGN - (uintptr_t)base % BFAM_OPS_ALIGN) %
+             BFAM_OPS_ALIGN;
+  BFAM_MPI_CHECK(
+      MPI_Bcast(&offset, sizeof(size_t), MPI_BYTE, 0, domain->ops_comm));
+  domain->ops_base = base + offset;
+  domain->ops_size = size;
+
+  /* the tables are computed (or read) once and sent to the other nodes */
+  BFAM_MPI_CHECK(MPI_Win_fence(0, domain->ops_win));
+  if (roots_comm != MPI_COMM_NULL)
+  {
+    if (rank == 0)
+      bfam_domain_pxest_ops_produce(domain, N_min, N_max, domain->ops_base,
+                                    size, filename);
+    bfam_domain_pxest_ops_bcast(domain->ops_base, size, roots_comm);
+    BFAM_MPI_CHECK(MPI_Comm_free(&roots_comm));
+  }
+  BFAM_MPI_CHECK(MPI_Win_fence(MPI_MODE_NOSUCCEED, domain->ops_win));
+
+  bfam_domain_pxest_ops_walk(domain, N_min, N_max, domain->ops_base, 0, 1);
+
+  int node_size;
+  BFAM_MPI_CHECK(MPI_Comm_size(domain->ops_comm, &node_size));
+  BFAM_ROOT_LDEBUG("Sharing %zu bytes of operator tables for orders %d to %d "
+                   "between %d ranks",
+                   size, N_min, N_max, node_size);
+}
+
 void bfam_domain_pxest_split_dgx_subdomains(
     bfam_domain_pxest_t *domain, bfam_locidx_t num_subdomains,
     bfam_locidx_t *subdomainID, bfam_locidx_t *roots, int *N,
@@ -7731,6 +9662,16 @@ void bfam_domain_pxest_split_dgx_subdomains(
     ++subk[idk];
   }
 
+  if (domain->elem_order == BFAM_PXEST_ELEM_ORDER_RCM)
+  {
+    for (bfam_locidx_t id = 0; id < num_subdomains; ++id)
+    {
+      bfam_domain_pxest_rcm_reorder(subK[id], EToQ[id], EToE[id], EToF[id]);
+      for (bfam_locidx_t k = 0; k < subK[id]; ++k)
+        ktosubk[EToQ[id][k]] = k;
+    }
+  }
+
   bfam_subdomain_dgx_t **subdomains =
       bfam_malloc(num_subdomains * sizeof(bfam_subdomain_dgx_t **));
   for (bfam_locidx_t id = 0; id < num_subdomains; ++id)
@@ -8053,25 +9994,3696 @@ void bfam_domain_pxest_split_dgx_subdomains(
   bfam_domain_pxest_dgx_print_stats(domain);
 }
 
-// }}}
+/*
+ * Checkpoint file layout (after the forest written by p4est_save_ext):
+ *
+ *   magic, header (see below), '\0' separated field names
+ *   table of global_num_quadrants entries (in global quadrant order)
+ *   element data: for each quadrant and each field the Np nodal values
+ *   trailer: offset of the bfam section followed by the magic
+ */
+#define BFAM_CHECKPOINT_MAGIC "bfamckpt"
+#define BFAM_CHECKPOINT_MAGIC_LEN 8
+#define BFAM_CHECKPOINT_VERSION 1
+#define BFAM_CHECKPOINT_NUM_HEAD 6
 
-// {{{ vtk
+typedef struct
+{
+  bfam_gloidx_t offset; /* offset of the element data in the data block */
+  int32_t N;            /* order of the element */
+  int32_t unused;
+} bfam_domain_pxest_checkpoint_entry_t;
 
-#include <sc.h>
-#include <sc_io.h>
+/* largest number of bytes moved by a single MPI-IO call */
+#define BFAM_CHECKPOINT_CHUNK (1 << 30)
 
-#define BFAM_VTK_VTU_FORMAT "%s_%05d.vtu"
-#define BFAM_VTK_VTS_FORMAT "%s_%s_%s.vts"
-#define BFAM_VTK_PVTS_FORMAT "%s_%s.pvts"
+/** Read or write \a count elements of \a type at \a offset
+ *
+ * The MPI-IO calls take an \c int count, so the data is moved in pieces of
+ * at most \c BFAM_CHECKPOINT_CHUNK bytes. For collective io \a comm is the
+ * communicator \a fh was opened on and all ranks make the same number of
+ * calls (ranks with less data make calls with a zero count); with \a comm
+ * equal to \c MPI_COMM_NULL the io is independent.
+ */
+static void bfam_domain_pxest_checkpoint_io(MPI_File fh, MPI_Comm comm,
+                                            const int write, MPI_Offset offset,
+                                            void *buf, bfam_gloidx_t count,
+                                            MPI_Datatype type)
+{
+  int type_size;
+  BFAM_MPI_CHECK(MPI_Type_size(type, &type_size));
+  const bfam_gloidx_t chunk = BFAM_CHECKPOINT_CHUNK / type_size;
+
+  bfam_gloidx_t num_chunks = (count + chunk - 1) / chunk;
+  if (comm != MPI_COMM_NULL)
+    BFAM_MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, &num_chunks, 1,
+                                 BFAM_GLOIDX_MPI, MPI_MAX, comm));
+
+  char *b = buf;
+  for (bfam_gloidx_t c = 0; c < num_chunks; ++c)
+  {
+    const int n = (int)BFAM_MAX(BFAM_MIN(count - c * chunk, chunk), 0);
+    if (comm == MPI_COMM_NULL && write)
+      BFAM_MPI_CHECK(
+          MPI_File_write_at(fh, offset, b, n, type, MPI_STATUS_IGNORE));
+    else if (comm == MPI_COMM_NULL)
+      BFAM_MPI_CHECK(
+          MPI_File_read_at(fh, offset, b, n, type, MPI_STATUS_IGNORE));
+    else if (write)
+      BFAM_MPI_CHECK(
+          MPI_File_write_at_all(fh, offset, b, n, type, MPI_STATUS_IGNORE));
+    else
+      BFAM_MPI_CHECK(
+          MPI_File_read_at_all(fh, offset, b, n, type, MPI_STATUS_IGNORE));
+    offset += (MPI_Offset)n * type_size;
+    b += (size_t)n * (size_t)type_size;
+  }
+}
 
-static void bfam_vtk_write_file_pvtu(int size, const char *directory,
-                                     const char *prefix, const char **scalars,
-                                     const char **vectors,
-                                     const char **components, int binary,
-                                     int compress)
+/** Read the part of the checkpoint table for the local quadrants
+ */
+static bfam_domain_pxest_checkpoint_entry_t *
+bfam_domain_pxest_checkpoint_read_table(MPI_File fh, MPI_Offset table_offset,
+                                        p4est_t *pxest)
 {
-  const int endian = bfam_endian();
-
+  int rank;
+  BFAM_MPI_CHECK(MPI_Comm_rank(pxest->mpicomm, &rank));
+
+  const p4est_locidx_t K = pxest->local_num_quadrants;
+  const size_t sz = sizeof(bfam_domain_pxest_checkpoint_entry_t);
+
+  bfam_domain_pxest_checkpoint_entry_t *table =
+      bfam_malloc_aligned(BFAM_MAX(K, 1) * sz);
+
+  const MPI_Offset offset =
+      table_offset + (MPI_Offset)(pxest->global_first_quadrant[rank] * sz);
+  bfam_domain_pxest_checkpoint_io(fh, pxest->mpicomm, 0, offset, table,
+                                  (bfam_gloidx_t)(K * sz), MPI_BYTE);
+
+  return table;
+}
+
+/** Partition weight used on restart: the number of nodes in the element
+ */
+static int bfam_domain_pxest_restart_weight(p4est_t *pxest,
+                                            p4est_topidx_t which_tree,
+                                            p4est_quadrant_t *quadrant)
+{
+  bfam_pxest_user_data_t *ud = quadrant->p.user_data;
+  return bfam_ipow(ud->N + 1, DIM);
+}
+
+void bfam_domain_pxest_checkpoint(bfam_domain_pxest_t *domain,
+                                  const char *filename, const char **fields)
+{
+  p4est_t *pxest = domain->pxest;
+  MPI_Comm comm = domain->base.comm;
+
+  BFAM_ROOT_LDEBUG("Begin checkpoint to '%s'.", filename);
+
+  int rank;
+  BFAM_MPI_CHECK(MPI_Comm_rank(comm, &rank));
+
+  /*
+   * Forest and quadrant user data (N, root_id, glue_id); the partition is not
+   * saved so the file can be read on any number of ranks.
+   */
+  p4est_save_ext(filename, pxest, 1, 0);
+
+  int num_fields = 0;
+  size_t names_len = 0;
+  for (; fields && fields[num_fields]; ++num_fields)
+    names_len += strlen(fields[num_fields]) + 1;
+
+  /*
+   * Build the local part of the table
+   */
+  const p4est_locidx_t K = pxest->local_num_quadrants;
+  bfam_domain_pxest_checkpoint_entry_t *table = bfam_malloc_aligned(
+      BFAM_MAX(K, 1) * sizeof(bfam_domain_pxest_checkpoint_entry_t));
+
+  bfam_gloidx_t local_num_reals = 0;
+  {
+    p4est_topidx_t t;
+    p4est_locidx_t k;
+    for (t = pxest->first_local_tree, k = 0; t <= pxest->last_local_tree; ++t)
+    {
+      p4est_tree_t *tree = p4est_tree_array_index(pxest->trees, t);
+      sc_array_t *quadrants = &tree->quadrants;
+      size_t num_quads = quadrants->elem_count;
+
+      for (size_t zz = 0; zz < num_quads; ++zz, ++k)
+      {
+        p4est_quadrant_t *quad = p4est_quadrant_array_index(quadrants, zz);
+        bfam_pxest_user_data_t *ud = quad->p.user_data;
+
+        bfam_subdomain_dgx_t *sub =
+            (bfam_subdomain_dgx_t *)bfam_domain_get_subdomain_by_num(
+                (bfam_domain_t *)domain, ud->subd_id);
+
+        table[k].offset =
+            local_num_reals * (bfam_gloidx_t)sizeof(bfam_real_t);
+        table[k].N = sub->N;
+        table[k].unused = 0;
+        local_num_reals += num_fields * sub->Np;
+      }
+    }
+  }
+
+  bfam_gloidx_t local_bytes =
+      local_num_reals * (bfam_gloidx_t)sizeof(bfam_real_t);
+  bfam_gloidx_t rank_offset = 0;
+  bfam_gloidx_t total_bytes = 0;
+  BFAM_MPI_CHECK(MPI_Exscan(&local_bytes, &rank_offset, 1, BFAM_GLOIDX_MPI,
+                            MPI_SUM, comm));
+  if (rank == 0)
+    rank_offset = 0;
+  BFAM_MPI_CHECK(MPI_Allreduce(&local_bytes, &total_bytes, 1, BFAM_GLOIDX_MPI,
+                               MPI_SUM, comm));
+
+  for (p4est_locidx_t k = 0; k < K; ++k)
+    table[k].offset += rank_offset;
+
+  /*
+   * Pack the element data in quadrant order
+   */
+  bfam_real_t *data =
+      bfam_malloc_aligned(BFAM_MAX(local_num_reals, 1) * sizeof(bfam_real_t));
+  {
+    bfam_gloidx_t n = 0;
+    for (p4est_topidx_t t = pxest->first_local_tree;
+         t <= pxest->last_local_tree; ++t)
+    {
+      p4est_tree_t *tree = p4est_tree_array_index(pxest->trees, t);
+      sc_array_t *quadrants = &tree->quadrants;
+      size_t num_quads = quadrants->elem_count;
+
+      for (size_t zz = 0; zz < num_quads; ++zz)
+      {
+        p4est_quadrant_t *quad = p4est_quadrant_array_index(quadrants, zz);
+        bfam_pxest_user_data_t *ud = quad->p.user_data;
+
+        bfam_subdomain_dgx_t *sub =
+            (bfam_subdomain_dgx_t *)bfam_domain_get_subdomain_by_num(
+                (bfam_domain_t *)domain, ud->subd_id);
+
+        for (int f = 0; f < num_fields; ++f)
+        {
+          bfam_real_t *field =
+              bfam_dictionary_get_value_ptr(&sub->base.fields, fields[f]);
+          BFAM_ABORT_IF(field == NULL, "field '%s' not found in subdomain %s",
+                        fields[f], sub->base.name);
+          memcpy(data + n, field + ud->elem_id * sub->Np,
+                 sub->Np * sizeof(bfam_real_t));
+          n += sub->Np;
+        }
+      }
+    }
+    BFAM_ASSERT(n == local_num_reals);
+  }
+
+  /*
+   * Append the bfam section to the forest file
+   */
+  MPI_File fh;
+  MPI_Offset base_offset = 0;
+  BFAM_MPI_CHECK(MPI_File_open(comm, (char *)filename, MPI_MODE_WRONLY,
+                               MPI_INFO_NULL, &fh));
+
+  /* only the root queries the size since it starts writing right after */
+  if (rank == 0)
+    BFAM_MPI_CHECK(MPI_File_get_size(fh, &base_offset));
+  BFAM_MPI_CHECK(MPI_Bcast(&base_offset, 1, MPI_OFFSET, 0, comm));
+
+  const size_t head_len = BFAM_CHECKPOINT_MAGIC_LEN +
+                          BFAM_CHECKPOINT_NUM_HEAD * sizeof(bfam_gloidx_t);
+  const MPI_Offset table_offset =
+      base_offset + (MPI_Offset)(head_len + names_len);
+  const MPI_Offset data_offset =
+      table_offset +
+      (MPI_Offset)(pxest->global_num_quadrants *
+                   sizeof(bfam_domain_pxest_checkpoint_entry_t));
+
+  if (rank == 0)
+  {
+    char *head = bfam_malloc(head_len + names_len);
+    bfam_gloidx_t vals[BFAM_CHECKPOINT_NUM_HEAD] = {
+        BFAM_CHECKPOINT_VERSION,     DIM,        sizeof(bfam_real_t),
+        pxest->global_num_quadrants, num_fields, (bfam_gloidx_t)names_len};
+
+    memcpy(head, BFAM_CHECKPOINT_MAGIC, BFAM_CHECKPOINT_MAGIC_LEN);
+    memcpy(head + BFAM_CHECKPOINT_MAGIC_LEN, vals, sizeof(vals));
+    char *name = head + head_len;
+    for (int f = 0; f < num_fields; ++f)
+    {
+      const size_t len = strlen(fields[f]) + 1;
+      memcpy(name, fields[f], len);
+      name += len;
+    }
+
+    bfam_domain_pxest_checkpoint_io(fh, MPI_COMM_NULL, 1, base_offset, head,
+                                    (bfam_gloidx_t)(head_len + names_len),
+                                    MPI_BYTE);
+    bfam_free(head);
+  }
+
+  const size_t entry_sz = sizeof(bfam_domain_pxest_checkpoint_entry_t);
+  bfam_domain_pxest_checkpoint_io(
+      fh, comm, 1,
+      table_offset + (MPI_Offset)(pxest->global_first_quadrant[rank] *
+                                  entry_sz),
+      table, (bfam_gloidx_t)(K * entry_sz), MPI_BYTE);
+
+  bfam_domain_pxest_checkpoint_io(fh, comm, 1,
+                                  data_offset + (MPI_Offset)rank_offset, data,
+                                  local_num_reals, BFAM_REAL_MPI);
+
+  if (rank == 0)
+  {
+    char trailer[sizeof(bfam_gloidx_t) + BFAM_CHECKPOINT_MAGIC_LEN];
+    bfam_gloidx_t base = (bfam_gloidx_t)base_offset;
+    memcpy(trailer, &base, sizeof(bfam_gloidx_t));
+    memcpy(trailer + sizeof(bfam_gloidx_t), BFAM_CHECKPOINT_MAGIC,
+           BFAM_CHECKPOINT_MAGIC_LEN);
+    BFAM_MPI_CHECK(MPI_File_write_at(fh, data_offset + (MPI_Offset)total_bytes,
+                                     trailer, (int)sizeof(trailer), MPI_BYTE,
+                                     MPI_STATUS_IGNORE));
+  }
+
+  BFAM_MPI_CHECK(MPI_File_close(&fh));
+
+  bfam_free_aligned(data);
+  bfam_free_aligned(table);
+
+  BFAM_ROOT_LDEBUG("End checkpoint to '%s'.", filename);
+}
+
+bfam_domain_pxest_t *
+bfam_domain_pxest_restart(MPI_Comm domComm, const char *filename,
+                          p4est_connectivity_t **conn,
+                          bfam_glue_order_t glue_order, void *go_user_args)
+{
+  BFAM_ROOT_LDEBUG("Begin restart from '%s'.", filename);
+
+  /*
+   * Load the forest with a uniform partition, this is what allows a restart
+   * on a different number of ranks
+   */
+  p4est_t *pxest = p4est_load_ext(filename, domComm,
+                                  sizeof(bfam_pxest_user_data_t), 1, 1, 0,
+                                  NULL, conn);
+
+  bfam_domain_pxest_t *domain = bfam_malloc(sizeof(bfam_domain_pxest_t));
+  bfam_domain_pxest_init_forest(domain, domComm, *conn, pxest);
+
+  /*
+   * Read the bfam section header
+   */
+  MPI_File fh;
+  MPI_Offset file_size;
+  BFAM_MPI_CHECK(MPI_File_open(domComm, (char *)filename, MPI_MODE_RDONLY,
+                               MPI_INFO_NULL, &fh));
+  BFAM_MPI_CHECK(MPI_File_get_size(fh, &file_size));
+
+  char trailer[sizeof(bfam_gloidx_t) + BFAM_CHECKPOINT_MAGIC_LEN];
+  BFAM_MPI_CHECK(MPI_File_read_at_all(
+      fh, file_size - (MPI_Offset)sizeof(trailer), trailer,
+      (int)sizeof(trailer), MPI_BYTE, MPI_STATUS_IGNORE));
+  BFAM_ABORT_IF(memcmp(trailer + sizeof(bfam_gloidx_t), BFAM_CHECKPOINT_MAGIC,
+                       BFAM_CHECKPOINT_MAGIC_LEN),
+                "'%s' is not a bfam checkpoint", filename);
+
+  bfam_gloidx_t base;
+  memcpy(&base, trailer, sizeof(bfam_gloidx_t));
+
+  const size_t head_len = BFAM_CHECKPOINT_MAGIC_LEN +
+                          BFAM_CHECKPOINT_NUM_HEAD * sizeof(bfam_gloidx_t);
+  char head[BFAM_CHECKPOINT_MAGIC_LEN +
+            BFAM_CHECKPOINT_NUM_HEAD * sizeof(bfam_gloidx_t)];
+  BFAM_MPI_CHECK(MPI_File_read_at_all(fh, (MPI_Offset)base, head,
+                                      (int)head_len, MPI_BYTE,
+                                      MPI_STATUS_IGNORE));
+  BFAM_ABORT_IF(memcmp(head, BFAM_CHECKPOINT_MAGIC, BFAM_CHECKPOINT_MAGIC_LEN),
+                "'%s' has a corrupt checkpoint header", filename);
+
+  bfam_gloidx_t vals[BFAM_CHECKPOINT_NUM_HEAD];
+  memcpy(vals, head + BFAM_CHECKPOINT_MAGIC_LEN, sizeof(vals));
+  BFAM_ABORT_IF(vals[0] != BFAM_CHECKPOINT_VERSION,
+                "checkpoint version %jd not supported", (intmax_t)vals[0]);
+  BFAM_ABORT_IF(vals[1] != DIM, "checkpoint dimension %jd not %d",
+                (intmax_t)vals[1], DIM);
+  BFAM_ABORT_IF(vals[2] != sizeof(bfam_real_t),
+                "checkpoint real size %jd not %zd", (intmax_t)vals[2],
+                sizeof(bfam_real_t));
+  BFAM_ABORT_IF(vals[3] != pxest->global_num_quadrants,
+                "checkpoint has %jd quadrants, forest has %jd",
+                (intmax_t)vals[3], (intmax_t)pxest->global_num_quadrants);
+
+  const int num_fields = (int)vals[4];
+  const size_t names_len = (size_t)vals[5];
+
+  char *names = bfam_malloc(BFAM_MAX(names_len, 1));
+  bfam_domain_pxest_checkpoint_io(fh, domComm, 0,
+                                  (MPI_Offset)(base + head_len), names,
+                                  (bfam_gloidx_t)names_len, MPI_BYTE);
+
+  const char **fields = bfam_malloc((num_fields + 1) * sizeof(char *));
+  {
+    char *name = names;
+    for (int f = 0; f < num_fields; ++f)
+    {
+      fields[f] = name;
+      name += strlen(name) + 1;
+    }
+    fields[num_fields] = NULL;
+  }
+
+  const MPI_Offset table_offset =
+      (MPI_Offset)(base + head_len + names_len);
+  const MPI_Offset data_offset =
+      table_offset +
+      (MPI_Offset)(pxest->global_num_quadrants *
+                   sizeof(bfam_domain_pxest_checkpoint_entry_t));
+
+  /*
+   * Set the element orders and repartition based on the element size
+   */
+  bfam_domain_pxest_checkpoint_entry_t *table =
+      bfam_domain_pxest_checkpoint_read_table(fh, table_offset, pxest);
+  {
+    p4est_topidx_t t;
+    p4est_locidx_t k;
+    for (t = pxest->first_local_tree, k = 0; t <= pxest->last_local_tree; ++t)
+    {
+      p4est_tree_t *tree = p4est_tree_array_index(pxest->trees, t);
+      sc_array_t *quadrants = &tree->quadrants;
+      size_t num_quads = quadrants->elem_count;
+
+      for (size_t zz = 0; zz < num_quads; ++zz, ++k)
+      {
+        p4est_quadrant_t *quad = p4est_quadrant_array_index(quadrants, zz);
+        bfam_pxest_user_data_t *ud = quad->p.user_data;
+
+        ud->flags = 0;
+        ud->N = (int8_t)table[k].N;
+        ud->Nold = (int8_t)table[k].N;
+        ud->subd_id = -1;
+        ud->elem_id = -1;
+      }
+    }
+  }
+  bfam_free_aligned(table);
+
+  p4est_partition(pxest, 0, bfam_domain_pxest_restart_weight);
+
+  table = bfam_domain_pxest_checkpoint_read_table(fh, table_offset, pxest);
+
+  /*
+   * Rebuild the subdomains
+   */
+  bfam_locidx_t num_subdomains;
+  bfam_locidx_t *subdomain_id;
+  bfam_locidx_t *roots;
+  bfam_locidx_t *glue_id;
+  int *N;
+
+  bfam_domain_pxest_compute_split(pxest, 0, &num_subdomains, &subdomain_id,
+                                  &roots, &N, &glue_id);
+  bfam_domain_pxest_split_dgx_subdomains(domain, num_subdomains, subdomain_id,
+                                         roots, N, glue_id, glue_order,
+                                         go_user_args);
+
+  bfam_free_aligned(subdomain_id);
+  bfam_free_aligned(roots);
+  bfam_free_aligned(N);
+  bfam_free_aligned(glue_id);
+
+  /*
+   * Read the fields
+   */
+  const char *volume[] = {"_volume", NULL};
+  bfam_domain_add_fields((bfam_domain_t *)domain, BFAM_DOMAIN_OR, volume,
+                         fields);
+
+  const p4est_locidx_t K = pxest->local_num_quadrants;
+  bfam_gloidx_t local_num_reals = 0;
+  bfam_gloidx_t rank_offset = 0;
+  if (K > 0)
+  {
+    rank_offset = table[0].offset;
+    local_num_reals =
+        (table[K - 1].offset - rank_offset) /
+            (bfam_gloidx_t)sizeof(bfam_real_t) +
+        num_fields * bfam_ipow(table[K - 1].N + 1, DIM);
+  }
+
+  bfam_real_t *data =
+      bfam_malloc_aligned(BFAM_MAX(local_num_reals, 1) * sizeof(bfam_real_t));
+  bfam_domain_pxest_checkpoint_io(fh, domComm, 0,
+                                  data_offset + (MPI_Offset)rank_offset, data,
+                                  local_num_reals, BFAM_REAL_MPI);
+
+  {
+    bfam_gloidx_t n = 0;
+    for (p4est_topidx_t t = pxest->first_local_tree;
+         t <= pxest->last_local_tree; ++t)
+    {
+      p4est_tree_t *tree = p4est_tree_array_index(pxest->trees, t);
+      sc_array_t *quadrants = &tree->quadrants;
+      size_t num_quads = quadrants->elem_count;
+
+      for (size_t zz = 0; zz < num_quads; ++zz)
+      {
+        p4est_quadrant_t *quad = p4est_quadrant_array_index(quadrants, zz);
+        bfam_pxest_user_data_t *ud = quad->p.user_data;
+
+        bfam_subdomain_dgx_t *sub =
+            (bfam_subdomain_dgx_t *)bfam_domain_get_subdomain_by_num(
+                (bfam_domain_t *)domain, ud->subd_id);
+
+        for (int f = 0; f < num_fields; ++f)
+        {
+          bfam_real_t *field =
+              bfam_dictionary_get_value_ptr(&sub->base.fields, fields[f]);
+          BFAM_ASSERT(field != NULL);
+          memcpy(field + ud->elem_id * sub->Np, data + n,
+                 sub->Np * sizeof(bfam_real_t));
+          n += sub->Np;
+        }
+      }
+    }
+    BFAM_ASSERT(n == local_num_reals);
+  }
+
+  BFAM_MPI_CHECK(MPI_File_close(&fh));
+
+  bfam_free_aligned(data);
+  bfam_free_aligned(table);
+  bfam_free(fields);
+  bfam_free(names);
+
+  BFAM_ROOT_LDEBUG("End restart from '%s'.", filename);
+
+  return domain;
+}
+
+/* weights are scaled so the cheapest timed class is this many units */
+#define BFAM_COST_MIN_WEIGHT 16
+#define BFAM_COST_MAX_WEIGHT (1 << 24)
+
+/* element classes of the cost model */
+#define BFAM_COST_VOLUME 0
+#define BFAM_COST_GLUE 1
+
+typedef struct
+{
+  bfam_gloidx_t id[3]; /* class: kind, uid and order (zero for glue) */
+  double time;         /* time accumulated in the current window */
+  bfam_gloidx_t count; /* elements (or faces) accumulated in the window */
+  bfam_gloidx_t nodes; /* nodes accumulated in the window */
+  double cost;         /* calibrated cost per element (or face) */
+} bfam_domain_pxest_cost_entry_t;
+
+void bfam_domain_pxest_cost_init(bfam_domain_pxest_cost_t *cost, MPI_Comm comm,
+                                 int window, double tol)
+{
+  BFAM_ABORT_IF(window < 1, "Cost window must be positive: %d", window);
+  bfam_dictionary_init(&cost->model);
+  cost->comm = comm;
+  cost->window = window;
+  cost->step = 0;
+  cost->tol = tol;
+  cost->imbalance = 1;
+  cost->resolution = 0;
+  cost->node_cost = 0;
+  cost->time = 0;
+  cost->domain = NULL;
+  cost->fields = NULL;
+  cost->allow_for_coarsening = 0;
+  cost->glue_order = NULL;
+  cost->go_user_args = NULL;
+}
+
+void bfam_domain_pxest_cost_set_auto(bfam_domain_pxest_cost_t *cost,
+                                     bfam_domain_pxest_t *domain,
+                                     const char **fields,
+                                     int allow_for_coarsening,
+                                     bfam_glue_order_t glue_order,
+                                     void *go_user_args)
+{
+  cost->domain = domain;
+  cost->fields = fields;
+  cost->allow_for_coarsening = allow_for_coarsening;
+  cost->glue_order = glue_order;
+  cost->go_user_args = go_user_args;
+}
+
+static int bfam_domain_pxest_cost_free_entry(const char *key, void *val,
+                                             void *arg)
+{
+  bfam_free(val);
+  return 1;
+}
+
+void bfam_domain_pxest_cost_free(bfam_domain_pxest_cost_t *cost)
+{
+  bfam_dictionary_allprefixed_ptr(&cost->model, "",
+                                  bfam_domain_pxest_cost_free_entry, NULL);
+  bfam_dictionary_clear(&cost->model);
+}
+
+static bfam_domain_pxest_cost_entry_t *
+bfam_domain_pxest_cost_get_entry(bfam_domain_pxest_cost_t *cost,
+                                 const bfam_gloidx_t id[3], int create)
+{
+  char key[BFAM_BUFSIZ];
+  snprintf(key, BFAM_BUFSIZ, "%jd_%jd_%jd", (intmax_t)id[0], (intmax_t)id[1],
+           (intmax_t)id[2]);
+
+  bfam_domain_pxest_cost_entry_t *entry =
+      bfam_dictionary_get_value_ptr(&cost->model, key);
+
+  if (entry == NULL && create)
+  {
+    entry = bfam_calloc(1, sizeof(bfam_domain_pxest_cost_entry_t));
+    for (int i = 0; i < 3; ++i)
+      entry->id[i] = id[i];
+    int retval = bfam_dictionary_insert_ptr(&cost->model, key, entry);
+    BFAM_ABORT_IF(retval != 2, "Can't insert '%s' into cost model", key);
+  }
+
+  return entry;
+}
+
+void bfam_domain_pxest_cost_add_time(bfam_domain_pxest_cost_t *cost,
+                                     bfam_subdomain_dgx_t *sub, double seconds)
+{
+  bfam_gloidx_t id[3];
+
+  cost->time += seconds;
+
+  if (bfam_subdomain_has_tag((bfam_subdomain_t *)sub, "_volume"))
+  {
+    /* volume subdomains split without roots have uid -1 but quadrants
+     * carry the default root */
+    id[0] = BFAM_COST_VOLUME;
+    id[1] = (sub->base.uid < 0) ? BFAM_DEFAULT_SUBDOMAIN_ROOT : sub->base.uid;
+    id[2] = sub->N;
+  }
+  else if (bfam_subdomain_has_tag((bfam_subdomain_t *)sub, "_glue") &&
+           sub->base.uid >= 0)
+  {
+    id[0] = BFAM_COST_GLUE;
+    id[1] = sub->base.uid;
+    id[2] = 0;
+  }
+  else
+    return;
+
+  bfam_domain_pxest_cost_entry_t *entry =
+      bfam_domain_pxest_cost_get_entry(cost, id, 1);
+  entry->time += seconds;
+  entry->count += sub->K;
+  entry->nodes += (bfam_gloidx_t)sub->K * sub->Np;
+}
+
+static int bfam_domain_pxest_cost_get_id(const char *key, void *val, void *arg)
+{
+  bfam_domain_pxest_cost_entry_t *entry = val;
+  bfam_gloidx_t **id = arg;
+
+  for (int i = 0; i < 3; ++i)
+    (*id)[i] = entry->id[i];
+  *id += 3;
+
+  return 1;
+}
+
+static int bfam_domain_pxest_cost_id_cmp(const void *a, const void *b)
+{
+  const bfam_gloidx_t *id_a = a;
+  const bfam_gloidx_t *id_b = b;
+
+  for (int i = 0; i < 3; ++i)
+    if (id_a[i] != id_b[i])
+      return (id_a[i] < id_b[i]) ? -1 : 1;
+
+  return 0;
+}
+
+/* Gather the element classes of all ranks into a sorted list without
+ * duplicates, which is the same on every rank, and add the classes this
+ * rank has not timed to its model; returns the number of classes */
+static size_t bfam_domain_pxest_cost_all_ids(bfam_domain_pxest_cost_t *cost,
+                                             bfam_gloidx_t **all_ids)
+{
+  int size;
+  BFAM_MPI_CHECK(MPI_Comm_size(cost->comm, &size));
+
+  const int loc_num = (int)(3 * cost->model.num_entries);
+  bfam_gloidx_t *loc_ids =
+      bfam_malloc_aligned(BFAM_MAX(loc_num, 1) * sizeof(bfam_gloidx_t));
+  bfam_gloidx_t *id = loc_ids;
+  bfam_dictionary_allprefixed_ptr(&cost->model, "",
+                                  bfam_domain_pxest_cost_get_id, &id);
+  BFAM_ASSERT(id == loc_ids + loc_num);
+
+  int *counts = bfam_malloc_aligned(2 * size * sizeof(int));
+  int *displs = counts + size;
+  BFAM_MPI_CHECK(
+      MPI_Allgather(&loc_num, 1, MPI_INT, counts, 1, MPI_INT, cost->comm));
+
+  int num = 0;
+  for (int r = 0; r < size; ++r)
+  {
+    displs[r] = num;
+    num += counts[r];
+  }
+
+  bfam_gloidx_t *ids =
+      bfam_malloc_aligned(BFAM_MAX(num, 1) * sizeof(bfam_gloidx_t));
+  BFAM_MPI_CHECK(MPI_Allgatherv(loc_ids, loc_num, BFAM_GLOIDX_MPI, ids, counts,
+                                displs, BFAM_GLOIDX_MPI, cost->comm));
+
+  bfam_free_aligned(counts);
+  bfam_free_aligned(loc_ids);
+
+  qsort(ids, (size_t)num / 3, 3 * sizeof(bfam_gloidx_t),
+        bfam_domain_pxest_cost_id_cmp);
+
+  size_t num_ids = 0;
+  for (size_t i = 0; i < (size_t)num / 3; ++i)
+  {
+    if (num_ids > 0 &&
+        !bfam_domain_pxest_cost_id_cmp(ids + 3 * (num_ids - 1), ids + 3 * i))
+      continue;
+    for (int j = 0; j < 3; ++j)
+      ids[3 * num_ids + j] = ids[3 * i + j];
+    bfam_domain_pxest_cost_get_entry(cost, ids + 3 * num_ids, 1);
+    ++num_ids;
+  }
+
+  *all_ids = ids;
+  return num_ids;
+}
+
+int bfam_domain_pxest_cost_end_step(bfam_domain_pxest_cost_t *cost)
+{
+  ++cost->step;
+  if (cost->step < cost->window)
+    return 0;
+
+  bfam_gloidx_t *ids;
+  const size_t num_ids = bfam_domain_pxest_cost_all_ids(cost, &ids);
+
+  /* the rank time followed by the time, count and nodes of each class (in the
+   * order of ids) are summed over the ranks so that the costs, and thus the
+   * partition weights, are the same on every rank */
+  const size_t num_sum = 1 + 3 * num_ids;
+  double *loc_sum = bfam_malloc_aligned(2 * num_sum * sizeof(double));
+  double *glo_sum = loc_sum + num_sum;
+
+  loc_sum[0] = cost->time;
+  for (size_t i = 0; i < num_ids; ++i)
+  {
+    bfam_domain_pxest_cost_entry_t *entry =
+        bfam_domain_pxest_cost_get_entry(cost, ids + 3 * i, 0);
+    BFAM_ASSERT(entry);
+    loc_sum[1 + 3 * i + 0] = entry->time;
+    loc_sum[1 + 3 * i + 1] = (double)entry->count;
+    loc_sum[1 + 3 * i + 2] = (double)entry->nodes;
+    entry->time = 0;
+    entry->count = 0;
+    entry->nodes = 0;
+  }
+
+  BFAM_MPI_CHECK(MPI_Allreduce(loc_sum, glo_sum, (int)num_sum, MPI_DOUBLE,
+                               MPI_SUM, cost->comm));
+
+  double max_time;
+  BFAM_MPI_CHECK(MPI_Allreduce(&cost->time, &max_time, 1, MPI_DOUBLE, MPI_MAX,
+                               cost->comm));
+
+  double min_cost = HUGE_VAL;
+  double vol_time = 0;
+  double vol_nodes = 0;
+  for (size_t i = 0; i < num_ids; ++i)
+  {
+    const double time = glo_sum[1 + 3 * i + 0];
+    const double count = glo_sum[1 + 3 * i + 1];
+    const double nodes = glo_sum[1 + 3 * i + 2];
+    if (count <= 0 || time <= 0)
+      continue;
+
+    /* classes that were not run in this window keep their previous cost */
+    bfam_domain_pxest_cost_entry_t *entry =
+        bfam_domain_pxest_cost_get_entry(cost, ids + 3 * i, 0);
+    entry->cost = time / count;
+    min_cost = BFAM_MIN(min_cost, entry->cost);
+    if (ids[3 * i] == BFAM_COST_VOLUME)
+    {
+      vol_time += time;
+      vol_nodes += nodes;
+    }
+  }
+
+  int size;
+  BFAM_MPI_CHECK(MPI_Comm_size(cost->comm, &size));
+
+  if (min_cost < HUGE_VAL)
+    cost->resolution = min_cost / BFAM_COST_MIN_WEIGHT;
+  if (vol_nodes > 0)
+    cost->node_cost = vol_time / vol_nodes;
+
+  const double avg = glo_sum[0] / size;
+  cost->imbalance = (avg > 0) ? max_time / avg : 1;
+
+  bfam_free_aligned(loc_sum);
+  bfam_free_aligned(ids);
+
+  BFAM_ROOT_LDEBUG("Cost model: imbalance %f (tol %f) over %d steps",
+                   cost->imbalance, cost->tol, cost->step);
+
+  cost->step = 0;
+  cost->time = 0;
+
+  const int repartition = cost->resolution > 0 && cost->imbalance > cost->tol;
+  if (repartition && cost->domain)
+    bfam_domain_pxest_cost_repartition(cost->domain, cost, cost->fields,
+                                       cost->allow_for_coarsening,
+                                       cost->glue_order, cost->go_user_args);
+
+  return repartition;
+}
+
+static int bfam_domain_pxest_cost_weight(p4est_t *pxest,
+                                         p4est_topidx_t which_tree,
+                                         p4est_quadrant_t *quadrant)
+{
+  bfam_domain_pxest_cost_t *cost = pxest->user_pointer;
+  bfam_pxest_user_data_t *ud = quadrant->p.user_data;
+  const int Np = bfam_ipow(ud->N + 1, DIM);
+
+  if (cost->resolution <= 0)
+    return Np;
+
+  bfam_gloidx_t id[3] = {BFAM_COST_VOLUME, ud->root_id, ud->N};
+  bfam_domain_pxest_cost_entry_t *entry =
+      bfam_domain_pxest_cost_get_entry(cost, id, 0);
+  double c = (entry && entry->cost > 0) ? entry->cost : Np * cost->node_cost;
+
+  for (int f = 0; f < P4EST_FACES; ++f)
+  {
+    if (ud->glue_id[f] < 0)
+      continue;
+    id[0] = BFAM_COST_GLUE;
+    id[1] = ud->glue_id[f];
+    id[2] = 0;
+    entry = bfam_domain_pxest_cost_get_entry(cost, id, 0);
+    if (entry)
+      c += entry->cost;
+  }
+
+  const double w = c / cost->resolution;
+  return (int)BFAM_MAX(1, BFAM_MIN(w + 0.5, BFAM_COST_MAX_WEIGHT));
+}
+
+void bfam_domain_pxest_cost_partition(p4est_t *pxest,
+                                      bfam_domain_pxest_cost_t *cost,
+                                      int allow_for_coarsening)
+{
+  void *user_pointer = pxest->user_pointer;
+  pxest->user_pointer = cost;
+  p4est_partition(pxest, allow_for_coarsening, bfam_domain_pxest_cost_weight);
+  pxest->user_pointer = user_pointer;
+}
+
+/* Copy the fields of the local quadrants to (unpack == 0) or from (unpack !=
+ * 0) a buffer with the data of each quadrant, field by field, in quadrant
+ * order; returns the number of reals */
+static bfam_gloidx_t bfam_domain_pxest_pack_fields(bfam_domain_pxest_t *domain,
+                                                   const char **fields,
+                                                   bfam_real_t *buf,
+                                                   const int unpack)
+{
+  p4est_t *pxest = domain->pxest;
+  bfam_gloidx_t n = 0;
+  for (p4est_topidx_t t = pxest->first_local_tree; t <= pxest->last_local_tree;
+       ++t)
+  {
+    p4est_tree_t *tree = p4est_tree_array_index(pxest->trees, t);
+    sc_array_t *quadrants = &tree->quadrants;
+    size_t num_quads = quadrants->elem_count;
+
+    for (size_t zz = 0; zz < num_quads; ++zz)
+    {
+      p4est_quadrant_t *quad = p4est_quadrant_array_index(quadrants, zz);
+      bfam_pxest_user_data_t *ud = quad->p.user_data;
+
+      bfam_subdomain_dgx_t *sub =
+          (bfam_subdomain_dgx_t *)bfam_domain_get_subdomain_by_num(
+              (bfam_domain_t *)domain, ud->subd_id);
+
+      for (int f = 0; fields[f]; ++f)
+      {
+        bfam_real_t *field =
+            bfam_dictionary_get_value_ptr(&sub->base.fields, fields[f]);
+        BFAM_ABORT_IF(field == NULL, "field '%s' not found in subdomain %s",
+                      fields[f], sub->base.name);
+        if (unpack)
+          memcpy(field + ud->elem_id * sub->Np, buf + n,
+                 sub->Np * sizeof(bfam_real_t));
+        else
+          memcpy(buf + n, field + ud->elem_id * sub->Np,
+                 sub->Np * sizeof(bfam_real_t));
+        n += sub->Np;
+      }
+    }
+  }
+  return n;
+}
+
+/* offsets (in reals) of the data of the local quadrants in the buffer of
+ * bfam_domain_pxest_pack_fields; K + 1 entries */
+static bfam_gloidx_t *bfam_domain_pxest_field_offsets(p4est_t *pxest,
+                                                      const int num_fields)
+{
+  bfam_gloidx_t *offset = bfam_malloc_aligned(
+      (pxest->local_num_quadrants + 1) * sizeof(bfam_gloidx_t));
+
+  p4est_topidx_t t;
+  p4est_locidx_t k;
+  offset[0] = 0;
+  for (t = pxest->first_local_tree, k = 0; t <= pxest->last_local_tree; ++t)
+  {
+    p4est_tree_t *tree = p4est_tree_array_index(pxest->trees, t);
+    sc_array_t *quadrants = &tree->quadrants;
+    size_t num_quads = quadrants->elem_count;
+
+    for (size_t zz = 0; zz < num_quads; ++zz, ++k)
+    {
+      p4est_quadrant_t *quad = p4est_quadrant_array_index(quadrants, zz);
+      bfam_pxest_user_data_t *ud = quad->p.user_data;
+      offset[k + 1] = offset[k] + num_fields * bfam_ipow(ud->N + 1, DIM);
+    }
+  }
+  return offset;
+}
+
+void bfam_domain_pxest_cost_repartition(bfam_domain_pxest_t *domain,
+                                        bfam_domain_pxest_cost_t *cost,
+                                        const char **fields,
+                                        int allow_for_coarsening,
+                                        bfam_glue_order_t glue_order,
+                                        void *go_user_args)
+{
+  p4est_t *pxest = domain->pxest;
+  MPI_Comm comm = domain->base.comm;
+
+  int rank, size;
+  BFAM_MPI_CHECK(MPI_Comm_rank(comm, &rank));
+  BFAM_MPI_CHECK(MPI_Comm_size(comm, &size));
+
+  const char *no_fields[] = {NULL};
+  if (fields == NULL)
+    fields = no_fields;
+  int num_fields = 0;
+  while (fields[num_fields])
+    ++num_fields;
+
+  /*
+   * Pack the fields in quadrant order, which the partition keeps
+   */
+  bfam_gloidx_t *send_offset =
+      bfam_domain_pxest_field_offsets(pxest, num_fields);
+  bfam_real_t *send_buf = bfam_malloc_aligned(
+      BFAM_MAX(send_offset[pxest->local_num_quadrants], 1) *
+      sizeof(bfam_real_t));
+  bfam_domain_pxest_pack_fields(domain, fields, send_buf, 0);
+
+  p4est_gloidx_t *old_first =
+      bfam_malloc_aligned((size + 1) * sizeof(p4est_gloidx_t));
+  memcpy(old_first, pxest->global_first_quadrant,
+         (size + 1) * sizeof(p4est_gloidx_t));
+
+  bfam_domain_pxest_cost_partition(pxest, cost, allow_for_coarsening);
+
+  /*
+   * Move the data of each quadrant to its new owner; the quadrant user data
+   * (and thus the order of the element) was moved by the partition
+   */
+  const p4est_gloidx_t *new_first = pxest->global_first_quadrant;
+  bfam_gloidx_t *recv_offset =
+      bfam_domain_pxest_field_offsets(pxest, num_fields);
+  bfam_real_t *recv_buf = bfam_malloc_aligned(
+      BFAM_MAX(recv_offset[pxest->local_num_quadrants], 1) *
+      sizeof(bfam_real_t));
+
+  const int tag = 667;
+  MPI_Request *request = bfam_malloc(2 * size * sizeof(MPI_Request));
+  int num_request = 0;
+  for (int p = 0; p < size; ++p)
+  {
+    /* quadrants this rank had that p now has, and the other way around */
+    const p4est_gloidx_t s_beg = BFAM_MAX(old_first[rank], new_first[p]);
+    const p4est_gloidx_t s_end =
+        BFAM_MIN(old_first[rank + 1], new_first[p + 1]);
+    const p4est_gloidx_t r_beg = BFAM_MAX(new_first[rank], old_first[p]);
+    const p4est_gloidx_t r_end =
+        BFAM_MIN(new_first[rank + 1], old_first[p + 1]);
+
+    if (p == rank)
+    {
+      if (s_beg < s_end)
+      {
+        const bfam_gloidx_t s0 = send_offset[s_beg - old_first[rank]];
+        const bfam_gloidx_t s1 = send_offset[s_end - old_first[rank]];
+        memcpy(recv_buf + recv_offset[r_beg - new_first[rank]],
+               send_buf + s0, (size_t)(s1 - s0) * sizeof(bfam_real_t));
+      }
+      continue;
+    }
+
+    if (r_beg < r_end)
+    {
+      const bfam_gloidx_t r0 = recv_offset[r_beg - new_first[rank]];
+      const bfam_gloidx_t r1 = recv_offset[r_end - new_first[rank]];
+      BFAM_ABORT_IF(r1 - r0 > INT_MAX, "Too much data to receive from %d", p);
+      BFAM_MPI_CHECK(MPI_Irecv(recv_buf + r0, (int)(r1 - r0), BFAM_REAL_MPI,
+                               p, tag, comm, &request[num_request++]));
+    }
+    if (s_beg < s_end)
+    {
+      const bfam_gloidx_t s0 = send_offset[s_beg - old_first[rank]];
+      const bfam_gloidx_t s1 = send_offset[s_end - old_first[rank]];
+      BFAM_ABORT_IF(s1 - s0 > INT_MAX, "Too much data to send to %d", p);
+      BFAM_MPI_CHECK(MPI_Isend(send_buf + s0, (int)(s1 - s0), BFAM_REAL_MPI,
+                               p, tag, comm, &request[num_request++]));
+    }
+  }
+  BFAM_MPI_CHECK(MPI_Waitall(num_request, request, MPI_STATUSES_IGNORE));
+
+  bfam_free(request);
+  bfam_free_aligned(old_first);
+  bfam_free_aligned(send_buf);
+  bfam_free_aligned(send_offset);
+  bfam_free_aligned(recv_offset);
+
+  /*
+   * Rebuild the subdomains
+   */
+  bfam_domain_clear_subdomains(&domain->base);
+
+  bfam_locidx_t num_subdomains;
+  bfam_locidx_t *subdomain_id;
+  bfam_locidx_t *roots;
+  bfam_locidx_t *glue_id;
+  int *N;
+
+  bfam_domain_pxest_compute_split(pxest, 0, &num_subdomains, &subdomain_id,
+                                  &roots, &N, &glue_id);
+  bfam_domain_pxest_split_dgx_subdomains(domain, num_subdomains, subdomain_id,
+                                         roots, N, glue_id, glue_order,
+                                         go_user_args);
+
+  bfam_free_aligned(subdomain_id);
+  bfam_free_aligned(roots);
+  bfam_free_aligned(N);
+  bfam_free_aligned(glue_id);
+
+  const char *volume[] = {"_volume", NULL};
+  bfam_domain_add_fields((bfam_domain_t *)domain, BFAM_DOMAIN_OR, volume,
+                         fields);
+  bfam_domain_pxest_pack_fields(domain, fields, recv_buf, 1);
+
+  bfam_free_aligned(recv_buf);
+}
+
+/** Return the 1D operator in direction \a d which transfers data from a
+ *  source element of order \a N_src to a destination element of order
+ *  \a N_dst that has been refined or coarsened \a lvl_diff levels.
+ *
+ * Multiple levels are handled by composing the single level operators; the
+ * order change is done on the finest level for coarsening and the coarsest
+ * level for refinement. If a composition is needed it is stored in \a A
+ * (which must hold <tt>(N_dst+1)*(N_src+1)</tt> reals), otherwise a cached
+ * operator (or \c NULL for the identity) is returned.
+ */
+static const bfam_real_t *bfam_subdomain_dgx_transfer_operator(
+    bfam_dictionary_t *N2N, const int N_src, const int N_dst,
+    const uint8_t flag, const int lvl_diff, const uint64_t path, const int d,
+    const int wi_mass, bfam_real_t *A)
+{
+  bfam_subdomain_dgx_interpolator_t *interp_sd =
+      bfam_subdomain_dgx_get_interpolator(N2N, N_src, N_dst, 0);
+  BFAM_ASSERT(interp_sd);
+
+  if (flag != BFAM_FLAG_REFINE && flag != BFAM_FLAG_COARSEN)
+    return interp_sd->prj[0];
+
+  BFAM_ASSERT(lvl_diff > 0);
+
+  const int L = lvl_diff;
+  const int coarsen = (flag == BFAM_FLAG_COARSEN);
+  bfam_real_t **prj_sd = (coarsen && wi_mass) ? interp_sd->wi_mass_prj
+                                               : interp_sd->prj;
+
+  /* bit d of the child id i levels below the coarse quadrant */
+#define BFAM_PATH_BIT(i) ((int)((path >> (P4EST_DIM * (L - (i)) + d)) & 1))
+
+  /* refinement starts at the top of the path and coarsening at the bottom */
+  const int first = coarsen ? L : 1;
+  const bfam_real_t *S = prj_sd[(coarsen ? 1 : 3) + BFAM_PATH_BIT(first)];
+  if (L == 1)
+    return S;
+
+  const int Nq_s = N_src + 1;
+  const int Nq_d = N_dst + 1;
+
+  bfam_subdomain_dgx_interpolator_t *interp_dd =
+      bfam_subdomain_dgx_get_interpolator(N2N, N_dst, N_dst, 0);
+  BFAM_ASSERT(interp_dd);
+  bfam_real_t **prj_dd = (coarsen && wi_mass) ? interp_dd->wi_mass_prj
+                                               : interp_dd->prj;
+
+  bfam_arena_t *scratch = bfam_scratch_arena();
+  const size_t mark = bfam_arena_mark(scratch);
+  bfam_real_t *tmp =
+      bfam_arena_alloc(scratch, Nq_d * Nq_s * sizeof(bfam_real_t));
+  memcpy(A, S, Nq_d * Nq_s * sizeof(bfam_real_t));
+
+  for (int l = 1; l < L; ++l)
+  {
+    const int i = coarsen ? L - l : l + 1;
+    const bfam_real_t *P = prj_dd[(coarsen ? 1 : 3) + BFAM_PATH_BIT(i)];
+
+    for (int j = 0; j < Nq_s; ++j)
+      for (int m = 0; m < Nq_d; ++m)
+      {
+        bfam_real_t sum = 0;
+        for (int n = 0; n < Nq_d; ++n)
+          sum += P[m + n * Nq_d] * A[n + j * Nq_d];
+        tmp[m + j * Nq_d] = sum;
+      }
+    memcpy(A, tmp, Nq_d * Nq_s * sizeof(bfam_real_t));
+  }
+#undef BFAM_PATH_BIT
+
+  bfam_arena_release(scratch, mark);
+  return A;
+}
+
+/*
+ * A transfer group is a set of destination elements which all get (part of)
+ * their data from the same source subdomain with the same operators; a
+ * coarsened element gets a contribution from each of its children
+ */
+typedef struct
+{
+  bfam_locidx_t dst_sub;
+  bfam_locidx_t src_sub;
+  uint8_t flag;
+  int8_t lvl_diff; /* number of levels refined or coarsened */
+  uint64_t path;    /* path of the refined dst or coarsened src */
+  bfam_locidx_t num;
+  bfam_locidx_t *dst_elem;
+  bfam_locidx_t *src_elem;
+} bfam_domain_pxest_transfer_group_t;
+
+/* element fields transferred per pass of a group (bounds the scratch) */
+#define BFAM_TRANSFER_BATCH 256
+
+void bfam_domain_pxest_transfer_fields(bfam_domain_pxest_t *domain_dst,
+                                       bfam_domain_pxest_t *domain_src,
+                                       bfam_domain_pxest_transfer_maps_t *maps,
+                                       const char **fields, int wi_mass)
+{
+  p4est_t *pxest_dst = domain_dst->pxest;
+  bfam_domain_t *dom_dst = (bfam_domain_t *)domain_dst;
+  bfam_domain_t *dom_src = (bfam_domain_t *)domain_src;
+
+  int num_fields = 0;
+  while (fields[num_fields])
+    ++num_fields;
+
+  /*
+   * Sort the contributions to the destination elements into groups
+   */
+  char key[BFAM_BUFSIZ];
+  bfam_dictionary_t key_to_group;
+  bfam_dictionary_init(&key_to_group);
+
+  bfam_domain_pxest_transfer_group_t *groups = NULL;
+  bfam_locidx_t num_groups = 0;
+
+  /* element lists of all the groups: the dst_elem lists followed by the
+   * src_elem lists */
+  bfam_locidx_t *group_elem = NULL;
+
+  for (int pass = 0; pass < 2; ++pass)
+  {
+    p4est_topidx_t t;
+    p4est_locidx_t k;
+    for (t = pxest_dst->first_local_tree, k = 0;
+         t <= pxest_dst->last_local_tree; ++t)
+    {
+      p4est_tree_t *tree = p4est_tree_array_index(pxest_dst->trees, t);
+      sc_array_t *quadrants = &tree->quadrants;
+      size_t num_quads = quadrants->elem_count;
+
+      for (size_t zz = 0; zz < num_quads; ++zz, ++k)
+      {
+        p4est_quadrant_t *quad = p4est_quadrant_array_index(quadrants, zz);
+        bfam_pxest_user_data_t *ud = quad->p.user_data;
+
+        const uint8_t flag = maps->dst_to_adapt_flags[k];
+        bfam_locidx_t c_beg = 0, c_end = 1;
+        if (flag == BFAM_FLAG_COARSEN)
+        {
+          const bfam_locidx_t c_k = -1 - maps->dst_to_src_subd_id[k];
+          c_beg = maps->coarse_dst_to_src_offset[c_k];
+          c_end = maps->coarse_dst_to_src_offset[c_k + 1];
+        }
+
+        for (bfam_locidx_t c_id = c_beg; c_id < c_end; ++c_id)
+        {
+          bfam_locidx_t src_sub, src_elem;
+          int8_t lvl_diff;
+          uint64_t path;
+          if (flag == BFAM_FLAG_COARSEN)
+          {
+            src_sub = maps->coarse_dst_to_src_subd_id[c_id];
+            src_elem = maps->coarse_dst_to_src_elem_id[c_id];
+            lvl_diff = maps->coarse_dst_to_src_lvl_diff[c_id];
+            path = maps->coarse_dst_to_src_path[c_id];
+          }
+          else
+          {
+            src_sub = maps->dst_to_src_subd_id[k];
+            src_elem = maps->dst_to_src_elem_id[k];
+            lvl_diff = maps->dst_to_src_lvl_diff[k];
+            path = maps->dst_to_src_path[k];
+          }
+
+          snprintf(key, BFAM_BUFSIZ, "%jd_%jd_%d_%d_%ju", (intmax_t)ud->subd_id,
+                   (intmax_t)src_sub, (int)flag, (int)lvl_diff,
+                   (uintmax_t)path);
+
+          bfam_locidx_t n;
+          if (pass == 0)
+          {
+            int retval =
+                bfam_dictionary_insert_locidx(&key_to_group, key, num_groups);
+            BFAM_ABORT_IF(retval == 0, "Can't insert '%s' into dictionary",
+                          key);
+            if (retval == 2)
+            {
+              groups =
+                  bfam_realloc(groups, (num_groups + 1) * sizeof(*groups));
+              groups[num_groups].dst_sub = ud->subd_id;
+              groups[num_groups].src_sub = src_sub;
+              groups[num_groups].flag = flag;
+              groups[num_groups].lvl_diff = lvl_diff;
+              groups[num_groups].path = path;
+              groups[num_groups].num = 0;
+              ++num_groups;
+            }
+          }
+          BFAM_ABORT_IF_NOT(
+              bfam_dictionary_get_value_locidx(&key_to_group, key, &n),
+              "Transfer group '%s' not found", key);
+
+          bfam_domain_pxest_transfer_group_t *g = &groups[n];
+          if (pass == 1)
+          {
+            g->dst_elem[g->num] = ud->elem_id;
+            g->src_elem[g->num] = src_elem;
+          }
+          ++g->num;
+        }
+      }
+    }
+
+    if (pass == 0)
+    {
+      bfam_locidx_t num_elem = 0;
+      for (bfam_locidx_t n = 0; n < num_groups; ++n)
+        num_elem += groups[n].num;
+      group_elem = bfam_malloc_aligned(BFAM_MAX(2 * num_elem, 1) *
+                                       sizeof(bfam_locidx_t));
+
+      bfam_locidx_t offset = 0;
+      for (bfam_locidx_t n = 0; n < num_groups; ++n)
+      {
+        groups[n].dst_elem = group_elem + offset;
+        groups[n].src_elem = group_elem + num_elem + offset;
+        offset += groups[n].num;
+        groups[n].num = 0;
+      }
+    }
+  }
+
+  BFAM_LDEBUG("Transferring %d fields with %jd groups", num_fields,
+              (intmax_t)num_groups);
+
+  /*
+   * Coarsened elements are summed into so zero them first
+   */
+  for (bfam_locidx_t n = 0; n < num_groups; ++n)
+  {
+    bfam_domain_pxest_transfer_group_t *g = &groups[n];
+    if (g->flag != BFAM_FLAG_COARSEN)
+      continue;
+
+    bfam_subdomain_dgx_t *sub_dst =
+        (bfam_subdomain_dgx_t *)bfam_domain_get_subdomain_by_num(dom_dst,
+                                                                 g->dst_sub);
+    for (int f = 0; f < num_fields; ++f)
+    {
+      bfam_real_t *fld =
+          bfam_dictionary_get_value_ptr(&sub_dst->base.fields, fields[f]);
+      BFAM_ABORT_IF(!fld, "field '%s' missing on subdomain '%s'", fields[f],
+                    sub_dst->base.name);
+      for (bfam_locidx_t e = 0; e < g->num; ++e)
+        memset(fld + (size_t)g->dst_elem[e] * sub_dst->Np, 0,
+               sub_dst->Np * sizeof(bfam_real_t));
+    }
+  }
+
+  /*
+   * Apply the projections group by group
+   */
+  for (bfam_locidx_t n = 0; n < num_groups; ++n)
+  {
+    bfam_domain_pxest_transfer_group_t *g = &groups[n];
+
+    bfam_subdomain_dgx_t *sub_dst =
+        (bfam_subdomain_dgx_t *)bfam_domain_get_subdomain_by_num(dom_dst,
+                                                                 g->dst_sub);
+    bfam_subdomain_dgx_t *sub_src =
+        (bfam_subdomain_dgx_t *)bfam_domain_get_subdomain_by_num(dom_src,
+                                                                 g->src_sub);
+
+    const int Nq_s = sub_src->N + 1;
+    const int Nq_d = sub_dst->N + 1;
+    const int Np_s = sub_src->Np;
+    const int Np_d = sub_dst->Np;
+    const int Nq = BFAM_MAX(Nq_s, Nq_d);
+
+    bfam_arena_t *scratch = bfam_scratch_arena();
+    const size_t mark = bfam_arena_mark(scratch);
+
+    /* operator in each direction */
+    bfam_real_t *A_buf =
+        bfam_arena_alloc(scratch, DIM * Nq_s * Nq_d * sizeof(bfam_real_t));
+    const bfam_real_t *A[3] = {NULL, NULL, NULL};
+    for (int d = 0; d < DIM; ++d)
+      A[d] = bfam_subdomain_dgx_transfer_operator(
+          domain_dst->N2N, sub_src->N, sub_dst->N, g->flag, g->lvl_diff,
+          g->path, d, wi_mass, A_buf + d * Nq_s * Nq_d);
+
+    const bfam_real_t **src_fld =
+        bfam_arena_alloc(scratch, num_fields * sizeof(bfam_real_t *));
+    bfam_real_t **dst_fld =
+        bfam_arena_alloc(scratch, num_fields * sizeof(bfam_real_t *));
+    for (int f = 0; f < num_fields; ++f)
+    {
+      src_fld[f] =
+          bfam_dictionary_get_value_ptr(&sub_src->base.fields, fields[f]);
+      dst_fld[f] =
+          bfam_dictionary_get_value_ptr(&sub_dst->base.fields, fields[f]);
+      BFAM_ABORT_IF(!src_fld[f] || !dst_fld[f],
+                    "field '%s' missing on subdomain '%s' or '%s'", fields[f],
+                    sub_src->base.name, sub_dst->base.name);
+    }
+
+    const bfam_locidx_t batch = BFAM_MIN(
+        g->num, BFAM_MAX(BFAM_TRANSFER_BATCH / BFAM_MAX(num_fields, 1), 1));
+    const size_t sz = (size_t)batch * num_fields * bfam_ipow(Nq, DIM) *
+                      sizeof(bfam_real_t);
+    bfam_real_t *src = bfam_arena_alloc(scratch, sz);
+    bfam_real_t *dst = bfam_arena_alloc(scratch, sz);
+    bfam_real_t *work1 = bfam_arena_alloc(scratch, sz);
+    bfam_real_t *work2 = bfam_arena_alloc(scratch, sz);
+
+    for (bfam_locidx_t e0 = 0; e0 < g->num; e0 += batch)
+    {
+      const bfam_locidx_t num = BFAM_MIN(batch, g->num - e0);
+      const bfam_locidx_t *src_elem = g->src_elem + e0;
+      const bfam_locidx_t *dst_elem = g->dst_elem + e0;
+
+      /* gather */
+      BFAM_PRAGMA_OMP(parallel for schedule(static))
+      for (bfam_locidx_t e = 0; e < num; ++e)
+        for (int f = 0; f < num_fields; ++f)
+          memcpy(src + ((size_t)e * num_fields + f) * Np_s,
+                 src_fld[f] + (size_t)src_elem[e] * Np_s,
+                 Np_s * sizeof(bfam_real_t));
+
+      bfam_subdomain_dgx_tensor_apply(DIM, num * num_fields, Nq_s, Nq_d, A,
+                                      src, dst, work1, work2);
+
+      /* scatter (each destination element appears once in a group) */
+      BFAM_PRAGMA_OMP(parallel for schedule(static))
+      for (bfam_locidx_t e = 0; e < num; ++e)
+        for (int f = 0; f < num_fields; ++f)
+        {
+          bfam_real_t *restrict out =
+              dst_fld[f] + (size_t)dst_elem[e] * Np_d;
+          const bfam_real_t *restrict in =
+              dst + ((size_t)e * num_fields + f) * Np_d;
+          if (g->flag == BFAM_FLAG_COARSEN)
+            for (int i = 0; i < Np_d; ++i)
+              out[i] += in[i];
+          else
+            memcpy(out, in, Np_d * sizeof(bfam_real_t));
+        }
+    }
+
+    bfam_arena_release(scratch, mark);
+  }
+
+  bfam_free_aligned(group_elem);
+  bfam_free(groups);
+  bfam_dictionary_clear(&key_to_group);
+}
+
+/* elements processed at once by the indicator (bounds the scratch memory) */
+#define BFAM_INDICATOR_BATCH 256
+
+void bfam_domain_pxest_modal_indicator(
+    bfam_domain_pxest_t *domain, const char *field,
+    const bfam_domain_pxest_indicator_t *params)
+{
+  bfam_domain_t *dbase = &domain->base;
+  bfam_subdomain_t **subdomains =
+      bfam_malloc(dbase->num_subdomains * sizeof(bfam_subdomain_t **));
+
+  bfam_locidx_t num_subdomains = 0;
+
+  const char *volume[] = {"_volume", NULL};
+
+  bfam_domain_get_subdomains(dbase, BFAM_DOMAIN_AND, volume,
+                             dbase->num_subdomains, subdomains,
+                             &num_subdomains);
+
+  for (bfam_locidx_t s = 0; s < num_subdomains; ++s)
+  {
+    bfam_subdomain_dgx_t *sub = (bfam_subdomain_dgx_t *)subdomains[s];
+    const int N = sub->N;
+    const int Nq = N + 1;
+    const int Np = sub->Np;
+    const bfam_locidx_t K = sub->K;
+
+    BFAM_ABORT_IF(!sub->hadapt || !sub->padapt || !sub->lvl,
+                  "subdomain '%s' has no adaptation arrays", sub->base.name);
+
+    const bfam_real_t *q =
+        bfam_dictionary_get_value_ptr(&sub->base.fields, field);
+    BFAM_ABORT_IF(!q, "field '%s' missing on subdomain '%s'", field,
+                  sub->base.name);
+
+    /* nodal to modal transform: inverse of the Vandermonde matrix */
+    char name[BFAM_BUFSIZ];
+    snprintf(name, BFAM_BUFSIZ, "Vi_%d", N);
+    bfam_real_t *Vi = bfam_dictionary_get_value_ptr(domain->dgx_ops, name);
+    if (!Vi)
+    {
+      bfam_long_real_t *I =
+          bfam_malloc_aligned(Nq * Nq * sizeof(bfam_long_real_t));
+      bfam_long_real_t *lVi =
+          bfam_malloc_aligned(Nq * Nq * sizeof(bfam_long_real_t));
+      for (int n = 0; n < Nq * Nq; ++n)
+        I[n] = (n % (Nq + 1) == 0) ? 1 : 0;
+      bfam_util_backslash(Nq, Nq, sub->lV, I, lVi);
+
+      Vi = bfam_malloc_aligned(Nq * Nq * sizeof(bfam_real_t));
+      for (int n = 0; n < Nq * Nq; ++n)
+        Vi[n] = (bfam_real_t)lVi[n];
+      int BFAM_UNUSED_VAR rval =
+          bfam_dictionary_insert_ptr(domain->dgx_ops, name, Vi);
+      BFAM_ASSERT(rval != 1);
+
+      bfam_free_aligned(lVi);
+      bfam_free_aligned(I);
+    }
+    const bfam_real_t *A[3] = {Vi, Vi, Vi};
+
+    /* fit the decay over the highest modes (but not the constant); below
+     * N = 2 there are too few modes for a fit and the elements are taken to
+     * be smooth so that they are p-refined first */
+    const int num_fit = BFAM_MIN(BFAM_MAX(params->num_fit, 2), N);
+
+    bfam_arena_t *scratch = bfam_scratch_arena();
+    const size_t mark = bfam_arena_mark(scratch);
+    const bfam_locidx_t batch = BFAM_MIN(K, BFAM_INDICATOR_BATCH);
+    const size_t sz = (size_t)batch * Np * sizeof(bfam_real_t);
+    bfam_real_t *modes = bfam_arena_alloc(scratch, sz);
+    bfam_real_t *work1 = bfam_arena_alloc(scratch, sz);
+    bfam_real_t *work2 = bfam_arena_alloc(scratch, sz);
+
+    for (bfam_locidx_t k0 = 0; k0 < K; k0 += batch)
+    {
+      const bfam_locidx_t num = BFAM_MIN(batch, K - k0);
+      bfam_subdomain_dgx_tensor_apply(DIM, num, Nq, Nq, A,
+                                      q + (size_t)k0 * Np, modes, work1, work2);
+
+      BFAM_PRAGMA_OMP(parallel for schedule(static))
+      for (bfam_locidx_t e = 0; e < num; ++e)
+      {
+        const bfam_locidx_t k = k0 + e;
+        const bfam_real_t *restrict m = modes + (size_t)e * Np;
+
+        /* energy in each shell of modes with the same maximum degree */
+        bfam_real_t E[Nq];
+        for (int n = 0; n < Nq; ++n)
+          E[n] = 0;
+        for (int n = 0; n < Np; ++n)
+        {
+          int deg = n % Nq;
+          for (int d = 1, r = n / Nq; d < DIM; ++d, r /= Nq)
+            deg = BFAM_MAX(deg, r % Nq);
+          E[deg] += m[n] * m[n];
+        }
+
+        bfam_real_t total = 0;
+        for (int n = 0; n < Nq; ++n)
+          total += E[n];
+
+        /* relative size of the highest mode */
+        const bfam_real_t err =
+            (total > 0) ? BFAM_REAL_SQRT(E[N] / total) : 0;
+
+        /* least squares fit of log|u_n| = c - sigma n */
+        bfam_real_t sigma = 0;
+        if (num_fit >= 2 && total > 0)
+        {
+          const bfam_real_t floor = total * BFAM_REAL_EPS * BFAM_REAL_EPS;
+          bfam_real_t sx = 0, sy = 0, sxx = 0, sxy = 0;
+          for (int n = N - num_fit + 1; n <= N; ++n)
+          {
+            const bfam_real_t x = (bfam_real_t)n;
+            const bfam_real_t y = BFAM_REAL(0.5) * BFAM_REAL_LOG(E[n] + floor);
+            sx += x;
+            sy += y;
+            sxx += x * x;
+            sxy += x * y;
+          }
+          const bfam_real_t m = (bfam_real_t)num_fit;
+          sigma = -(m * sxy - sx * sy) / (m * sxx - sx * sx);
+        }
+        const int smooth = num_fit < 2 || sigma > params->smooth_decay;
+
+        uint8_t h = BFAM_FLAG_SAME;
+        int p = N;
+        if (err > params->refine_tol)
+        {
+          if ((smooth || sub->lvl[k] >= params->lvl_max) && N < params->N_max)
+            p = N + 1;
+          else if (sub->lvl[k] < params->lvl_max)
+            h = BFAM_FLAG_REFINE;
+        }
+        else if (err < params->coarsen_tol)
+        {
+          if (sub->lvl[k] > params->lvl_min)
+            h = BFAM_FLAG_COARSEN;
+          else if (N > params->N_min)
+            p = N - 1;
+        }
+
+        sub->hadapt[k] = h;
+        sub->padapt[k] = (int8_t)p;
+      }
+    }
+
+    bfam_arena_release(scratch, mark);
+  }
+
+  bfam_free(subdomains);
+}
+
+/* metric terms J dr_i/dx_j */
+#if DIM == 2
+static const int bfam_dgx_vgeo_jr[DIM][DIM] = {
+    {ID_VGEO_JR0X0, ID_VGEO_JR0X1}, {ID_VGEO_JR1X0, ID_VGEO_JR1X1}};
+#else
+static const int bfam_dgx_vgeo_jr[DIM][DIM] = {
+    {ID_VGEO_JR0X0, ID_VGEO_JR0X1, ID_VGEO_JR0X2},
+    {ID_VGEO_JR1X0, ID_VGEO_JR1X1, ID_VGEO_JR1X2},
+    {ID_VGEO_JR2X0, ID_VGEO_JR2X1, ID_VGEO_JR2X2}};
+#endif
+
+/* Kronecker product kernels applying an operator (or its transpose) along
+ * each reference direction of a volume element */
+static void bfam_subdomain_dgx_volume_kernels(const bfam_kron_kernels_t *kron,
+                                              const int trans, const int pe,
+                                              bfam_kron_kernel_t D[DIM])
+{
+#if DIM == 2
+  if (trans)
+  {
+    D[0] = pe ? kron->ixat_pe : kron->ixat;
+    D[1] = pe ? kron->atxi_pe : kron->atxi;
+  }
+  else
+  {
+    D[0] = pe ? kron->ixa_pe : kron->ixa;
+    D[1] = pe ? kron->axi_pe : kron->axi;
+  }
+#else
+  if (trans)
+  {
+    D[0] = pe ? kron->ixixat_pe : kron->ixixat;
+    D[1] = pe ? kron->ixatxi_pe : kron->ixatxi;
+    D[2] = pe ? kron->atxixi_pe : kron->atxixi;
+  }
+  else
+  {
+    D[0] = pe ? kron->ixixa_pe : kron->ixixa;
+    D[1] = pe ? kron->ixaxi_pe : kron->ixaxi;
+    D[2] = pe ? kron->axixi_pe : kron->axixi;
+  }
+#endif
+}
+
+void bfam_subdomain_dgx_geo_init(bfam_subdomain_dgx_geo_t *geo,
+                                 bfam_subdomain_dgx_t *sub,
+                                 const bfam_metric_real_t *restrict vgeo,
+                                 bfam_metric_real_t tol)
+{
+  const int Np = sub->Np;
+  const bfam_locidx_t K = sub->K;
+
+  geo->K = K;
+  geo->Np = Np;
+  geo->num_affine = 0;
+  geo->offset = bfam_malloc_aligned((K + 1) * sizeof(bfam_locidx_t));
+
+  /* size the storage, then fill it */
+  geo->offset[0] = 0;
+  for (bfam_locidx_t k = 0; k < K; ++k)
+  {
+    const bfam_metric_real_t *restrict g = vgeo + (size_t)NVGEO * Np * k;
+
+    /* the metric terms have different units (and scale differently with
+     * the element size), so each is compared against its own magnitude */
+    int affine = (tol >= 0);
+    for (int id = 0; affine && id < NMGEO; ++id)
+    {
+      bfam_metric_real_t scale = 0;
+      for (int n = 0; n < Np; ++n)
+        scale = BFAM_MAX(scale, fabs(g[Np * id + n]));
+      for (int n = 1; affine && n < Np; ++n)
+        affine = fabs(g[Np * id + n] - g[Np * id]) <= tol * scale;
+    }
+
+    geo->num_affine += affine;
+    geo->offset[k + 1] = geo->offset[k] + (affine ? NMGEO : NMGEO * Np);
+  }
+
+  geo->mgeo = bfam_malloc_aligned(BFAM_MAX(geo->offset[K], 1) *
+                                  sizeof(bfam_metric_real_t));
+
+  for (bfam_locidx_t k = 0; k < K; ++k)
+  {
+    const bfam_metric_real_t *restrict g = vgeo + (size_t)NVGEO * Np * k;
+    bfam_metric_real_t *restrict m = geo->mgeo + geo->offset[k];
+    if (geo->offset[k + 1] - geo->offset[k] == NMGEO)
+      for (int id = 0; id < NMGEO; ++id)
+        m[id] = g[Np * id];
+    else
+      memcpy(m, g, NMGEO * Np * sizeof(bfam_metric_real_t));
+  }
+
+  BFAM_LDEBUG("Geometry of %s: %jd of %jd elements affine", sub->base.name,
+              (intmax_t)geo->num_affine, (intmax_t)K);
+}
+
+void bfam_subdomain_dgx_geo_free(bfam_subdomain_dgx_geo_t *geo)
+{
+  bfam_free_aligned(geo->offset);
+  bfam_free_aligned(geo->mgeo);
+  geo->offset = NULL;
+  geo->mgeo = NULL;
+  geo->K = 0;
+  geo->num_affine = 0;
+}
+
+/* metric terms of element k: entry id of node n is g[es * id + ns * n] */
+static const bfam_metric_real_t *
+bfam_subdomain_dgx_geo_elem(const bfam_subdomain_dgx_geo_t *geo,
+                            const bfam_locidx_t k, int *es, int *ns)
+{
+  const int affine = (geo->offset[k + 1] - geo->offset[k] == NMGEO);
+  *es = affine ? 1 : geo->Np;
+  *ns = affine ? 0 : 1;
+  return geo->mgeo + geo->offset[k];
+}
+
+/*
+ * The volume operators run on groups of width elements: with the batched
+ * kernels of bfam_kron_get_low_order_kernels the elements of a group are
+ * gathered interleaved (node n of element b at n * width + b, unused lanes
+ * zero), otherwise width is 1 and the elements are used in place
+ */
+typedef struct
+{
+  const bfam_subdomain_dgx_geo_t *geo;
+  int width;
+  bfam_kron_kernel_t D[DIM];
+  bfam_kron_kernel_t D_pe[DIM];
+  const bfam_real_t *u;        /* field of the gradient */
+  bfam_real_t *const *grad;    /* components of the gradient */
+  const bfam_real_t *const *v; /* components of the divergence field */
+  bfam_real_t *div;            /* divergence */
+  const bfam_real_t *W;        /* quadrature weights of the divergence */
+} bfam_subdomain_dgx_volume_t;
+
+static void bfam_subdomain_dgx_volume_init(bfam_subdomain_dgx_volume_t *vol,
+                                           bfam_subdomain_dgx_t *sub,
+                                           const bfam_subdomain_dgx_geo_t *geo,
+                                           const int weak)
+{
+  const bfam_kron_kernels_t *batch = bfam_kron_get_low_order_kernels(sub->N);
+  const bfam_kron_kernels_t *kron = batch ? batch : sub->kron;
+
+  memset(vol, 0, sizeof(bfam_subdomain_dgx_volume_t));
+  vol->geo = geo;
+  vol->width = kron->width;
+  bfam_subdomain_dgx_volume_kernels(kron, weak, 0, vol->D);
+  bfam_subdomain_dgx_volume_kernels(kron, weak, 1, vol->D_pe);
+}
+
+static void bfam_subdomain_dgx_grad_chunk(bfam_subdomain_t *thesub,
+                                          bfam_locidx_t s,
+                                          bfam_locidx_t k_begin,
+                                          bfam_locidx_t k_end, int thread,
+                                          void *arg)
+{
+  bfam_subdomain_dgx_volume_t *vol = (bfam_subdomain_dgx_volume_t *)arg + s;
+  bfam_subdomain_dgx_t *sub = (bfam_subdomain_dgx_t *)thesub;
+  const int Nq = sub->N + 1;
+  const int Np = sub->Np;
+  const int width = vol->width;
+  const size_t line = (size_t)Np * width;
+  const bfam_real_t *restrict u = vol->u;
+
+  bfam_arena_t *scratch = bfam_scratch_arena();
+  bfam_real_t *restrict ub =
+      (width > 1) ? bfam_arena_alloc(scratch, sizeof(bfam_real_t) * line)
+                  : NULL;
+  bfam_real_t *restrict ur =
+      bfam_arena_alloc(scratch, sizeof(bfam_real_t) * DIM * line);
+
+  for (bfam_locidx_t e0 = k_begin; e0 < k_end; e0 += width)
+  {
+    const int nb = (int)BFAM_MIN(width, k_end - e0);
+
+    const bfam_real_t *restrict x = u + Np * (size_t)e0;
+    if (ub)
+    {
+      for (int n = 0; n < Np; ++n)
+        for (int b = 0; b < width; ++b)
+          ub[n * width + b] = (b < nb) ? x[Np * b + n] : 0;
+      x = ub;
+    }
+
+    for (int i = 0; i < DIM; ++i)
+      vol->D[i](Nq, sub->Dr, x, ur + line * i);
+
+    for (int b = 0; b < nb; ++b)
+    {
+      const size_t k = (size_t)(e0 + b);
+      int es, ns;
+      const bfam_metric_real_t *restrict g =
+          bfam_subdomain_dgx_geo_elem(vol->geo, e0 + b, &es, &ns);
+      const bfam_metric_real_t *restrict Ji = g + es * ID_VGEO_JINV;
+
+      for (int j = 0; j < DIM; ++j)
+      {
+        bfam_real_t *restrict gj = vol->grad[j] + Np * k;
+        for (int n = 0; n < Np; ++n)
+        {
+          bfam_metric_real_t sum = 0;
+          for (int i = 0; i < DIM; ++i)
+            sum += g[es * bfam_dgx_vgeo_jr[i][j] + ns * n] *
+                   ur[line * i + n * width + b];
+          gj[n] = (bfam_real_t)(Ji[ns * n] * sum);
+        }
+      }
+    }
+  }
+}
+
+/* gradients of a list of volume subdomains in one threaded pass */
+static void bfam_subdomain_dgx_grad_list(bfam_subdomain_t **subs,
+                                         const bfam_locidx_t num_subs,
+                                         const bfam_subdomain_dgx_geo_t *geo,
+                                         const bfam_real_t *const *u,
+                                         bfam_real_t *const *const *grad)
+{
+  bfam_subdomain_dgx_volume_t *vol =
+      bfam_malloc(BFAM_MAX(num_subs, 1) * sizeof(bfam_subdomain_dgx_volume_t));
+  for (bfam_locidx_t s = 0; s < num_subs; ++s)
+  {
+    bfam_subdomain_dgx_t *sub = (bfam_subdomain_dgx_t *)subs[s];
+    BFAM_ABORT_IF(sub->dim != DIM, "%s: subdomain %s has dim %d not %d",
+                  __func__, sub->base.name, sub->dim, DIM);
+    bfam_subdomain_dgx_volume_init(vol + s, sub, geo + s, 0);
+    vol[s].u = u[s];
+    vol[s].grad = grad[s];
+  }
+
+  bfam_parallel_for_subdomains(subs, num_subs, bfam_subdomain_dgx_grad_chunk,
+                               vol);
+
+  bfam_free(vol);
+}
+
+void bfam_subdomain_dgx_grad(bfam_subdomain_dgx_t *sub,
+                             const bfam_subdomain_dgx_geo_t *geo,
+                             const bfam_real_t *restrict u,
+                             bfam_real_t *const *grad)
+{
+  bfam_subdomain_t *subs[1] = {&sub->base};
+  const bfam_real_t *us[1] = {u};
+  bfam_subdomain_dgx_grad_list(subs, 1, geo, us, &grad);
+}
+
+/* matching subdomains of a domain; free with bfam_free */
+static bfam_subdomain_t **bfam_domain_dgx_list(bfam_domain_t *domain,
+                                               bfam_domain_match_t match,
+                                               const char **tags,
+                                               bfam_locidx_t *num_subs)
+{
+  bfam_subdomain_t **subs =
+      bfam_malloc(BFAM_MAX(domain->num_subdomains, 1) *
+                  sizeof(bfam_subdomain_t *));
+  bfam_domain_get_subdomains(domain, match, tags, domain->num_subdomains, subs,
+                             num_subs);
+  return subs;
+}
+
+void bfam_domain_dgx_grad(bfam_domain_t *domain, bfam_domain_match_t match,
+                          const char **tags,
+                          const bfam_subdomain_dgx_geo_t *geo,
+                          const bfam_real_t *const *u,
+                          bfam_real_t *const *const *grad)
+{
+  bfam_locidx_t num_subs;
+  bfam_subdomain_t **subs =
+      bfam_domain_dgx_list(domain, match, tags, &num_subs);
+  bfam_subdomain_dgx_grad_list(subs, num_subs, geo, u, grad);
+  bfam_free(subs);
+}
+
+static void bfam_subdomain_dgx_div_chunk(bfam_subdomain_t *thesub,
+                                         bfam_locidx_t s, bfam_locidx_t k_begin,
+                                         bfam_locidx_t k_end, int thread,
+                                         void *arg)
+{
+  bfam_subdomain_dgx_volume_t *vol = (bfam_subdomain_dgx_volume_t *)arg + s;
+  bfam_subdomain_dgx_t *sub = (bfam_subdomain_dgx_t *)thesub;
+  const int Nq = sub->N + 1;
+  const int Np = sub->Np;
+  const int width = vol->width;
+  const size_t line = (size_t)Np * width;
+  const bfam_real_t *const *v = vol->v;
+  const bfam_real_t *restrict W = vol->W;
+
+  bfam_arena_t *scratch = bfam_scratch_arena();
+  bfam_real_t *restrict F =
+      bfam_arena_alloc(scratch, sizeof(bfam_real_t) * line);
+  bfam_real_t *restrict db =
+      (width > 1) ? bfam_arena_alloc(scratch, sizeof(bfam_real_t) * line)
+                  : NULL;
+
+  for (bfam_locidx_t e0 = k_begin; e0 < k_end; e0 += width)
+  {
+    const int nb = (int)BFAM_MIN(width, k_end - e0);
+    bfam_real_t *restrict dk = db ? db : vol->div + Np * (size_t)e0;
+
+    /* unused lanes are zero */
+    for (int n = 0; n < Np; ++n)
+      for (int b = nb; b < width; ++b)
+        F[n * width + b] = 0;
+
+    /* contravariant flux along each reference direction */
+    for (int i = 0; i < DIM; ++i)
+    {
+      for (int b = 0; b < nb; ++b)
+      {
+        const size_t k = (size_t)(e0 + b);
+        int es, ns;
+        const bfam_metric_real_t *restrict g =
+            bfam_subdomain_dgx_geo_elem(vol->geo, e0 + b, &es, &ns);
+        for (int n = 0; n < Np; ++n)
+        {
+          bfam_metric_real_t sum = 0;
+          for (int j = 0; j < DIM; ++j)
+            sum += g[es * bfam_dgx_vgeo_jr[i][j] + ns * n] * v[j][Np * k + n];
+          F[n * width + b] = (bfam_real_t)(W[n] * sum);
+        }
+      }
+      if (i == 0)
+        vol->D[i](Nq, sub->Dr, F, dk);
+      else
+        vol->D_pe[i](Nq, sub->Dr, F, dk);
+    }
+
+    for (int b = 0; b < nb; ++b)
+    {
+      const size_t k = (size_t)(e0 + b);
+      int es, ns;
+      const bfam_metric_real_t *restrict g =
+          bfam_subdomain_dgx_geo_elem(vol->geo, e0 + b, &es, &ns);
+      const bfam_metric_real_t *restrict Ji = g + es * ID_VGEO_JINV;
+      bfam_real_t *restrict divk = vol->div + Np * k;
+      for (int n = 0; n < Np; ++n)
+        divk[n] = (bfam_real_t)(dk[n * width + b] * Ji[ns * n] / W[n]);
+    }
+  }
+}
+
+/*
+ * volume divergence, strong (M^{-1} S) or weak (M^{-1} S^T), of a list of
+ * volume subdomains in one threaded pass
+ */
+static void bfam_subdomain_dgx_div_list(bfam_subdomain_t **subs,
+                                        const bfam_locidx_t num_subs,
+                                        const bfam_subdomain_dgx_geo_t *geo,
+                                        const bfam_real_t *const *const *v,
+                                        bfam_real_t *const *div, const int weak)
+{
+  bfam_subdomain_dgx_volume_t *vol =
+      bfam_malloc(BFAM_MAX(num_subs, 1) * sizeof(bfam_subdomain_dgx_volume_t));
+
+  bfam_arena_t *scratch = bfam_scratch_arena();
+  const size_t mark = bfam_arena_mark(scratch);
+
+  for (bfam_locidx_t s = 0; s < num_subs; ++s)
+  {
+    bfam_subdomain_dgx_t *sub = (bfam_subdomain_dgx_t *)subs[s];
+    BFAM_ABORT_IF(sub->dim != DIM, "%s: subdomain %s has dim %d not %d",
+                  __func__, sub->base.name, sub->dim, DIM);
+
+    const int Nq = sub->N + 1;
+    const int Np = sub->Np;
+    bfam_subdomain_dgx_volume_init(vol + s, sub, geo + s, weak);
+    vol[s].v = v[s];
+    vol[s].div = div[s];
+
+    /* tensor product quadrature weights */
+    bfam_real_t *W = bfam_arena_alloc(scratch, sizeof(bfam_real_t) * Np);
+    for (int n = 0; n < Np; ++n)
+    {
+      W[n] = 1;
+      for (int d = 0, m = n; weak && d < DIM; ++d, m /= Nq)
+        W[n] *= sub->w[m % Nq];
+    }
+    vol[s].W = W;
+  }
+
+  bfam_parallel_for_subdomains(subs, num_subs, bfam_subdomain_dgx_div_chunk,
+                               vol);
+
+  bfam_arena_release(scratch, mark);
+  bfam_free(vol);
+}
+
+void bfam_subdomain_dgx_div(bfam_subdomain_dgx_t *sub,
+                            const bfam_subdomain_dgx_geo_t *geo,
+                            const bfam_real_t *const *v,
+                            bfam_real_t *restrict div)
+{
+  bfam_subdomain_t *subs[1] = {&sub->base};
+  bfam_real_t *divs[1] = {div};
+  bfam_subdomain_dgx_div_list(subs, 1, geo, &v, divs, 0);
+}
+
+void bfam_subdomain_dgx_weak_div(bfam_subdomain_dgx_t *sub,
+                                 const bfam_subdomain_dgx_geo_t *geo,
+                                 const bfam_real_t *const *v,
+                                 bfam_real_t *restrict div)
+{
+  bfam_subdomain_t *subs[1] = {&sub->base};
+  bfam_real_t *divs[1] = {div};
+  bfam_subdomain_dgx_div_list(subs, 1, geo, &v, divs, 1);
+}
+
+void bfam_domain_dgx_div(bfam_domain_t *domain, bfam_domain_match_t match,
+                         const char **tags,
+                         const bfam_subdomain_dgx_geo_t *geo,
+                         const bfam_real_t *const *const *v,
+                         bfam_real_t *const *div)
+{
+  bfam_locidx_t num_subs;
+  bfam_subdomain_t **subs =
+      bfam_domain_dgx_list(domain, match, tags, &num_subs);
+  bfam_subdomain_dgx_div_list(subs, num_subs, geo, v, div, 0);
+  bfam_free(subs);
+}
+
+void bfam_domain_dgx_weak_div(bfam_domain_t *domain, bfam_domain_match_t match,
+                              const char **tags,
+                              const bfam_subdomain_dgx_geo_t *geo,
+                              const bfam_real_t *const *const *v,
+                              bfam_real_t *const *div)
+{
+  bfam_locidx_t num_subs;
+  bfam_subdomain_t **subs =
+      bfam_domain_dgx_list(domain, match, tags, &num_subs);
+  bfam_subdomain_dgx_div_list(subs, num_subs, geo, v, div, 1);
+  bfam_free(subs);
+}
+
+/* glue elements interleaved in the batched glue kernels */
+#define BFAM_DGX_GLUE_WIDTH 8
+
+void bfam_subdomain_dgx_glue_buckets_init(
+    bfam_subdomain_dgx_glue_buckets_t *buckets, bfam_subdomain_dgx_t *sub)
+{
+  bfam_subdomain_dgx_glue_data_t *glue_m =
+      (bfam_subdomain_dgx_glue_data_t *)sub->base.glue_m;
+  bfam_subdomain_dgx_glue_data_t *glue_p =
+      (bfam_subdomain_dgx_glue_data_t *)sub->base.glue_p;
+  BFAM_ABORT_IF(glue_m == NULL || glue_p == NULL || sub->dim < 1 ||
+                    sub->dim > 2,
+                "%s: subdomain %s is not a glue subdomain", __func__,
+                sub->base.name);
+
+  buckets->num_hanging = 1 + (1 << sub->dim);
+  buckets->num_orient = glue_p->num_orient;
+
+  const int num_buckets = buckets->num_hanging * buckets->num_orient;
+  buckets->offset = bfam_malloc((num_buckets + 1) * sizeof(bfam_locidx_t));
+  buckets->elems = bfam_malloc(BFAM_MAX(sub->K, 1) * sizeof(bfam_locidx_t));
+
+  bfam_locidx_t *offset = buckets->offset;
+  for (int n = 0; n <= num_buckets; ++n)
+    offset[n] = 0;
+
+#define BFAM_GLUE_BUCKET(k)                                                    \
+  (glue_m->EToHm[(k)] * buckets->num_orient + glue_p->EToOp[(k)])
+
+  for (bfam_locidx_t k = 0; k < sub->K; ++k)
+  {
+    BFAM_ASSERT(glue_m->EToHm[k] >= 0 &&
+                glue_m->EToHm[k] < buckets->num_hanging);
+    ++offset[BFAM_GLUE_BUCKET(k) + 1];
+  }
+  for (int n = 0; n < num_buckets; ++n)
+    offset[n + 1] += offset[n];
+
+  for (bfam_locidx_t k = 0; k < sub->K; ++k)
+    buckets->elems[offset[BFAM_GLUE_BUCKET(k)]++] = k;
+
+#undef BFAM_GLUE_BUCKET
+
+  /* the fill shifted the offsets by one bucket */
+  for (int n = num_buckets; n > 0; --n)
+    offset[n] = offset[n - 1];
+  offset[0] = 0;
+}
+
+void bfam_subdomain_dgx_glue_buckets_free(
+    bfam_subdomain_dgx_glue_buckets_t *buckets)
+{
+  bfam_free(buckets->offset);
+  bfam_free(buckets->elems);
+  buckets->offset = NULL;
+  buckets->elems = NULL;
+  buckets->num_hanging = 0;
+  buckets->num_orient = 0;
+}
+
+/* Apply the 1D operator A (m x n, column major) to num lines of interleaved
+ * elements: y[l * line_y + i * node_y + b] = sum_j A[i + j * m] x[l * line_x +
+ * j * node_x + b]; A == NULL is the identity */
+static void bfam_dgx_glue_apply_1d(const int m, const int n,
+                                   const bfam_real_t *restrict A,
+                                   const int num, const int line_x,
+                                   const int line_y, const int node_x,
+                                   const int node_y,
+                                   const bfam_real_t *restrict x,
+                                   bfam_real_t *restrict y)
+{
+  const int W = BFAM_DGX_GLUE_WIDTH;
+  BFAM_ASSERT(A != NULL || m == n);
+
+  for (int l = 0; l < num; ++l)
+  {
+    const bfam_real_t *restrict xl = x + (size_t)l * line_x;
+    bfam_real_t *restrict yl = y + (size_t)l * line_y;
+
+    for (int i = 0; i < m; ++i)
+    {
+      bfam_real_t acc[BFAM_DGX_GLUE_WIDTH];
+      if (A == NULL)
+        for (int b = 0; b < W; ++b)
+          acc[b] = xl[i * node_x + b];
+      else
+      {
+        for (int b = 0; b < W; ++b)
+          acc[b] = 0;
+        for (int j = 0; j < n; ++j)
+        {
+          const bfam_real_t a = A[i + j * m];
+          for (int b = 0; b < W; ++b)
+            acc[b] += a * xl[j * node_x + b];
+        }
+      }
+      for (int b = 0; b < W; ++b)
+        yl[i * node_y + b] = acc[b];
+    }
+  }
+}
+
+typedef struct
+{
+  const bfam_subdomain_dgx_glue_buckets_t *buckets;
+  bfam_subdomain_dgx_glue_data_t *glue_p;
+  bfam_real_t **ops;
+  int orient;
+  int glue_in;
+  int Nq_in;
+  int Nq_out;
+  const bfam_real_t *in;
+  bfam_real_t *out;
+} bfam_subdomain_dgx_glue_apply_t;
+
+/* the chunk is a range of positions in the bucket order of the elements; a
+ * bucket cut by the ends of the chunk gets a partial group at the cut */
+static void bfam_subdomain_dgx_glue_apply_chunk(bfam_subdomain_t *thesub,
+                                                bfam_locidx_t s,
+                                                bfam_locidx_t k_begin,
+                                                bfam_locidx_t k_end,
+                                                int thread, void *arg)
+{
+  const bfam_subdomain_dgx_glue_apply_t *ga =
+      (const bfam_subdomain_dgx_glue_apply_t *)arg + s;
+  const bfam_subdomain_dgx_glue_buckets_t *buckets = ga->buckets;
+  bfam_subdomain_dgx_t *sub = (bfam_subdomain_dgx_t *)thesub;
+  const int dim = sub->dim;
+  const int glue_in = ga->glue_in;
+  const int Nq_in = ga->Nq_in;
+  const int Nq_out = ga->Nq_out;
+  const int Np_in = bfam_ipow(Nq_in, dim);
+  const int Np_out = bfam_ipow(Nq_out, dim);
+  const int Np_tmp = Nq_in * Nq_out;
+  const bfam_real_t *restrict in = ga->in;
+  bfam_real_t *restrict out = ga->out;
+
+  const int W = BFAM_DGX_GLUE_WIDTH;
+  const size_t group = (size_t)(Np_in + Np_tmp + Np_out) * W;
+  bfam_real_t *restrict x =
+      bfam_arena_alloc(bfam_scratch_arena(), sizeof(bfam_real_t) * group);
+  bfam_real_t *restrict t = x + (size_t)Np_in * W;
+  bfam_real_t *restrict y = t + (size_t)Np_tmp * W;
+
+  const int num_buckets = buckets->num_hanging * buckets->num_orient;
+  for (int bucket = 0; bucket < num_buckets; ++bucket)
+  {
+    const bfam_locidx_t b_begin = BFAM_MAX(k_begin, buckets->offset[bucket]);
+    const bfam_locidx_t b_end = BFAM_MIN(k_end, buckets->offset[bucket + 1]);
+    if (b_begin >= b_end)
+      continue;
+
+    /* 1D hanging numbers along the face directions */
+    const int h = bucket / buckets->num_orient;
+    const int o = bucket % buckets->num_orient;
+    const int h0 = (h == 0 || dim == 1) ? h : 1 + (h - 1) % 2;
+    const int h1 = (h == 0) ? 0 : 1 + (h - 1) / 2;
+    const bfam_real_t *A0 = ga->ops[h0];
+    const bfam_real_t *A1 = (dim == 2) ? ga->ops[h1] : NULL;
+    const bfam_locidx_t *map = ga->orient ? ga->glue_p->mapOp[o] : NULL;
+
+    for (bfam_locidx_t e0 = b_begin; e0 < b_end; e0 += W)
+    {
+      const bfam_locidx_t *ge = buckets->elems + e0;
+      const int nb = (int)BFAM_MIN(W, b_end - e0);
+
+      /* gather the elements interleaved; unused lanes are zero */
+      for (int b = 0; b < W; ++b)
+      {
+        const bfam_real_t *restrict ik =
+            (b < nb) ? in + (size_t)ge[b] * Np_in : NULL;
+        for (int n = 0; n < Np_in; ++n)
+          x[n * W + b] = ik ? ik[(glue_in && map) ? map[n] : n] : 0;
+      }
+
+      if (dim == 1)
+        bfam_dgx_glue_apply_1d(Nq_out, Nq_in, A0, 1, 0, 0, W, W, x, y);
+      else
+      {
+        /* along the first face direction, then the second */
+        bfam_dgx_glue_apply_1d(Nq_out, Nq_in, A0, Nq_in, Nq_in * W,
+                               Nq_out * W, W, W, x, t);
+        bfam_dgx_glue_apply_1d(Nq_out, Nq_in, A1, Nq_out, W, W, Nq_out * W,
+                               Nq_out * W, t, y);
+      }
+
+      for (int b = 0; b < nb; ++b)
+      {
+        bfam_real_t *restrict ok = out + (size_t)ge[b] * Np_out;
+        for (int n = 0; n < Np_out; ++n)
+          ok[(!glue_in && map) ? map[n] : n] = y[n * W + b];
+      }
+    }
+  }
+}
+
+/* operator data of glue subdomain sub for the glue apply chunks */
+static void bfam_subdomain_dgx_glue_apply_init(
+    bfam_subdomain_dgx_glue_apply_t *ga, bfam_subdomain_dgx_t *sub,
+    const bfam_subdomain_dgx_glue_buckets_t *buckets,
+    bfam_subdomain_dgx_glue_op_t op, int orient, const bfam_real_t *in,
+    bfam_real_t *out)
+{
+  bfam_subdomain_dgx_glue_data_t *glue_m =
+      (bfam_subdomain_dgx_glue_data_t *)sub->base.glue_m;
+  bfam_subdomain_dgx_glue_data_t *glue_p =
+      (bfam_subdomain_dgx_glue_data_t *)sub->base.glue_p;
+  BFAM_ABORT_IF(glue_m == NULL || glue_p == NULL,
+                "%s: subdomain %s is not a glue subdomain", __func__,
+                sub->base.name);
+  bfam_subdomain_dgx_t *sub_m = (bfam_subdomain_dgx_t *)glue_m->base.sub_m;
+  BFAM_ABORT_IF(sub_m == NULL, "%s: glue %s without a minus side", __func__,
+                sub->base.name);
+
+  const int Nq_g = sub->N + 1;
+  const int Nq_m = sub_m->N + 1;
+
+  bfam_real_t **ops = NULL;
+  int Nq_in = Nq_g, Nq_out = Nq_m;
+  switch (op)
+  {
+  case BFAM_DGX_GLUE_INTERPOLATION:
+    ops = glue_m->interpolation;
+    Nq_in = Nq_m;
+    Nq_out = Nq_g;
+    break;
+  case BFAM_DGX_GLUE_PROJECTION:
+    ops = glue_m->projection;
+    break;
+  case BFAM_DGX_GLUE_MASSPROJECTION:
+    ops = glue_m->massprojection;
+    break;
+  default:
+    BFAM_ABORT("%s: unknown glue operator %d", __func__, (int)op);
+  }
+
+  /* the orientation maps the nodes on the glue side of the operator */
+  const int glue_in = (op != BFAM_DGX_GLUE_INTERPOLATION);
+  BFAM_ASSERT(buckets->offset[buckets->num_hanging * buckets->num_orient] ==
+              sub->K);
+
+  ga->buckets = buckets;
+  ga->glue_p = glue_p;
+  ga->ops = ops;
+  ga->orient = orient;
+  ga->glue_in = glue_in;
+  ga->Nq_in = Nq_in;
+  ga->Nq_out = Nq_out;
+  ga->in = in;
+  ga->out = out;
+}
+
+void bfam_subdomain_dgx_glue_apply(
+    bfam_subdomain_dgx_t *sub, const bfam_subdomain_dgx_glue_buckets_t *buckets,
+    bfam_subdomain_dgx_glue_op_t op, int orient,
+    const bfam_real_t *restrict in, bfam_real_t *restrict out)
+{
+  bfam_subdomain_dgx_glue_apply_t ga;
+  bfam_subdomain_dgx_glue_apply_init(&ga, sub, buckets, op, orient, in, out);
+
+  bfam_subdomain_t *subs[1] = {&sub->base};
+  bfam_parallel_for_subdomains(subs, 1, bfam_subdomain_dgx_glue_apply_chunk,
+                               &ga);
+}
+
+void bfam_domain_dgx_glue_apply(
+    bfam_domain_t *domain, bfam_domain_match_t match, const char **tags,
+    const bfam_subdomain_dgx_glue_buckets_t *buckets,
+    bfam_subdomain_dgx_glue_op_t op, int orient, const bfam_real_t *const *in,
+    bfam_real_t *const *out)
+{
+  bfam_locidx_t num_subs;
+  bfam_subdomain_t **subs =
+      bfam_domain_dgx_list(domain, match, tags, &num_subs);
+
+  bfam_subdomain_dgx_glue_apply_t *ga = bfam_malloc(
+      BFAM_MAX(num_subs, 1) * sizeof(bfam_subdomain_dgx_glue_apply_t));
+  for (bfam_locidx_t s = 0; s < num_subs; ++s)
+    bfam_subdomain_dgx_glue_apply_init(ga + s, (bfam_subdomain_dgx_t *)subs[s],
+                                       buckets + s, op, orient, in[s], out[s]);
+
+  bfam_parallel_for_subdomains(subs, num_subs,
+                               bfam_subdomain_dgx_glue_apply_chunk, ga);
+
+  bfam_free(ga);
+  bfam_free(subs);
+}
+
+void bfam_subdomain_dgx_trace_init(bfam_subdomain_dgx_trace_t *trace,
+                                   bfam_subdomain_dgx_t *sub)
+{
+  BFAM_ABORT_IF(sub->vmapM == NULL || sub->vmapP == NULL,
+                "%s: subdomain %s has no face maps", __func__, sub->base.name);
+
+  const int Np = sub->Np;
+  const int Nfp = sub->Ngp[0];
+  const int Nfaces = sub->Ng[0];
+  const bfam_locidx_t num_faces = sub->K * Nfaces;
+
+  trace->Nfp = Nfp;
+  trace->Nfaces = Nfaces;
+  trace->faceP = bfam_malloc_aligned(BFAM_MAX(num_faces, 1) *
+                                     sizeof(bfam_locidx_t));
+  trace->permP = bfam_malloc_aligned(BFAM_MAX(num_faces, 1) * sizeof(int8_t));
+
+  /* the orientations give at most 8 distinct permutations */
+  const int max_perm = 8;
+  trace->perm = bfam_malloc_aligned(max_perm * Nfp * sizeof(int));
+
+  /* pos[f * Np + n] is the position of volume node n on face f or -1 */
+  int *pos = bfam_malloc(Nfaces * Np * sizeof(int));
+  for (int n = 0; n < Nfaces * Np; ++n)
+    pos[n] = -1;
+  for (int f = 0; f < Nfaces; ++f)
+    for (int n = 0; n < Nfp; ++n)
+      pos[f * Np + sub->gmask[0][f][n]] = n;
+
+  /* the identity is permutation 0 so that it can be copied as a block */
+  int *perm = bfam_malloc(Nfp * sizeof(int));
+  for (int n = 0; n < Nfp; ++n)
+    trace->perm[n] = n;
+  trace->num_perm = 1;
+
+  /*
+   * recover the plus side face and orientation of each face from vmapP: the
+   * face whose nodes contain all the plus side nodes
+   */
+  for (bfam_locidx_t fk = 0; fk < num_faces; ++fk)
+  {
+    const bfam_locidx_t *restrict vP = sub->vmapP + (size_t)fk * Nfp;
+    const bfam_locidx_t k2 = vP[0] / Np;
+
+    int f2 = 0;
+    for (; f2 < Nfaces; ++f2)
+    {
+      int n = 0;
+      for (; n < Nfp; ++n)
+      {
+        const bfam_locidx_t v = vP[n] - Np * k2;
+        if (v < 0 || v >= Np || pos[f2 * Np + v] < 0)
+          break;
+        perm[n] = pos[f2 * Np + v];
+      }
+      if (n == Nfp)
+        break;
+    }
+    BFAM_ABORT_IF(f2 == Nfaces, "%s: face %jd of %s has no plus side face",
+                  __func__, (intmax_t)fk, sub->base.name);
+
+    int p = 0;
+    for (; p < trace->num_perm; ++p)
+      if (!memcmp(trace->perm + p * Nfp, perm, Nfp * sizeof(int)))
+        break;
+    if (p == trace->num_perm)
+    {
+      BFAM_ABORT_IF(p == max_perm, "%s: too many face permutations in %s",
+                    __func__, sub->base.name);
+      memcpy(trace->perm + p * Nfp, perm, Nfp * sizeof(int));
+      ++trace->num_perm;
+    }
+
+    trace->faceP[fk] = k2 * Nfaces + f2;
+    trace->permP[fk] = (int8_t)p;
+  }
+
+  bfam_free(perm);
+  bfam_free(pos);
+}
+
+void bfam_subdomain_dgx_trace_free(bfam_subdomain_dgx_trace_t *trace)
+{
+  bfam_free_aligned(trace->faceP);
+  bfam_free_aligned(trace->permP);
+  bfam_free_aligned(trace->perm);
+  trace->faceP = NULL;
+  trace->permP = NULL;
+  trace->perm = NULL;
+  trace->num_perm = 0;
+}
+
+typedef struct
+{
+  const bfam_subdomain_dgx_trace_t *trace;
+  const bfam_real_t *q;
+  bfam_real_t *qM;
+  bfam_real_t *qP;
+} bfam_subdomain_dgx_trace_lift_t;
+
+static void bfam_subdomain_dgx_trace_lift_minus(bfam_subdomain_t *thesub,
+                                                bfam_locidx_t s,
+                                                bfam_locidx_t k_begin,
+                                                bfam_locidx_t k_end,
+                                                int thread, void *arg)
+{
+  const bfam_subdomain_dgx_trace_lift_t *tl =
+      (const bfam_subdomain_dgx_trace_lift_t *)arg + s;
+  bfam_subdomain_dgx_t *sub = (bfam_subdomain_dgx_t *)thesub;
+  const int Np = sub->Np;
+  const int Nfp = tl->trace->Nfp;
+  const int Nfaces = tl->trace->Nfaces;
+  int *const *gmask = sub->gmask[0];
+
+  for (bfam_locidx_t k = k_begin; k < k_end; ++k)
+  {
+    const bfam_real_t *restrict qk = tl->q + (size_t)k * Np;
+    for (int f = 0; f < Nfaces; ++f)
+    {
+      bfam_real_t *restrict qf = tl->qM + ((size_t)k * Nfaces + f) * Nfp;
+      for (int n = 0; n < Nfp; ++n)
+        qf[n] = qk[gmask[f][n]];
+    }
+  }
+}
+
+/* the plus side is a block copy of the minus side trace of the neighbor */
+static void bfam_subdomain_dgx_trace_lift_plus(bfam_subdomain_t *thesub,
+                                               bfam_locidx_t s,
+                                               bfam_locidx_t k_begin,
+                                               bfam_locidx_t k_end, int thread,
+                                               void *arg)
+{
+  const bfam_subdomain_dgx_trace_lift_t *tl =
+      (const bfam_subdomain_dgx_trace_lift_t *)arg + s;
+  const bfam_subdomain_dgx_trace_t *trace = tl->trace;
+  if (tl->qP == NULL)
+    return;
+  const int Nfp = trace->Nfp;
+  const int Nfaces = trace->Nfaces;
+
+  for (bfam_locidx_t fk = k_begin * Nfaces; fk < k_end * Nfaces; ++fk)
+  {
+    const bfam_real_t *restrict src = tl->qM + (size_t)trace->faceP[fk] * Nfp;
+    const int *restrict perm = trace->perm + trace->permP[fk] * Nfp;
+    bfam_real_t *restrict dst = tl->qP + (size_t)fk * Nfp;
+    if (trace->permP[fk] == 0)
+      memcpy(dst, src, Nfp * sizeof(bfam_real_t));
+    else
+      for (int n = 0; n < Nfp; ++n)
+        dst[n] = src[perm[n]];
+  }
+}
+
+void bfam_subdomain_dgx_trace_lift(bfam_subdomain_dgx_t *sub,
+                                   const bfam_subdomain_dgx_trace_t *trace,
+                                   const bfam_real_t *restrict q,
+                                   bfam_real_t *restrict qM,
+                                   bfam_real_t *restrict qP)
+{
+  bfam_subdomain_dgx_trace_lift_t tl = {trace, q, qM, qP};
+  bfam_subdomain_t *subs[1] = {&sub->base};
+
+  bfam_parallel_for_subdomains(subs, 1, bfam_subdomain_dgx_trace_lift_minus,
+                               &tl);
+
+  /* every minus trace is needed before the plus side copies */
+  if (qP)
+    bfam_parallel_for_subdomains(subs, 1, bfam_subdomain_dgx_trace_lift_plus,
+                                 &tl);
+}
+
+void bfam_domain_dgx_trace_lift(bfam_domain_t *domain,
+                                bfam_domain_match_t match, const char **tags,
+                                const bfam_subdomain_dgx_trace_t *trace,
+                                const bfam_real_t *const *q,
+                                bfam_real_t *const *qM, bfam_real_t *const *qP)
+{
+  bfam_locidx_t num_subs;
+  bfam_subdomain_t **subs =
+      bfam_domain_dgx_list(domain, match, tags, &num_subs);
+
+  bfam_subdomain_dgx_trace_lift_t *tl = bfam_malloc(
+      BFAM_MAX(num_subs, 1) * sizeof(bfam_subdomain_dgx_trace_lift_t));
+  int plus = 0;
+  for (bfam_locidx_t s = 0; s < num_subs; ++s)
+  {
+    tl[s].trace = trace + s;
+    tl[s].q = q[s];
+    tl[s].qM = qM[s];
+    tl[s].qP = qP ? qP[s] : NULL;
+    plus = plus || tl[s].qP;
+  }
+
+  bfam_parallel_for_subdomains(subs, num_subs,
+                               bfam_subdomain_dgx_trace_lift_minus, tl);
+
+  /* every minus trace is needed before the plus side copies */
+  if (plus)
+    bfam_parallel_for_subdomains(subs, num_subs,
+                                 bfam_subdomain_dgx_trace_lift_plus, tl);
+
+  bfam_free(tl);
+  bfam_free(subs);
+}
+// }}}
+
+// {{{ parallel for
+/* chunks per thread, and the fewest nodes worth a chunk */
+#define BFAM_PARALLEL_CHUNKS_PER_THREAD 16
+#define BFAM_PARALLEL_MIN_CHUNK 4096
+/* bytes between the chunk ranges of the threads (a cache line) */
+#define BFAM_PARALLEL_LINE 64
+
+typedef struct
+{
+  bfam_locidx_t s;       /* subdomain */
+  bfam_locidx_t k_begin; /* first element */
+  bfam_locidx_t k_end;   /* one past the last element */
+} bfam_parallel_chunk_t;
+
+/*
+ * The chunks still to run by a thread are [head, tail), packed into one
+ * word so that the owner (taking from the head) and thieves (taking from the
+ * tail) update them with a single compare and swap
+ */
+#define BFAM_PARALLEL_RANGE(head, tail)                                        \
+  ((uint64_t)(uint32_t)(head) | ((uint64_t)(uint32_t)(tail) << 32))
+#define BFAM_PARALLEL_HEAD(range) ((int32_t)(uint32_t)(range))
+#define BFAM_PARALLEL_TAIL(range) ((int32_t)(uint32_t)((range) >> 32))
+
+int bfam_parallel_max_threads(void)
+{
+#ifdef _OPENMP
+  return omp_get_max_threads();
+#else
+  return 1;
+#endif
+}
+
+#ifdef _OPENMP
+/* take the chunk at the head of the thread's own range */
+static int bfam_parallel_pop(uint64_t *range, int32_t *c)
+{
+  uint64_t r = __atomic_load_n(range, __ATOMIC_ACQUIRE);
+  for (;;)
+  {
+    const int32_t head = BFAM_PARALLEL_HEAD(r);
+    const int32_t tail = BFAM_PARALLEL_TAIL(r);
+    if (head >= tail)
+      return 0;
+    if (__atomic_compare_exchange_n(range, &r,
+                                    BFAM_PARALLEL_RANGE(head + 1, tail), 0,
+                                    __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+    {
+      *c = head;
+      return 1;
+    }
+  }
+}
+
+/* steal the back half of the range of another thread, run its first chunk
+ * and keep the rest as the thread's own range (which is empty) */
+static int bfam_parallel_steal(uint64_t *ranges, const int stride,
+                               const int num_threads, const int thread,
+                               int32_t *c)
+{
+  for (int v = 1; v < num_threads; ++v)
+  {
+    uint64_t *range = ranges + (size_t)stride * ((thread + v) % num_threads);
+    uint64_t r = __atomic_load_n(range, __ATOMIC_ACQUIRE);
+    for (;;)
+    {
+      const int32_t head = BFAM_PARALLEL_HEAD(r);
+      const int32_t tail = BFAM_PARALLEL_TAIL(r);
+      if (head >= tail)
+        break;
+      const int32_t split = tail - BFAM_MAX(1, (tail - head) / 2);
+      if (__atomic_compare_exchange_n(range, &r,
+                                      BFAM_PARALLEL_RANGE(head, split), 0,
+                                      __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+      {
+        *c = split;
+        __atomic_store_n(ranges + (size_t)stride * thread,
+                         BFAM_PARALLEL_RANGE(split + 1, tail),
+                         __ATOMIC_RELEASE);
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
+#endif
+
+void bfam_parallel_for_subdomains(bfam_subdomain_t **subs,
+                                  bfam_locidx_t num_subs,
+                                  bfam_parallel_kernel_t kernel, void *arg)
+{
+  const int num_threads = bfam_parallel_max_threads();
+
+  size_t cost = 0;
+  for (bfam_locidx_t s = 0; s < num_subs; ++s)
+  {
+    bfam_subdomain_dgx_t *sub = (bfam_subdomain_dgx_t *)subs[s];
+    cost += (size_t)sub->K * sub->Np;
+  }
+  if (cost == 0)
+    return;
+
+  const size_t target =
+      BFAM_MAX(cost / ((size_t)num_threads * BFAM_PARALLEL_CHUNKS_PER_THREAD),
+               BFAM_PARALLEL_MIN_CHUNK);
+
+  /* cut the subdomains into chunks of about target nodes */
+  size_t num_chunks = 0;
+  for (bfam_locidx_t s = 0; s < num_subs; ++s)
+  {
+    bfam_subdomain_dgx_t *sub = (bfam_subdomain_dgx_t *)subs[s];
+    const bfam_locidx_t elems = (bfam_locidx_t)BFAM_MAX(1, target / sub->Np);
+    num_chunks += (size_t)(sub->K + elems - 1) / elems;
+  }
+  BFAM_ABORT_IF(num_chunks > INT32_MAX, "Too many chunks: %zu", num_chunks);
+
+  bfam_parallel_chunk_t *chunks =
+      bfam_malloc(num_chunks * sizeof(bfam_parallel_chunk_t));
+  size_t c = 0;
+  for (bfam_locidx_t s = 0; s < num_subs; ++s)
+  {
+    bfam_subdomain_dgx_t *sub = (bfam_subdomain_dgx_t *)subs[s];
+    const bfam_locidx_t elems = (bfam_locidx_t)BFAM_MAX(1, target / sub->Np);
+    for (bfam_locidx_t k = 0; k < sub->K; k += elems, ++c)
+    {
+      chunks[c].s = s;
+      chunks[c].k_begin = k;
+      chunks[c].k_end = BFAM_MIN(sub->K, k + elems);
+    }
+  }
+
+#ifdef _OPENMP
+  if (num_threads > 1)
+  {
+    /* the ranges of the threads are on separate cache lines */
+    const int stride = BFAM_PARALLEL_LINE / sizeof(uint64_t);
+    uint64_t *ranges =
+        bfam_malloc_aligned((size_t)num_threads * stride * sizeof(uint64_t));
+    for (int t = 0; t < num_threads; ++t)
+      ranges[(size_t)stride * t] =
+          BFAM_PARALLEL_RANGE(num_chunks * t / num_threads,
+                              num_chunks * (t + 1) / num_threads);
+
+    BFAM_PRAGMA_OMP(parallel num_threads(num_threads))
+    {
+      const int thread = omp_get_thread_num();
+      bfam_arena_t *scratch = bfam_scratch_arena();
+      const size_t mark = bfam_arena_mark(scratch);
+      int32_t n;
+      while (bfam_parallel_pop(ranges + (size_t)stride * thread, &n) ||
+             bfam_parallel_steal(ranges, stride, num_threads, thread, &n))
+      {
+        kernel(subs[chunks[n].s], chunks[n].s, chunks[n].k_begin,
+               chunks[n].k_end, thread, arg);
+        bfam_arena_release(scratch, mark);
+      }
+    }
+
+    bfam_free_aligned(ranges);
+    bfam_free(chunks);
+    return;
+  }
+#endif
+
+  bfam_arena_t *scratch = bfam_scratch_arena();
+  const size_t mark = bfam_arena_mark(scratch);
+  for (c = 0; c < num_chunks; ++c)
+  {
+    kernel(subs[chunks[c].s], chunks[c].s, chunks[c].k_begin, chunks[c].k_end,
+           0, arg);
+    bfam_arena_release(scratch, mark);
+  }
+  bfam_free(chunks);
+}
+
+void bfam_domain_parallel_for(bfam_domain_t *domain, bfam_domain_match_t match,
+                              const char **tags, bfam_parallel_kernel_t kernel,
+                              void *arg)
+{
+  bfam_subdomain_t **subs =
+      bfam_malloc(BFAM_MAX(domain->num_subdomains, 1) *
+                  sizeof(bfam_subdomain_t *));
+  bfam_locidx_t num_subs = 0;
+  bfam_domain_get_subdomains(domain, match, tags, domain->num_subdomains, subs,
+                             &num_subs);
+
+  bfam_parallel_for_subdomains(subs, num_subs, kernel, arg);
+
+  bfam_free(subs);
+}
+// }}}
+
+// {{{ cfl
+/* inverse length scale N^2/2 max_n sum_i |grad r_i| of the elements */
+static void bfam_domain_cfl_inv_len(bfam_subdomain_dgx_t *sub, double *inv_len)
+{
+  const int Nq = sub->N + 1;
+  const int Np = sub->Np;
+  const double N2 = BFAM_MAX(sub->N, 1) * BFAM_MAX(sub->N, 1) / 2.0;
+
+  bfam_real_t *x[DIM];
+  char name[BFAM_BUFSIZ];
+  for (int j = 0; j < DIM; ++j)
+  {
+    snprintf(name, BFAM_BUFSIZ, "_grid_x%d", j);
+    x[j] = bfam_dictionary_get_value_ptr(&sub->base.fields, name);
+    BFAM_ABORT_IF(x[j] == NULL, "CFL: %s not in subdomain %s", name,
+                  sub->base.name);
+  }
+
+  bfam_kron_kernel_t D[DIM];
+  bfam_subdomain_dgx_volume_kernels(sub->kron, 0, 0, D);
+
+  /* xr[Np * (DIM * i + j) + n] = dx_j / dr_i */
+  bfam_real_t *xr = bfam_malloc_aligned(sizeof(bfam_real_t) * DIM * DIM * Np);
+
+  for (bfam_locidx_t k = 0; k < sub->K; ++k)
+  {
+    for (int i = 0; i < DIM; ++i)
+      for (int j = 0; j < DIM; ++j)
+        D[i](Nq, sub->Dr, x[j] + (size_t)Np * k, xr + Np * (DIM * i + j));
+
+    double len = 0;
+    for (int n = 0; n < Np; ++n)
+    {
+      double a[DIM][DIM];
+      for (int i = 0; i < DIM; ++i)
+        for (int j = 0; j < DIM; ++j)
+          a[i][j] = xr[Np * (DIM * i + j) + n];
+
+      /*
+       * |grad r_i| = |x_{r_{i+1}} x x_{r_{i+2}}| / |J| (in 2D the cross
+       * product is the rotated tangent x_{r_{1-i}})
+       */
+      double c[DIM];
+#if DIM == 2
+      const double J = a[0][0] * a[1][1] - a[0][1] * a[1][0];
+      c[0] = sqrt(a[1][0] * a[1][0] + a[1][1] * a[1][1]);
+      c[1] = sqrt(a[0][0] * a[0][0] + a[0][1] * a[0][1]);
+#else
+      double J = 0;
+      for (int i = 0; i < DIM; ++i)
+      {
+        const double *u = a[(i + 1) % DIM], *v = a[(i + 2) % DIM];
+        const double w[DIM] = {u[1] * v[2] - u[2] * v[1],
+                               u[2] * v[0] - u[0] * v[2],
+                               u[0] * v[1] - u[1] * v[0]};
+        c[i] = sqrt(w[0] * w[0] + w[1] * w[1] + w[2] * w[2]);
+        if (i == 0)
+          J = a[0][0] * w[0] + a[0][1] * w[1] + a[0][2] * w[2];
+      }
+#endif
+      double sum = 0;
+      for (int i = 0; i < DIM; ++i)
+        sum += c[i];
+      len = BFAM_MAX(len, sum / fabs(J));
+    }
+    inv_len[k] = N2 * len;
+  }
+
+  bfam_free_aligned(xr);
+}
+
+void bfam_domain_cfl_init(bfam_domain_cfl_t *cfl, bfam_domain_t *dom,
+                          bfam_domain_match_t subdom_match,
+                          const char **subdom_tags,
+                          bfam_domain_cfl_speed_t speed, void *user_data)
+{
+  cfl->comm = dom->comm;
+  cfl->speed = speed;
+  cfl->user_data = user_data;
+  cfl->recompute = 1;
+  cfl->pending = 0;
+  cfl->req = MPI_REQUEST_NULL;
+  cfl->loc_rate = 0;
+  cfl->rate = 0;
+
+  cfl->subs = bfam_malloc(BFAM_MAX(dom->num_subdomains, 1) *
+                          sizeof(bfam_subdomain_dgx_t *));
+  bfam_domain_get_subdomains(dom, subdom_match, subdom_tags,
+                             dom->num_subdomains,
+                             (bfam_subdomain_t **)cfl->subs, &cfl->num_subs);
+
+  cfl->inv_len = bfam_malloc(BFAM_MAX(cfl->num_subs, 1) * sizeof(double *));
+  for (bfam_locidx_t s = 0; s < cfl->num_subs; ++s)
+  {
+    bfam_subdomain_dgx_t *sub = cfl->subs[s];
+    BFAM_ABORT_IF(sub->dim != DIM || sub->base.glue_m != NULL,
+                  "CFL: subdomain %s is not a volume subdomain",
+                  sub->base.name);
+    cfl->inv_len[s] = bfam_malloc(BFAM_MAX(sub->K, 1) * sizeof(double));
+    bfam_domain_cfl_inv_len(sub, cfl->inv_len[s]);
+  }
+}
+
+void bfam_domain_cfl_free(bfam_domain_cfl_t *cfl)
+{
+  if (cfl->pending)
+    BFAM_MPI_CHECK(MPI_Wait(&cfl->req, MPI_STATUS_IGNORE));
+  cfl->pending = 0;
+
+  for (bfam_locidx_t s = 0; s < cfl->num_subs; ++s)
+    bfam_free(cfl->inv_len[s]);
+  bfam_free(cfl->inv_len);
+  bfam_free(cfl->subs);
+  cfl->num_subs = 0;
+}
+
+void bfam_domain_cfl_flag(bfam_domain_cfl_t *cfl) { cfl->recompute = 1; }
+
+/* rate of the local elements of subdomain s of the cache */
+static double bfam_domain_cfl_sub_rate(bfam_domain_cfl_t *cfl,
+                                       bfam_locidx_t s)
+{
+  bfam_subdomain_dgx_t *sub = cfl->subs[s];
+  const double *restrict inv_len = cfl->inv_len[s];
+  double rate = 0;
+
+  BFAM_PRAGMA_OMP(parallel for schedule(static) reduction(max : rate))
+  for (bfam_locidx_t k = 0; k < sub->K; ++k)
+  {
+    const double r = cfl->speed(sub, k, cfl->user_data) * inv_len[k];
+    rate = BFAM_MAX(rate, r);
+  }
+
+  return rate;
+}
+
+/* start the reduction of the local rate */
+static void bfam_domain_cfl_reduce(bfam_domain_cfl_t *cfl, double loc_rate)
+{
+  if (cfl->pending)
+    BFAM_MPI_CHECK(MPI_Wait(&cfl->req, MPI_STATUS_IGNORE));
+
+  cfl->loc_rate = loc_rate;
+  BFAM_MPI_CHECK(MPI_Iallreduce(&cfl->loc_rate, &cfl->rate, 1, MPI_DOUBLE,
+                                MPI_MAX, cfl->comm, &cfl->req));
+  cfl->pending = 1;
+  cfl->recompute = 0;
+}
+
+void bfam_domain_cfl_start(bfam_domain_cfl_t *cfl)
+{
+  if (!cfl->recompute)
+    return;
+
+  double rate = 0;
+  for (bfam_locidx_t s = 0; s < cfl->num_subs; ++s)
+    rate = BFAM_MAX(rate, bfam_domain_cfl_sub_rate(cfl, s));
+
+  bfam_domain_cfl_reduce(cfl, rate);
+}
+
+double bfam_domain_cfl_rate(bfam_domain_cfl_t *cfl)
+{
+  if (cfl->recompute)
+    bfam_domain_cfl_start(cfl);
+
+  if (cfl->pending)
+  {
+    BFAM_MPI_CHECK(MPI_Wait(&cfl->req, MPI_STATUS_IGNORE));
+    cfl->pending = 0;
+  }
+
+  return cfl->rate;
+}
+// }}}
+
+// {{{ ts lsrk
+static void bfam_ts_lsrk_coefficients(bfam_ts_lsrk_t *ts,
+                                      bfam_ts_lsrk_method_t method)
+{
+  switch (method)
+  {
+  default:
+    BFAM_WARNING("Invalid LSRK scheme, using KC54");
+    /* fall through */
+  case BFAM_TS_LSRK_KC54:
+    ts->n_stages = 5;
+    break;
+  case BFAM_TS_LSRK_W33:
+    ts->n_stages = 3;
+    break;
+  case BFAM_TS_LSRK_HEUN:
+    ts->n_stages = 2;
+    break;
+  case BFAM_TS_LSRK_FE:
+    ts->n_stages = 1;
+    break;
+  case BFAM_TS_LSRK_NOOP:
+    ts->n_stages = 0;
+    break;
+  }
+
+  ts->A = bfam_malloc_aligned(BFAM_MAX(ts->n_stages, 1) *
+                              sizeof(bfam_long_real_t));
+  ts->B = bfam_malloc_aligned(BFAM_MAX(ts->n_stages, 1) *
+                              sizeof(bfam_long_real_t));
+  ts->C = bfam_malloc_aligned((ts->n_stages + 1) * sizeof(bfam_long_real_t));
+
+  switch (ts->n_stages)
+  {
+  case 5:
+    ts->A[0] = (bfam_long_real_t)(0.0L);
+    ts->A[1] = (bfam_long_real_t)(-567301805773.0L / 1357537059087.0L);
+    ts->A[2] = (bfam_long_real_t)(-2404267990393.0L / 2016746695238.0L);
+    ts->A[3] = (bfam_long_real_t)(-3550918686646.0L / 2091501179385.0L);
+    ts->A[4] = (bfam_long_real_t)(-1275806237668.0L / 842570457699.0L);
+
+    ts->B[0] = (bfam_long_real_t)(1432997174477.0L / 9575080441755.0L);
+    ts->B[1] = (bfam_long_real_t)(5161836677717.0L / 13612068292357.0L);
+    ts->B[2] = (bfam_long_real_t)(1720146321549.0L / 2090206949498.0L);
+    ts->B[3] = (bfam_long_real_t)(3134564353537.0L / 4481467310338.0L);
+    ts->B[4] = (bfam_long_real_t)(2277821191437.0L / 14882151754819.0L);
+
+    ts->C[0] = (bfam_long_real_t)(0.0L);
+    ts->C[1] = (bfam_long_real_t)(1432997174477.0L / 9575080441755.0L);
+    ts->C[2] = (bfam_long_real_t)(2526269341429.0L / 6820363962896.0L);
+    ts->C[3] = (bfam_long_real_t)(2006345519317.0L / 3224310063776.0L);
+    ts->C[4] = (bfam_long_real_t)(2802321613138.0L / 2924317926251.0L);
+    ts->C[5] = (bfam_long_real_t)(1.0L);
+    break;
+  case 3:
+    ts->A[0] = (bfam_long_real_t)(0.0L);
+    ts->A[1] = (bfam_long_real_t)(-5.0L / 9.0L);
+    ts->A[2] = (bfam_long_real_t)(-153.0L / 128.0L);
+
+    ts->B[0] = (bfam_long_real_t)(1.0L / 3.0L);
+    ts->B[1] = (bfam_long_real_t)(15.0L / 16.0L);
+    ts->B[2] = (bfam_long_real_t)(8.0L / 15.0L);
+
+    ts->C[0] = (bfam_long_real_t)(0.0L);
+    ts->C[1] = (bfam_long_real_t)(1.0L / 3.0L);
+    ts->C[2] = (bfam_long_real_t)(3.0L / 4.0L);
+    ts->C[3] = (bfam_long_real_t)(1.0L);
+    break;
+  case 2:
+    ts->A[0] = (bfam_long_real_t)(0.0L);
+    ts->A[1] = (bfam_long_real_t)(-1.0L);
+
+    ts->B[0] = (bfam_long_real_t)(1.0L);
+    ts->B[1] = (bfam_long_real_t)(1.0L / 2.0L);
+
+    ts->C[0] = (bfam_long_real_t)(0.0L);
+    ts->C[1] = (bfam_long_real_t)(1.0L);
+    ts->C[2] = (bfam_long_real_t)(1.0L);
+    break;
+  case 1:
+    ts->A[0] = (bfam_long_real_t)(0.0L);
+
+    ts->B[0] = (bfam_long_real_t)(1.0L);
+
+    ts->C[0] = (bfam_long_real_t)(0.0L);
+    ts->C[1] = (bfam_long_real_t)(1.0L);
+    break;
+  default:
+    ts->C[0] = (bfam_long_real_t)(0.0L);
+    break;
+  }
+}
+
+void bfam_ts_lsrk_init(bfam_ts_lsrk_t *ts, bfam_domain_t *dom,
+                       bfam_ts_lsrk_method_t method,
+                       bfam_domain_match_t subdom_match,
+                       const char **subdom_tags, const char **fields,
+                       const char *rate_prefix,
+                       const bfam_ts_lsrk_hooks_t *hooks)
+{
+  bfam_ts_lsrk_coefficients(ts, method);
+  ts->t = 0;
+  ts->hooks = *hooks;
+  ts->cfl = NULL;
+  ts->cfl_sub = NULL;
+  snprintf(ts->rate_prefix, BFAM_BUFSIZ, "%s", rate_prefix);
+
+  ts->subs = bfam_malloc(BFAM_MAX(dom->num_subdomains, 1) *
+                         sizeof(bfam_subdomain_t *));
+  bfam_domain_get_subdomains(dom, subdom_match, subdom_tags,
+                             dom->num_subdomains, ts->subs, &ts->num_subs);
+
+  for (ts->num_fields = 0; fields && fields[ts->num_fields]; ++ts->num_fields)
+    ;
+
+  const size_t num_ptrs = BFAM_MAX((size_t)ts->num_subs * ts->num_fields, 1);
+  ts->q = bfam_malloc(num_ptrs * sizeof(bfam_real_t *));
+  ts->dq = bfam_malloc(num_ptrs * sizeof(bfam_real_t *));
+
+  char name[BFAM_BUFSIZ];
+  for (bfam_locidx_t s = 0; s < ts->num_subs; ++s)
+  {
+    bfam_subdomain_dgx_t *sub = (bfam_subdomain_dgx_t *)ts->subs[s];
+
+    if (ts->hooks.aux_rates)
+      ts->hooks.aux_rates(ts->subs[s], ts->rate_prefix, ts->hooks.user_data);
+
+    for (int f = 0; f < ts->num_fields; ++f)
+    {
+      const size_t n = (size_t)s * ts->num_fields + f;
+      ts->q[n] = bfam_dictionary_get_value_ptr(&sub->base.fields, fields[f]);
+      ts->dq[n] = NULL;
+      if (ts->q[n] == NULL)
+        continue;
+
+      snprintf(name, BFAM_BUFSIZ, "%s%s", ts->rate_prefix, fields[f]);
+      ts->dq[n] = bfam_dictionary_get_value_ptr(&sub->base.fields, name);
+      BFAM_ABORT_IF(ts->dq[n] == NULL, "LSRK: rate %s not in subdomain %s",
+                    name, sub->base.name);
+      memset(ts->dq[n], 0, (size_t)sub->K * sub->Np * sizeof(bfam_real_t));
+    }
+  }
+}
+
+void bfam_ts_lsrk_free(bfam_ts_lsrk_t *ts)
+{
+  ts->n_stages = 0;
+  bfam_free_aligned(ts->A);
+  bfam_free_aligned(ts->B);
+  bfam_free_aligned(ts->C);
+  bfam_free(ts->subs);
+  bfam_free(ts->q);
+  bfam_free(ts->dq);
+  bfam_free(ts->cfl_sub);
+  ts->cfl = NULL;
+  ts->cfl_sub = NULL;
+  ts->num_subs = 0;
+  ts->num_fields = 0;
+}
+
+void bfam_ts_lsrk_set_cfl(bfam_ts_lsrk_t *ts, bfam_domain_cfl_t *cfl)
+{
+  bfam_free(ts->cfl_sub);
+  ts->cfl = cfl;
+  ts->cfl_sub = NULL;
+  if (cfl == NULL)
+    return;
+
+  ts->cfl_sub = bfam_malloc(BFAM_MAX(ts->num_subs, 1) * sizeof(bfam_locidx_t));
+  for (bfam_locidx_t s = 0; s < ts->num_subs; ++s)
+  {
+    ts->cfl_sub[s] = -1;
+    for (bfam_locidx_t c = 0; c < cfl->num_subs; ++c)
+      if ((bfam_subdomain_t *)cfl->subs[c] == ts->subs[s])
+        ts->cfl_sub[s] = c;
+  }
+}
+
+#define BFAM_TS_LSRK_RATE_STRIDE (BFAM_PARALLEL_LINE / sizeof(double))
+
+typedef struct
+{
+  bfam_ts_lsrk_t *ts;
+  bfam_real_t a;
+  bfam_real_t b;
+  int fuse;
+  double *rate; /* max rate of each thread, a cache line apart */
+} bfam_ts_lsrk_update_t;
+
+static void bfam_ts_lsrk_update_chunk(bfam_subdomain_t *thesub,
+                                      bfam_locidx_t s, bfam_locidx_t k_begin,
+                                      bfam_locidx_t k_end, int thread,
+                                      void *arg)
+{
+  bfam_ts_lsrk_update_t *u = arg;
+  bfam_ts_lsrk_t *ts = u->ts;
+  bfam_subdomain_dgx_t *sub = (bfam_subdomain_dgx_t *)thesub;
+  const int num_fields = ts->num_fields;
+  bfam_real_t **q = ts->q + (size_t)s * num_fields;
+  bfam_real_t **dq = ts->dq + (size_t)s * num_fields;
+  const int Np = sub->Np;
+  const bfam_real_t a = u->a;
+  const bfam_real_t b = u->b;
+
+  const bfam_locidx_t c = u->fuse ? ts->cfl_sub[s] : -1;
+  const double *restrict inv_len = (c >= 0) ? ts->cfl->inv_len[c] : NULL;
+  double rate = 0;
+
+  for (bfam_locidx_t k = k_begin; k < k_end; ++k)
+  {
+    for (int f = 0; f < num_fields; ++f)
+    {
+      if (q[f] == NULL)
+        continue;
+      bfam_real_t *restrict qk = q[f] + (size_t)k * Np;
+      bfam_real_t *restrict dqk = dq[f] + (size_t)k * Np;
+      for (int n = 0; n < Np; ++n)
+      {
+        qk[n] += a * dqk[n];
+        dqk[n] *= b;
+      }
+    }
+
+    /* the fields of the element are still in cache */
+    if (inv_len)
+    {
+      const double r = ts->cfl->speed(sub, k, ts->cfl->user_data) * inv_len[k];
+      rate = BFAM_MAX(rate, r);
+    }
+  }
+
+  double *thread_rate = u->rate + (size_t)thread * BFAM_TS_LSRK_RATE_STRIDE;
+  *thread_rate = BFAM_MAX(*thread_rate, rate);
+}
+
+/*
+ * q += a dq and dq *= b for all fields in one pass; with fuse the rate of
+ * the cfl subdomains is computed in the same pass and returned
+ */
+static double bfam_ts_lsrk_update(bfam_ts_lsrk_t *ts, const bfam_real_t a,
+                                  const bfam_real_t b, const int fuse)
+{
+  const int num_threads = bfam_parallel_max_threads();
+  const size_t num_rates = (size_t)num_threads * BFAM_TS_LSRK_RATE_STRIDE;
+  bfam_ts_lsrk_update_t u = {ts, a, b, fuse, NULL};
+
+  /* the chunks of this thread release its arena above the rates */
+  bfam_arena_t *scratch = bfam_scratch_arena();
+  const size_t mark = bfam_arena_mark(scratch);
+  u.rate = bfam_arena_alloc(scratch, num_rates * sizeof(double));
+  memset(u.rate, 0, num_rates * sizeof(double));
+
+  bfam_parallel_for_subdomains(ts->subs, ts->num_subs,
+                               bfam_ts_lsrk_update_chunk, &u);
+
+  double rate = 0;
+  for (int t = 0; t < num_threads; ++t)
+    rate = BFAM_MAX(rate, u.rate[(size_t)t * BFAM_TS_LSRK_RATE_STRIDE]);
+  bfam_arena_release(scratch, mark);
+
+  return rate;
+}
+
+void bfam_ts_lsrk_step(bfam_ts_lsrk_t *ts, const bfam_long_real_t dt)
+{
+  const bfam_ts_lsrk_hooks_t *h = &ts->hooks;
+
+  for (int stage = 0; stage < ts->n_stages; ++stage)
+  {
+    const bfam_long_real_t t = ts->t + ts->C[stage] * dt;
+
+    if (h->comm_start)
+      h->comm_start(t, h->user_data);
+
+    if (h->intra_rhs)
+      for (bfam_locidx_t s = 0; s < ts->num_subs; ++s)
+        h->intra_rhs(ts->subs[s], ts->rate_prefix, t, h->user_data);
+
+    if (h->comm_finish)
+      h->comm_finish(t, h->user_data);
+
+    if (h->inter_rhs)
+      for (bfam_locidx_t s = 0; s < ts->num_subs; ++s)
+        h->inter_rhs(ts->subs[s], ts->rate_prefix, t, h->user_data);
+
+    /* the scaling of the rates by A of the next stage is done here so that
+     * the rates are only read and written once per stage */
+    const int next = (stage + 1) % ts->n_stages;
+    const int fuse = next == 0 && ts->cfl && ts->cfl->recompute;
+    const double rate = bfam_ts_lsrk_update(
+        ts, (bfam_real_t)(dt * ts->B[stage]), (bfam_real_t)ts->A[next], fuse);
+
+    if (fuse)
+    {
+      bfam_domain_cfl_t *cfl = ts->cfl;
+      double loc_rate = rate;
+      for (bfam_locidx_t c = 0; c < cfl->num_subs; ++c)
+      {
+        int stepped = 0;
+        for (bfam_locidx_t s = 0; s < ts->num_subs && !stepped; ++s)
+          stepped = ts->cfl_sub[s] == c;
+        if (!stepped)
+          loc_rate = BFAM_MAX(loc_rate, bfam_domain_cfl_sub_rate(cfl, c));
+      }
+      bfam_domain_cfl_reduce(cfl, loc_rate);
+    }
+  }
+
+  ts->t += dt;
+}
+// }}}
+
+// {{{ ts mrab
+/* integrals over [a, b] of the Lagrange polynomials through the rates at
+ * 0, -1, ..., -(order-1), with time in units of the step size */
+static void bfam_ts_mrab_weights(const int order, const bfam_long_real_t a,
+                                 const bfam_long_real_t b,
+                                 bfam_long_real_t *beta)
+{
+  for (int i = 0; i < order; ++i)
+  {
+    /* monomial coefficients of the Lagrange polynomial of node -i */
+    bfam_long_real_t c[BFAM_TS_MRAB_MAX_ORDER] = {1};
+    int deg = 0;
+    for (int k = 0; k < order; ++k)
+    {
+      if (k == i)
+        continue;
+      /* multiply by (tau + k) / (k - i) */
+      const bfam_long_real_t s = 1 / (bfam_long_real_t)(k - i);
+      for (int d = deg + 1; d > 0; --d)
+        c[d] = (c[d - 1] + k * c[d]) * s;
+      c[0] = k * c[0] * s;
+      ++deg;
+    }
+
+    bfam_long_real_t pa = a, pb = b;
+    beta[i] = 0;
+    for (int d = 0; d <= deg; ++d, pa *= a, pb *= b)
+      beta[i] += c[d] * (pb - pa) / (d + 1);
+  }
+}
+
+/* field name prefix of the rates stored in slot i */
+static void bfam_ts_mrab_prefix(const bfam_ts_mrab_t *ts, int i, char *prefix)
+{
+  snprintf(prefix, BFAM_BUFSIZ, "%.*s%d_", BFAM_BUFSIZ - 16, ts->rate_prefix,
+           i);
+}
+
+/* index in cfl of volume subdomain s, or of the minus side of glue s */
+static bfam_locidx_t bfam_ts_mrab_cfl_sub(const bfam_ts_mrab_t *ts,
+                                          const bfam_domain_cfl_t *cfl,
+                                          const bfam_locidx_t s)
+{
+  bfam_subdomain_t *sub = ts->subs[s];
+  if (sub->glue_m)
+  {
+    sub = sub->glue_m->sub_m;
+    BFAM_ABORT_IF(sub == NULL, "MRAB: glue %s without a minus side",
+                  ts->subs[s]->name);
+  }
+
+  for (bfam_locidx_t c = 0; c < cfl->num_subs; ++c)
+    if ((bfam_subdomain_t *)cfl->subs[c] == sub)
+      return c;
+
+  BFAM_ABORT("MRAB: subdomain %s not in the rate cache", sub->name);
+  return -1;
+}
+
+/*
+ * rate level of element (or glue face) k of subdomain s, whose volume
+ * elements are those of subdomain c of the cache: the largest j below
+ * num_lvls for which 2^j times the rate of the element is at most max_rate
+ */
+static int bfam_ts_mrab_elem_lvl(const bfam_ts_mrab_t *ts,
+                                 const bfam_domain_cfl_t *cfl,
+                                 const bfam_locidx_t s, const bfam_locidx_t c,
+                                 bfam_locidx_t k, const double max_rate,
+                                 const int num_lvls)
+{
+  bfam_subdomain_dgx_t *sub = (bfam_subdomain_dgx_t *)ts->subs[s];
+  if (sub->base.glue_m)
+    k = ((bfam_subdomain_dgx_glue_data_t *)sub->base.glue_m)->EToEm[k];
+
+  const double rate =
+      cfl->speed(cfl->subs[c], k, cfl->user_data) * cfl->inv_len[c][k];
+
+  int j = 0;
+  while (j + 1 < num_lvls && ldexp(rate, j + 1) <= max_rate)
+    ++j;
+
+  return j;
+}
+
+/* adds the rate of all elements of subdomain thesub for the starter */
+static void bfam_ts_mrab_start_rhs(bfam_ts_mrab_t *ts, bfam_ts_mrab_rhs_t rhs,
+                                   bfam_subdomain_t *thesub,
+                                   const char *rate_prefix,
+                                   const bfam_long_real_t t)
+{
+  const int L = ts->num_lvls;
+
+  for (bfam_locidx_t s = 0; s < ts->num_subs; ++s)
+  {
+    if (ts->subs[s] != thesub)
+      continue;
+    const bfam_locidx_t *offset = ts->lvl_offset + (size_t)s * (L + 1);
+    if (offset[L] > offset[0])
+      rhs(thesub, rate_prefix, t, ts->lvl_elems + offset[0],
+          offset[L] - offset[0], ts->hooks.user_data);
+  }
+}
+
+static void bfam_ts_mrab_start_intra_rhs(bfam_subdomain_t *thesub,
+                                         const char *rate_prefix,
+                                         const bfam_long_real_t t,
+                                         void *user_data)
+{
+  bfam_ts_mrab_t *ts = user_data;
+  bfam_ts_mrab_start_rhs(ts, ts->hooks.intra_rhs, thesub, rate_prefix, t);
+}
+
+static void bfam_ts_mrab_start_inter_rhs(bfam_subdomain_t *thesub,
+                                         const char *rate_prefix,
+                                         const bfam_long_real_t t,
+                                         void *user_data)
+{
+  bfam_ts_mrab_t *ts = user_data;
+  bfam_ts_mrab_start_rhs(ts, ts->hooks.inter_rhs, thesub, rate_prefix, t);
+}
+
+static void bfam_ts_mrab_start_comm_start(const bfam_long_real_t t,
+                                          void *user_data)
+{
+  bfam_ts_mrab_t *ts = user_data;
+  ts->hooks.comm_start(t, ts->hooks.user_data);
+}
+
+static void bfam_ts_mrab_start_comm_finish(const bfam_long_real_t t,
+                                           void *user_data)
+{
+  bfam_ts_mrab_t *ts = user_data;
+  ts->hooks.comm_finish(t, ts->hooks.user_data);
+}
+
+void bfam_ts_mrab_init(bfam_ts_mrab_t *ts, bfam_domain_t *dom, int order,
+                       int max_lvls, bfam_domain_cfl_t *cfl,
+                       bfam_domain_match_t subdom_match,
+                       const char **subdom_tags, const char **fields,
+                       const char *rate_prefix,
+                       const bfam_ts_mrab_hooks_t *hooks)
+{
+  BFAM_ABORT_IF(order < 1 || order > BFAM_TS_MRAB_MAX_ORDER,
+                "MRAB: order %d not supported", order);
+  BFAM_ABORT_IF(max_lvls < 1 || max_lvls > 30,
+                "MRAB: invalid number of levels %d", max_lvls);
+
+  ts->order = order;
+  ts->t = 0;
+  ts->hooks = *hooks;
+  snprintf(ts->rate_prefix, BFAM_BUFSIZ, "%s", rate_prefix);
+
+  ts->subs = bfam_malloc(BFAM_MAX(dom->num_subdomains, 1) *
+                         sizeof(bfam_subdomain_t *));
+  bfam_domain_get_subdomains(dom, subdom_match, subdom_tags,
+                             dom->num_subdomains, ts->subs, &ts->num_subs);
+
+  for (ts->num_fields = 0; fields && fields[ts->num_fields]; ++ts->num_fields)
+    ;
+
+  /*
+   * levels of the elements from their rates relative to the largest one
+   */
+  bfam_domain_cfl_flag(cfl);
+  const double max_rate = bfam_domain_cfl_rate(cfl);
+
+  bfam_locidx_t *cfl_sub =
+      bfam_malloc(BFAM_MAX(ts->num_subs, 1) * sizeof(bfam_locidx_t));
+  int loc_lvl = 0;
+  for (bfam_locidx_t s = 0; s < ts->num_subs; ++s)
+  {
+    cfl_sub[s] = bfam_ts_mrab_cfl_sub(ts, cfl, s);
+    if (ts->subs[s]->glue_m)
+      continue;
+    for (bfam_locidx_t k = 0; k < ((bfam_subdomain_dgx_t *)ts->subs[s])->K;
+         ++k)
+      loc_lvl = BFAM_MAX(loc_lvl, bfam_ts_mrab_elem_lvl(ts, cfl, s, cfl_sub[s],
+                                                        k, max_rate, max_lvls));
+  }
+  int glo_lvl;
+  BFAM_MPI_CHECK(
+      MPI_Allreduce(&loc_lvl, &glo_lvl, 1, MPI_INT, MPI_MAX, dom->comm));
+
+  ts->num_lvls = glo_lvl + 1;
+  const int L = ts->num_lvls;
+  BFAM_ROOT_LDEBUG("MRAB: %d rate levels, largest rate %e", L, max_rate);
+
+  /*
+   * sort the elements of each subdomain by level
+   */
+  bfam_locidx_t num_elems = 0;
+  for (bfam_locidx_t s = 0; s < ts->num_subs; ++s)
+    num_elems += ((bfam_subdomain_dgx_t *)ts->subs[s])->K;
+
+  ts->lvl_offset =
+      bfam_malloc(((size_t)ts->num_subs * (L + 1) + 1) * sizeof(bfam_locidx_t));
+  ts->lvl_elems = bfam_malloc(BFAM_MAX(num_elems, 1) * sizeof(bfam_locidx_t));
+
+  for (bfam_locidx_t s = 0, n = 0; s < ts->num_subs; ++s)
+  {
+    bfam_subdomain_dgx_t *sub = (bfam_subdomain_dgx_t *)ts->subs[s];
+    bfam_locidx_t *offset = ts->lvl_offset + (size_t)s * (L + 1);
+
+    for (int j = 0; j <= L; ++j)
+      offset[j] = 0;
+    for (bfam_locidx_t k = 0; k < sub->K; ++k)
+    {
+      const int j =
+          bfam_ts_mrab_elem_lvl(ts, cfl, s, cfl_sub[s], k, max_rate, L);
+      ++offset[j + 1];
+    }
+
+    offset[0] = n;
+    for (int j = 0; j < L; ++j)
+      offset[j + 1] += offset[j];
+
+    for (bfam_locidx_t k = 0; k < sub->K; ++k)
+    {
+      const int j =
+          bfam_ts_mrab_elem_lvl(ts, cfl, s, cfl_sub[s], k, max_rate, L);
+      ts->lvl_elems[offset[j]++] = k;
+    }
+
+    /* the fill shifted the offsets by one level */
+    for (int j = L; j > 0; --j)
+      offset[j] = offset[j - 1];
+    offset[0] = n;
+    n = offset[L];
+  }
+  bfam_free(cfl_sub);
+
+  ts->head = bfam_malloc(L * sizeof(int));
+  for (int j = 0; j < L; ++j)
+    /* the first stored rate goes to slot 0 */
+    ts->head[j] = order - 1;
+
+  /*
+   * weights of the fine steps r of level j, which takes 2^j fine steps
+   */
+  ts->coef = bfam_malloc(((size_t)1 << L) * order * sizeof(bfam_long_real_t));
+  for (int j = 0; j < L; ++j)
+  {
+    const int steps = 1 << j;
+    for (int r = 0; r < steps; ++r)
+    {
+      bfam_long_real_t *c = ts->coef + ((size_t)steps - 1 + r) * order;
+      bfam_ts_mrab_weights(order, (bfam_long_real_t)r / steps,
+                           (bfam_long_real_t)(r + 1) / steps, c);
+      for (int i = 0; i < order; ++i)
+        c[i] *= steps;
+    }
+  }
+
+  /*
+   * fields and rates
+   */
+  const size_t num_ptrs = BFAM_MAX((size_t)ts->num_subs * ts->num_fields, 1);
+  ts->q = bfam_malloc(num_ptrs * sizeof(bfam_real_t *));
+  ts->dq = bfam_malloc(order * num_ptrs * sizeof(bfam_real_t *));
+
+  char prefix[BFAM_BUFSIZ];
+  char name[BFAM_BUFSIZ];
+  for (bfam_locidx_t s = 0; s < ts->num_subs; ++s)
+  {
+    bfam_subdomain_dgx_t *sub = (bfam_subdomain_dgx_t *)ts->subs[s];
+
+    for (int i = 0; i < order; ++i)
+    {
+      bfam_ts_mrab_prefix(ts, i, prefix);
+      if (ts->hooks.aux_rates)
+        ts->hooks.aux_rates(ts->subs[s], prefix, ts->hooks.user_data);
+    }
+
+    for (int f = 0; f < ts->num_fields; ++f)
+    {
+      const size_t n = (size_t)s * ts->num_fields + f;
+      ts->q[n] = bfam_dictionary_get_value_ptr(&sub->base.fields, fields[f]);
+
+      for (int i = 0; i < order; ++i)
+      {
+        const size_t m = ((size_t)s * order + i) * ts->num_fields + f;
+        ts->dq[m] = NULL;
+        if (ts->q[n] == NULL)
+          continue;
+
+        bfam_ts_mrab_prefix(ts, i, prefix);
+        snprintf(name, BFAM_BUFSIZ, "%s%s", prefix, fields[f]);
+        ts->dq[m] = bfam_dictionary_get_value_ptr(&sub->base.fields, name);
+        BFAM_ABORT_IF(ts->dq[m] == NULL, "MRAB: rate %s not in subdomain %s",
+                      name, sub->base.name);
+        memset(ts->dq[m], 0, (size_t)sub->K * sub->Np * sizeof(bfam_real_t));
+      }
+    }
+  }
+
+  /*
+   * the starter steps all elements and uses the rates of the last slot,
+   * which only holds rates once the starter is done
+   */
+  ts->num_start = order - 1;
+  if (order > 1)
+  {
+    bfam_ts_lsrk_hooks_t start_hooks = {NULL, NULL, NULL, NULL, NULL, ts};
+    if (ts->hooks.intra_rhs)
+      start_hooks.intra_rhs = bfam_ts_mrab_start_intra_rhs;
+    if (ts->hooks.comm_start)
+      start_hooks.comm_start = bfam_ts_mrab_start_comm_start;
+    if (ts->hooks.comm_finish)
+      start_hooks.comm_finish = bfam_ts_mrab_start_comm_finish;
+    if (ts->hooks.inter_rhs)
+      start_hooks.inter_rhs = bfam_ts_mrab_start_inter_rhs;
+
+    bfam_ts_mrab_prefix(ts, order - 1, prefix);
+    bfam_ts_lsrk_init(&ts->starter, dom, BFAM_TS_LSRK_KC54, subdom_match,
+                      subdom_tags, fields, prefix, &start_hooks);
+  }
+}
+
+void bfam_ts_mrab_free(bfam_ts_mrab_t *ts)
+{
+  if (ts->order > 1)
+    bfam_ts_lsrk_free(&ts->starter);
+  bfam_free(ts->subs);
+  bfam_free(ts->q);
+  bfam_free(ts->dq);
+  bfam_free(ts->lvl_offset);
+  bfam_free(ts->lvl_elems);
+  bfam_free(ts->head);
+  bfam_free(ts->coef);
+  ts->num_subs = 0;
+  ts->num_fields = 0;
+  ts->num_lvls = 0;
+}
+
+/* call a rate hook for the levels first_due to num_due-1 */
+static void bfam_ts_mrab_rhs(bfam_ts_mrab_t *ts, bfam_ts_mrab_rhs_t rhs,
+                             const int first_due, const int num_due,
+                             const bfam_long_real_t t)
+{
+  char prefix[BFAM_BUFSIZ];
+  const int L = ts->num_lvls;
+
+  for (bfam_locidx_t s = 0; s < ts->num_subs; ++s)
+  {
+    const bfam_locidx_t *offset = ts->lvl_offset + (size_t)s * (L + 1);
+    for (int j = first_due; j < num_due; ++j)
+    {
+      const bfam_locidx_t num = offset[j + 1] - offset[j];
+      if (num == 0)
+        continue;
+      bfam_ts_mrab_prefix(ts, ts->head[j], prefix);
+      rhs(ts->subs[s], prefix, t, ts->lvl_elems + offset[j], num,
+          ts->hooks.user_data);
+    }
+  }
+}
+
+typedef struct
+{
+  bfam_ts_mrab_t *ts;
+  int first_due;         /* first level starting a step */
+  int num_due;           /* levels below num_due start a step */
+  int m;                 /* fine step within the coarse step */
+  bfam_long_real_t dt_f; /* fine step size */
+} bfam_ts_mrab_update_t;
+
+/*
+ * The chunks of the update passes are ranges of positions in the level order
+ * of the elements of a subdomain (every element is in one level); range of
+ * level j of subdomain s within positions k_begin to k_end - 1
+ */
+static void bfam_ts_mrab_chunk_level(const bfam_ts_mrab_t *ts,
+                                     const bfam_locidx_t s, const int j,
+                                     const bfam_locidx_t k_begin,
+                                     const bfam_locidx_t k_end,
+                                     bfam_locidx_t *e_begin,
+                                     bfam_locidx_t *e_end)
+{
+  const bfam_locidx_t *offset = ts->lvl_offset + (size_t)s * (ts->num_lvls + 1);
+  *e_begin = BFAM_MAX(offset[0] + k_begin, offset[j]);
+  *e_end = BFAM_MIN(offset[0] + k_end, offset[j + 1]);
+}
+
+static void bfam_ts_mrab_clear_chunk(bfam_subdomain_t *thesub, bfam_locidx_t s,
+                                     bfam_locidx_t k_begin, bfam_locidx_t k_end,
+                                     int thread, void *arg)
+{
+  const bfam_ts_mrab_update_t *u = arg;
+  const bfam_ts_mrab_t *ts = u->ts;
+  const int Np = ((bfam_subdomain_dgx_t *)thesub)->Np;
+  const int num_fields = ts->num_fields;
+
+  for (int j = u->first_due; j < u->num_due; ++j)
+  {
+    bfam_real_t **dq =
+        ts->dq + ((size_t)s * ts->order + ts->head[j]) * num_fields;
+    bfam_locidx_t e_begin, e_end;
+    bfam_ts_mrab_chunk_level(ts, s, j, k_begin, k_end, &e_begin, &e_end);
+    for (bfam_locidx_t e = e_begin; e < e_end; ++e)
+      for (int f = 0; f < num_fields; ++f)
+        if (dq[f])
+          memset(dq[f] + (size_t)ts->lvl_elems[e] * Np, 0,
+                 Np * sizeof(bfam_real_t));
+  }
+}
+
+static void bfam_ts_mrab_update_chunk(bfam_subdomain_t *thesub,
+                                      bfam_locidx_t s, bfam_locidx_t k_begin,
+                                      bfam_locidx_t k_end, int thread,
+                                      void *arg)
+{
+  const bfam_ts_mrab_update_t *u = arg;
+  const bfam_ts_mrab_t *ts = u->ts;
+  const int Np = ((bfam_subdomain_dgx_t *)thesub)->Np;
+  const int order = ts->order;
+  const int num_fields = ts->num_fields;
+  bfam_real_t **q = ts->q + (size_t)s * num_fields;
+
+  for (int j = 0; j < ts->num_lvls; ++j)
+  {
+    bfam_locidx_t e_begin, e_end;
+    bfam_ts_mrab_chunk_level(ts, s, j, k_begin, k_end, &e_begin, &e_end);
+    if (e_begin >= e_end)
+      continue;
+
+    /* rates of level j from newest to oldest and their coefficients */
+    const int steps = 1 << j;
+    const bfam_long_real_t *w =
+        ts->coef + ((size_t)steps - 1 + u->m % steps) * order;
+    bfam_real_t **dq[BFAM_TS_MRAB_MAX_ORDER];
+    bfam_real_t c[BFAM_TS_MRAB_MAX_ORDER];
+    for (int i = 0; i < order; ++i)
+    {
+      dq[i] = ts->dq +
+              ((size_t)s * order + (ts->head[j] - i + order) % order) *
+                  num_fields;
+      c[i] = (bfam_real_t)(u->dt_f * w[i]);
+    }
+
+    for (bfam_locidx_t e = e_begin; e < e_end; ++e)
+    {
+      const size_t o = (size_t)ts->lvl_elems[e] * Np;
+      for (int f = 0; f < num_fields; ++f)
+      {
+        if (q[f] == NULL)
+          continue;
+        bfam_real_t *restrict qk = q[f] + o;
+        for (int i = 0; i < order; ++i)
+        {
+          const bfam_real_t *restrict dqk = dq[i][f] + o;
+          for (int n = 0; n < Np; ++n)
+            qk[n] += c[i] * dqk[n];
+        }
+      }
+    }
+  }
+}
+
+void bfam_ts_mrab_step(bfam_ts_mrab_t *ts, const bfam_long_real_t dt)
+{
+  const bfam_ts_mrab_hooks_t *h = &ts->hooks;
+  const int L = ts->num_lvls;
+  const int order = ts->order;
+  const int num_sub_steps = 1 << (L - 1);
+  const bfam_long_real_t dt_f = dt / num_sub_steps;
+
+  const int start = ts->num_start > 0;
+  if (start)
+    --ts->num_start;
+
+  for (int m = 0; m < num_sub_steps; ++m)
+  {
+    const bfam_long_real_t t = ts->t + m * dt_f;
+
+    /* levels 0, ..., num_due-1 start a step at this time */
+    int num_due = 1;
+    while (num_due < L && m % (1 << num_due) == 0)
+      ++num_due;
+
+    /*
+     * the starter only stores the last order-1 rates of each level, in slots
+     * 0, ..., order-2, so levels that start more than order-1 more steps
+     * before the starter is done are skipped
+     */
+    int first_due = 0;
+    if (start)
+    {
+      const int left = (ts->num_start + 1) * num_sub_steps - m;
+      while (first_due < num_due && left > (order - 1) << first_due)
+        ++first_due;
+    }
+
+    for (int j = first_due; j < num_due; ++j)
+      ts->head[j] = (ts->head[j] + 1) % order;
+
+    bfam_ts_mrab_update_t u = {ts, first_due, num_due, m, dt_f};
+    if (first_due < num_due)
+    {
+      /* clear the rate slots about to be filled */
+      bfam_parallel_for_subdomains(ts->subs, ts->num_subs,
+                                   bfam_ts_mrab_clear_chunk, &u);
+
+      if (h->comm_start)
+        h->comm_start(t, h->user_data);
+
+      if (h->intra_rhs)
+        bfam_ts_mrab_rhs(ts, h->intra_rhs, first_due, num_due, t);
+
+      if (h->comm_finish)
+        h->comm_finish(t, h->user_data);
+
+      if (h->inter_rhs)
+        bfam_ts_mrab_rhs(ts, h->inter_rhs, first_due, num_due, t);
+    }
+
+    if (start)
+    {
+      ts->starter.t = t;
+      bfam_ts_lsrk_step(&ts->starter, dt_f);
+    }
+    else
+    {
+      /*
+       * advance every level to the next fine time with the Adams-Bashforth
+       * polynomial of its current step
+       */
+      bfam_parallel_for_subdomains(ts->subs, ts->num_subs,
+                                   bfam_ts_mrab_update_chunk, &u);
+    }
+  }
+
+  ts->t += dt;
+}
+// }}}
+
+// {{{ vtk
+
+#include <sc.h>
+#include <sc_io.h>
+
+#define BFAM_VTK_VTU_FORMAT "%s_%05d.vtu"
+#define BFAM_VTK_VTS_FORMAT "%s_%s_%s.vts"
+#define BFAM_VTK_PVTS_FORMAT "%s_%s.pvts"
+
+static void bfam_vtk_write_file_pvtu(int size, const char *directory,
+                                     const char *prefix, const char **scalars,
+                                     const char **vectors,
+                                     const char **components, int binary,
+                                     int compress)
+{
+  const int endian = bfam_endian();
+
   char filename[BFAM_BUFSIZ];
   snprintf(filename, BFAM_BUFSIZ, "%s.pvtu", prefix);
 
@@ -8325,6 +13937,367 @@ void bfam_vtk_write_file(bfam_domain_t *domain, bfam_domain_match_t match,
 
 // }}}
 
+// {{{ pio
+#define BFAM_PIO_FORMAT "%s.pio"
+#define BFAM_PIO_MAGIC "bfampio"
+#define BFAM_PIO_VERSION 2
+#define BFAM_PIO_BYTE_ORDER INT64_C(0x0102030405060708)
+#define BFAM_PIO_NUM_GRID 3
+
+static const char *bfam_pio_grid_names[BFAM_PIO_NUM_GRID] = {
+    "_grid_x0", "_grid_x1", "_grid_x2"};
+
+/* sections of the file start on multiples of 8 bytes */
+static int64_t bfam_pio_align(int64_t offset) { return (offset + 7) / 8 * 8; }
+
+/* node offsets of the corners of a linear cell in the VTK order */
+static const int bfam_pio_corner[8][3] = {{0, 0, 0}, {1, 0, 0}, {1, 1, 0},
+                                          {0, 1, 0}, {0, 0, 1}, {1, 0, 1},
+                                          {1, 1, 1}, {0, 1, 1}};
+
+/* number of cells and corners of the elements of a subdomain */
+static void bfam_pio_count_cells(const bfam_subdomain_dgx_t *sub,
+                                 int64_t *num_cells, int64_t *num_corners)
+{
+  int64_t cells = sub->K;
+  int64_t corners = 1;
+  for (int d = 0; d < sub->dim; ++d)
+  {
+    cells *= sub->N;
+    corners *= 2;
+  }
+  *num_cells = cells;
+  *num_corners = cells * corners;
+}
+
+/* fill the corners of the cells of a subdomain with the point numbers */
+static int64_t *bfam_pio_fill_corners(const bfam_subdomain_dgx_t *sub,
+                                      int64_t point_offset, int64_t *corners)
+{
+  const int N = sub->N;
+  const int Nq = N + 1;
+  const int num_corners = 1 << sub->dim;
+  const int n0 = (sub->dim > 0) ? N : 1;
+  const int n1 = (sub->dim > 1) ? N : 1;
+  const int n2 = (sub->dim > 2) ? N : 1;
+
+  for (bfam_locidx_t e = 0; e < sub->K; ++e)
+  {
+    const int64_t p = point_offset + (int64_t)e * sub->Np;
+    for (int k = 0; k < n2; ++k)
+      for (int j = 0; j < n1; ++j)
+        for (int i = 0; i < n0; ++i)
+          for (int c = 0; c < num_corners; ++c)
+            *corners++ = p + (i + bfam_pio_corner[c][0]) +
+                         Nq * ((j + bfam_pio_corner[c][1]) +
+                               Nq * (k + bfam_pio_corner[c][2]));
+  }
+
+  return corners;
+}
+
+void bfam_pio_write_file(bfam_domain_t *domain, bfam_domain_match_t match,
+                         const char **tags, const char *directory,
+                         const char *prefix, bfam_real_t time,
+                         const char **fields)
+{
+  int rank;
+  BFAM_MPI_CHECK(MPI_Comm_rank(domain->comm, &rank));
+
+  bfam_subdomain_t **subdomains =
+      bfam_malloc(BFAM_MAX(domain->num_subdomains, 1) *
+                  sizeof(bfam_subdomain_t *));
+  bfam_locidx_t num_subdomains;
+  bfam_domain_get_subdomains(domain, match, tags, domain->num_subdomains,
+                             subdomains, &num_subdomains);
+
+  int num_fields = BFAM_PIO_NUM_GRID;
+  int64_t names_size = 0;
+  for (int f = 0; f < BFAM_PIO_NUM_GRID; ++f)
+    names_size += (int64_t)strlen(bfam_pio_grid_names[f]) + 1;
+  for (int f = 0; fields && fields[f]; ++f, ++num_fields)
+    names_size += (int64_t)strlen(fields[f]) + 1;
+
+  /* offsets of the pieces, points, cells, and corners of this rank */
+  int64_t local[4] = {num_subdomains, 0, 0, 0};
+  for (bfam_locidx_t s = 0; s < num_subdomains; ++s)
+  {
+    bfam_subdomain_dgx_t *sub = (bfam_subdomain_dgx_t *)subdomains[s];
+    int64_t num_cells, num_corners;
+    bfam_pio_count_cells(sub, &num_cells, &num_corners);
+    local[1] += (int64_t)sub->K * sub->Np;
+    local[2] += num_cells;
+    local[3] += num_corners;
+  }
+  int64_t offset[4] = {0, 0, 0, 0};
+  int64_t total[4];
+  BFAM_MPI_CHECK(
+      MPI_Exscan(local, offset, 4, MPI_INT64_T, MPI_SUM, domain->comm));
+  if (rank == 0)
+    offset[0] = offset[1] = offset[2] = offset[3] = 0;
+  BFAM_MPI_CHECK(
+      MPI_Allreduce(local, total, 4, MPI_INT64_T, MPI_SUM, domain->comm));
+
+  bfam_pio_header_t header;
+  memset(&header, 0, sizeof(bfam_pio_header_t));
+  strncpy(header.magic, BFAM_PIO_MAGIC, sizeof(header.magic));
+  header.version = BFAM_PIO_VERSION;
+  header.byte_order = BFAM_PIO_BYTE_ORDER;
+  header.real_size = sizeof(bfam_real_t);
+  header.num_fields = num_fields;
+  header.num_pieces = total[0];
+  header.num_points = total[1];
+  header.num_cells = total[2];
+  header.num_corners = total[3];
+  header.time = time;
+  header.names_offset = sizeof(bfam_pio_header_t);
+  header.index_offset = bfam_pio_align(header.names_offset + names_size);
+  header.cells_offset = bfam_pio_align(header.index_offset +
+                                       total[0] * sizeof(bfam_pio_piece_t));
+  header.data_offset =
+      bfam_pio_align(header.cells_offset + total[3] * sizeof(int64_t));
+
+  BFAM_ABORT_IF(local[1] * sizeof(bfam_real_t) > INT_MAX,
+                "Too many points on rank %d for pio: %jd", rank,
+                (intmax_t)local[1]);
+  BFAM_ABORT_IF(local[3] * sizeof(int64_t) > INT_MAX,
+                "Too many cell corners on rank %d for pio: %jd", rank,
+                (intmax_t)local[3]);
+
+  char filename[BFAM_BUFSIZ];
+  if (directory)
+    snprintf(filename, BFAM_BUFSIZ, "%s/" BFAM_PIO_FORMAT, directory, prefix);
+  else
+    snprintf(filename, BFAM_BUFSIZ, BFAM_PIO_FORMAT, prefix);
+
+  BFAM_VERBOSE("Writing file: '%s'", filename);
+  MPI_File fh;
+  BFAM_MPI_CHECK(MPI_File_open(domain->comm, filename,
+                               MPI_MODE_CREATE | MPI_MODE_WRONLY,
+                               MPI_INFO_NULL, &fh));
+  BFAM_MPI_CHECK(MPI_File_set_size(fh, 0));
+
+  if (rank == 0)
+  {
+    char *names = bfam_malloc(names_size);
+    char *name = names;
+    for (int f = 0; f < num_fields; ++f)
+    {
+      const char *n = (f < BFAM_PIO_NUM_GRID)
+                          ? bfam_pio_grid_names[f]
+                          : fields[f - BFAM_PIO_NUM_GRID];
+      strcpy(name, n);
+      name += strlen(n) + 1;
+    }
+
+    BFAM_MPI_CHECK(MPI_File_write_at(fh, 0, &header, sizeof(bfam_pio_header_t),
+                                     MPI_BYTE, MPI_STATUS_IGNORE));
+    BFAM_MPI_CHECK(MPI_File_write_at(fh, header.names_offset, names,
+                                     (int)names_size, MPI_BYTE,
+                                     MPI_STATUS_IGNORE));
+    bfam_free(names);
+  }
+
+  /* index */
+  bfam_pio_piece_t *pieces =
+      bfam_malloc(BFAM_MAX(num_subdomains, 1) * sizeof(bfam_pio_piece_t));
+  int64_t *corners = bfam_malloc_aligned(BFAM_MAX(local[3], 1) *
+                                         sizeof(int64_t));
+  int64_t *corner = corners;
+  int64_t point_offset = offset[1];
+  int64_t cell_offset = offset[2];
+  int64_t corner_offset = offset[3];
+  for (bfam_locidx_t s = 0; s < num_subdomains; ++s)
+  {
+    bfam_subdomain_dgx_t *sub = (bfam_subdomain_dgx_t *)subdomains[s];
+    int64_t num_cells, num_corners;
+    bfam_pio_count_cells(sub, &num_cells, &num_corners);
+    pieces[s].rank = rank;
+    pieces[s].id = sub->base.id;
+    pieces[s].uid = sub->base.uid;
+    pieces[s].dim = sub->dim;
+    pieces[s].N = sub->N;
+    pieces[s].K = sub->K;
+    pieces[s].point_offset = point_offset;
+    pieces[s].cell_offset = cell_offset;
+    pieces[s].corner_offset = corner_offset;
+    corner = bfam_pio_fill_corners(sub, point_offset, corner);
+    point_offset += (int64_t)sub->K * sub->Np;
+    cell_offset += num_cells;
+    corner_offset += num_corners;
+  }
+  BFAM_MPI_CHECK(MPI_File_write_at_all(
+      fh, header.index_offset + offset[0] * sizeof(bfam_pio_piece_t), pieces,
+      (int)(num_subdomains * sizeof(bfam_pio_piece_t)), MPI_BYTE,
+      MPI_STATUS_IGNORE));
+  bfam_free(pieces);
+
+  /* cells */
+  BFAM_MPI_CHECK(MPI_File_write_at_all(
+      fh, header.cells_offset + offset[3] * sizeof(int64_t), corners,
+      (int)(local[3] * sizeof(int64_t)), MPI_BYTE, MPI_STATUS_IGNORE));
+  bfam_free_aligned(corners);
+
+  /* fields, each as one array over all the ranks */
+  bfam_real_t *buf =
+      bfam_malloc_aligned(BFAM_MAX(local[1], 1) * sizeof(bfam_real_t));
+
+  for (int f = 0; f < num_fields; ++f)
+  {
+    const int grid = f < BFAM_PIO_NUM_GRID;
+    const char *name =
+        grid ? bfam_pio_grid_names[f] : fields[f - BFAM_PIO_NUM_GRID];
+
+    bfam_real_t *b = buf;
+    for (bfam_locidx_t s = 0; s < num_subdomains; ++s)
+    {
+      bfam_subdomain_dgx_t *sub = (bfam_subdomain_dgx_t *)subdomains[s];
+      const size_t n = (size_t)sub->K * sub->Np;
+      bfam_real_t *field =
+          bfam_dictionary_get_value_ptr(&sub->base.fields, name);
+      BFAM_ABORT_IF(field == NULL && !grid, "PIO: Field %s not in subdomain %s",
+                    name, sub->base.name);
+      if (field)
+        memcpy(b, field, n * sizeof(bfam_real_t));
+      else
+        for (size_t i = 0; i < n; ++i)
+          b[i] = 0;
+      b += n;
+    }
+
+    BFAM_MPI_CHECK(MPI_File_write_at_all(
+        fh, header.data_offset +
+                (f * header.num_points + offset[1]) * sizeof(bfam_real_t),
+        buf, (int)(local[1] * sizeof(bfam_real_t)), MPI_BYTE,
+        MPI_STATUS_IGNORE));
+  }
+
+  bfam_free_aligned(buf);
+  BFAM_MPI_CHECK(MPI_File_close(&fh));
+  bfam_free(subdomains);
+}
+
+void bfam_pio_open(bfam_pio_file_t *file, MPI_Comm comm, const char *filename)
+{
+  int rank;
+  BFAM_MPI_CHECK(MPI_Comm_rank(comm, &rank));
+
+  BFAM_MPI_CHECK(MPI_File_open(comm, filename, MPI_MODE_RDONLY, MPI_INFO_NULL,
+                               &file->fh));
+
+  bfam_pio_header_t *header = &file->header;
+  if (rank == 0)
+    BFAM_MPI_CHECK(MPI_File_read_at(file->fh, 0, header,
+                                    sizeof(bfam_pio_header_t), MPI_BYTE,
+                                    MPI_STATUS_IGNORE));
+  BFAM_MPI_CHECK(
+      MPI_Bcast(header, sizeof(bfam_pio_header_t), MPI_BYTE, 0, comm));
+
+  BFAM_ABORT_IF(strncmp(header->magic, BFAM_PIO_MAGIC, sizeof(header->magic)),
+                "%s is not a pio file", filename);
+  BFAM_ABORT_IF(header->byte_order != BFAM_PIO_BYTE_ORDER,
+                "%s was written with a different byte order", filename);
+  BFAM_ABORT_IF(header->version != BFAM_PIO_VERSION,
+                "%s has unknown pio version %jd", filename,
+                (intmax_t)header->version);
+  BFAM_ABORT_IF(header->real_size != sizeof(float) &&
+                    header->real_size != sizeof(double),
+                "%s has unknown real size %jd", filename,
+                (intmax_t)header->real_size);
+
+  const int names_size = (int)(header->index_offset - header->names_offset);
+  file->names = bfam_malloc(names_size);
+  const int index_size = (int)(header->num_pieces * sizeof(bfam_pio_piece_t));
+  file->pieces = bfam_malloc(BFAM_MAX(index_size, 1));
+  if (rank == 0)
+  {
+    BFAM_MPI_CHECK(MPI_File_read_at(file->fh, header->names_offset,
+                                    file->names, names_size, MPI_BYTE,
+                                    MPI_STATUS_IGNORE));
+    BFAM_MPI_CHECK(MPI_File_read_at(file->fh, header->index_offset,
+                                    file->pieces, index_size, MPI_BYTE,
+                                    MPI_STATUS_IGNORE));
+  }
+  BFAM_MPI_CHECK(MPI_Bcast(file->names, names_size, MPI_BYTE, 0, comm));
+  BFAM_MPI_CHECK(MPI_Bcast(file->pieces, index_size, MPI_BYTE, 0, comm));
+
+  file->field_names = bfam_malloc(header->num_fields * sizeof(const char *));
+  const char *name = file->names;
+  for (int64_t f = 0; f < header->num_fields; ++f)
+  {
+    file->field_names[f] = name;
+    name += strlen(name) + 1;
+  }
+}
+
+void bfam_pio_close(bfam_pio_file_t *file)
+{
+  BFAM_MPI_CHECK(MPI_File_close(&file->fh));
+  bfam_free(file->names);
+  bfam_free(file->field_names);
+  bfam_free(file->pieces);
+}
+
+int bfam_pio_field(const bfam_pio_file_t *file, const char *name)
+{
+  for (int f = 0; f < file->header.num_fields; ++f)
+    if (0 == strcmp(file->field_names[f], name))
+      return f;
+  return -1;
+}
+
+void bfam_pio_read(bfam_pio_file_t *file, int field, int64_t first,
+                   int64_t count, bfam_real_t *data)
+{
+  const bfam_pio_header_t *header = &file->header;
+  BFAM_ABORT_IF(field < 0 || field >= header->num_fields,
+                "PIO: no field %d", field);
+  BFAM_ABORT_IF(first < 0 || count < 0 || first + count > header->num_points,
+                "PIO: points %jd to %jd out of range", (intmax_t)first,
+                (intmax_t)(first + count));
+  BFAM_ABORT_IF(count * header->real_size > INT_MAX,
+                "PIO: too many points to read: %jd", (intmax_t)count);
+
+  const MPI_Offset offset =
+      header->data_offset +
+      (field * header->num_points + first) * header->real_size;
+  const int size = (int)(count * header->real_size);
+
+  if (header->real_size == sizeof(bfam_real_t))
+  {
+    BFAM_MPI_CHECK(MPI_File_read_at(file->fh, offset, data, size, MPI_BYTE,
+                                    MPI_STATUS_IGNORE));
+    return;
+  }
+
+  void *buf = bfam_malloc_aligned(BFAM_MAX(size, 1));
+  BFAM_MPI_CHECK(MPI_File_read_at(file->fh, offset, buf, size, MPI_BYTE,
+                                  MPI_STATUS_IGNORE));
+  if (header->real_size == sizeof(float))
+    for (int64_t i = 0; i < count; ++i)
+      data[i] = (bfam_real_t)((float *)buf)[i];
+  else
+    for (int64_t i = 0; i < count; ++i)
+      data[i] = (bfam_real_t)((double *)buf)[i];
+  bfam_free_aligned(buf);
+}
+
+void bfam_pio_read_corners(bfam_pio_file_t *file, int64_t first, int64_t count,
+                           int64_t *corners)
+{
+  const bfam_pio_header_t *header = &file->header;
+  BFAM_ABORT_IF(first < 0 || count < 0 || first + count > header->num_corners,
+                "PIO: corners %jd to %jd out of range", (intmax_t)first,
+                (intmax_t)(first + count));
+  BFAM_ABORT_IF(count * sizeof(int64_t) > INT_MAX,
+                "PIO: too many corners to read: %jd", (intmax_t)count);
+
+  BFAM_MPI_CHECK(MPI_File_read_at(
+      file->fh, header->cells_offset + first * sizeof(int64_t), corners,
+      (int)(count * sizeof(int64_t)), MPI_BYTE, MPI_STATUS_IGNORE));
+}
+// }}}
+
 // {{{ pcg32
 // *Really* minimal PCG32 code / (c) 2014 M.E. O'Neill / pcg-random.org
 // Licensed under Apache License 2.0 (NO WARRANTY, etc. see website)
@@ -8900,20 +14873,16 @@ void bfamo_add_statisitics(bfam_domain_t *domain,
 /* TODO: Move all these calls to the communicator */
 void bfamo_communicator_post_send(bfam_communicator_t *comm)
 {
-  for (int p = 0; p < comm->num_procs; p++)
-    BFAM_MPI_CHECK(MPI_Isend(comm->proc_data[p].send_buf,
-                             (int)comm->proc_data[p].send_sz, MPI_BYTE,
-                             comm->proc_data[p].rank, comm->tag, comm->comm,
-                             &comm->send_request[p]));
+  BFAM_PRAGMA_OMP(parallel for schedule(dynamic, 1) if (comm->thread_multiple))
+  for (bfam_locidx_t p = 0; p < comm->num_procs; p++)
+    bfam_communicator_post_send(comm, p);
 }
 
 void bfamo_communicator_post_recv(bfam_communicator_t *comm)
 {
-  for (int p = 0; p < comm->num_procs; p++)
-    BFAM_MPI_CHECK(MPI_Irecv(comm->proc_data[p].recv_buf,
-                             (int)comm->proc_data[p].recv_sz, MPI_BYTE,
-                             comm->proc_data[p].rank, comm->tag, comm->comm,
-                             &comm->recv_request[p]));
+  BFAM_PRAGMA_OMP(parallel for schedule(dynamic, 1) if (comm->thread_multiple))
+  for (bfam_locidx_t p = 0; p < comm->num_procs; p++)
+    bfam_communicator_post_recv(comm, p);
 }
 
 void bfamo_communicator_send_wait(bfam_communicator_t *comm)
@@ -8980,7 +14949,8 @@ int bfamo_weight_fn(p4est_t *p4est, p4est_topidx_t which_tree,
 #error "Bad Dimension"
 #endif
 
-  /* TODO may need to adjust weight for multiple physics */
+  /* For multiple physics and glue use the measured weights of
+   * bfam_domain_pxest_cost_partition */
 
   return Np;
 }
@@ -121,6 +121,18 @@
 #define BFAM_ASM_COMMENT(X)
 #endif
 
+/*
+ * OpenMP pragmas which are dropped when not compiling with OpenMP, e.g.,
+ *   BFAM_PRAGMA_OMP(parallel for schedule(static))
+ */
+#define BFAM_STRINGIFY(...) #__VA_ARGS__
+#ifdef _OPENMP
+#include <omp.h>
+#define BFAM_PRAGMA_OMP(...) _Pragma(BFAM_STRINGIFY(omp __VA_ARGS__))
+#else
+#define BFAM_PRAGMA_OMP(...)
+#endif
+
 #ifndef BFAM_NORETURN
 #if defined(__clang__)
 #if __has_feature(attribute_analyzer_noreturn)
@@ -184,6 +196,35 @@ typedef double bfam_long_real_t;
                  BFAM_LONG_REAL_EPS *BFAM_LONG_REAL_EPS)
 
 /* Type for runtime computations */
+#ifdef BFAM_USE_FLOAT
+typedef float bfam_real_t;
+#define bfam_real_nan nanf
+#define BFAM_REAL_MPI MPI_FLOAT
+#define BFAM_REAL(x) BFAM_APPEND(x, f)
+#define BFAM_REAL_PRIe "e"
+#define BFAM_REAL_PRIf "f"
+#define BFAM_REAL_PRIg "g"
+
+#define BFAM_REAL_NAN(x) nanf(x)
+
+#define BFAM_REAL_ABS fabsf
+#define BFAM_REAL_ISFINITE isfinite
+#define BFAM_REAL_SQRT sqrtf
+#define BFAM_REAL_EXP expf
+#define BFAM_REAL_LOG logf
+#define BFAM_REAL_COS cosf
+#define BFAM_REAL_SIN sinf
+#define BFAM_REAL_ASINH asinhf
+#define BFAM_REAL_HYPOT hypotf
+#define BFAM_REAL_HYPOT3(x, y, z) hypotf((x), hypotf((y), (z)))
+
+#define BFAM_REAL_EPS FLT_EPSILON
+#define BFAM_REAL_MIN FLT_MIN
+#define BFAM_REAL_MAX FLT_MAX
+
+#define BFAM_REAL_VTK "Float32"
+#define BFAM_REAL_FMTe "15.8e"
+#else
 typedef double bfam_real_t;
 #define bfam_real_nan nan
 #define BFAM_REAL_MPI MPI_DOUBLE
@@ -198,6 +239,7 @@ typedef double bfam_real_t;
 #define BFAM_REAL_ISFINITE isfinite
 #define BFAM_REAL_SQRT sqrt
 #define BFAM_REAL_EXP exp
+#define BFAM_REAL_LOG log
 #define BFAM_REAL_COS cos
 #define BFAM_REAL_SIN sin
 #define BFAM_REAL_ASINH asinh
@@ -210,6 +252,12 @@ typedef double bfam_real_t;
 
 #define BFAM_REAL_VTK "Float64"
 #define BFAM_REAL_FMTe "24.16e"
+#endif
+
+/* Type for metric terms, kept in double precision even if bfam_real_t is
+ * float */
+typedef double bfam_metric_real_t;
+#define BFAM_METRIC_REAL_MPI MPI_DOUBLE
 
 #define BFAM_REAL_APPROX_EQ(x, y, K)                                           \
   BFAM_APPROX_EQ((x), (y), (K), BFAM_REAL_ABS, BFAM_REAL_EPS, BFAM_REAL_EPS)
@@ -319,6 +367,91 @@ void *bfam_malloc_aligned(size_t size);
  */
 void bfam_free_aligned(void *ptr);
 
+/** Bump allocator for scratch memory.
+ *
+ * Allocations are cut from one cache line aligned buffer and are all freed
+ * at once by going back to a mark. An allocation that does not fit is
+ * spilled to \c bfam_malloc_aligned(), and the buffer is grown to the high
+ * water mark the next time the arena is empty, so after the first use the
+ * arena does not touch the heap.
+ */
+typedef struct bfam_arena
+{
+  char *buf;          /**< buffer (\c NULL until first used) */
+  size_t size;        /**< size of \a buf */
+  size_t used;        /**< bytes of \a buf in use */
+  size_t top;         /**< bytes in use including the spills */
+  size_t high;        /**< high water mark of \a top */
+  void **spill;       /**< allocations which did not fit in \a buf */
+  size_t *spill_mark; /**< \a top when each spill was made */
+  int num_spill;
+  int max_spill;
+} bfam_arena_t;
+
+/** Initialize an empty arena.
+ *
+ * \param[out] arena arena to initialize
+ */
+void bfam_arena_init(bfam_arena_t *arena);
+
+/** Free all the memory of an arena.
+ *
+ * \param[in,out] arena arena to free
+ */
+void bfam_arena_free(bfam_arena_t *arena);
+
+/** Allocate cache line aligned scratch memory from an arena.
+ *
+ * The memory is valid until the arena is released to a mark taken before
+ * this call.
+ *
+ * \param[in,out] arena arena to allocate from
+ * \param[in]     size  allocation size
+ *
+ * \return pointer to the allocated memory.
+ */
+void *bfam_arena_alloc(bfam_arena_t *arena, size_t size);
+
+/** Current position of an arena.
+ *
+ * \param[in] arena arena
+ *
+ * \return mark to pass to \c bfam_arena_release().
+ */
+size_t bfam_arena_mark(const bfam_arena_t *arena);
+
+/** Free all the allocations made from an arena since a mark was taken.
+ *
+ * \param[in,out] arena arena
+ * \param[in]     mark  mark from \c bfam_arena_mark()
+ */
+void bfam_arena_release(bfam_arena_t *arena, size_t mark);
+
+/** Scratch arena of the calling thread.
+ *
+ * Every thread gets its own arena the first time it calls this, so the
+ * threads of nested (or serialized inner) parallel regions each have their
+ * own. The buffer of an arena is allocated by the thread which uses it so
+ * that with pinned threads (\c OMP_PROC_BIND) it is placed in the memory
+ * near that thread. Callers take a mark and release to it before returning;
+ * \c bfam_parallel_for_subdomains() releases the arena after each chunk.
+ * The arenas keep their high water mark until \c bfam_scratch_free(), so they
+ * are meant for per-element kernel scratch; temporaries the size of a whole
+ * field (e.g., for I/O) should use \c bfam_malloc_aligned().
+ *
+ * \return the arena of the calling thread.
+ */
+bfam_arena_t *bfam_scratch_arena(void);
+
+/** Free the scratch arenas of all threads.
+ *
+ * This is registered with \c atexit when the first arena is made, and can
+ * be called earlier to return the memory; threads get new arenas on their
+ * next call to \c bfam_scratch_arena(). Must be called outside of parallel
+ * regions.
+ */
+void bfam_scratch_free(void);
+
 /** Set a signal handler which prints stack traces on terminating signals.
  */
 void bfam_signal_handler_set();
@@ -1020,9 +1153,31 @@ typedef struct bfam_communicator
   bfam_comm_subdata_t *sub_data;   /**< array of structure with subdomains
                                         specific information */
 
+  bfam_locidx_t *send_sub_offset; /**< subdomains sending to processor \a p
+                                       are \c send_subs[send_sub_offset[p]]
+                                       to \c send_subs[send_sub_offset[p+1]-1]
+                                       */
+  bfam_locidx_t *send_subs;       /**< subdomains in send buffer order */
+  bfam_locidx_t *recv_sub_offset; /**< same as \c send_sub_offset for the
+                                       receives */
+  bfam_locidx_t *recv_subs;       /**< subdomains in recv buffer order */
+
+  int thread_multiple; /**< each thread posts the sends and receives of its
+                            neighbors; set when MPI provides \c
+                            MPI_THREAD_MULTIPLE and can be cleared */
+
   void *user_args; /**< user custom data to pass through */
 } bfam_communicator_t;
 
+/**
+ * Fills the send buffer (\c sub_data[s].send_buf) or reads the receive
+ * buffer (\c sub_data[s].recv_buf) of subdomain \a s of a communicator; it
+ * is called from thread \a thread, and concurrently for different \a s
+ */
+typedef void (*bfam_communicator_buffer_t)(bfam_communicator_t *communicator,
+                                           bfam_locidx_t s, int thread,
+                                           void *arg);
+
 /** create a communicator
  *
  * \param [in] domain     domain to output to communicate
@@ -1051,6 +1206,174 @@ bfam_communicator_t *bfam_communicator_new(bfam_domain_t *domain,
  */
 void bfam_communicator_free(bfam_communicator_t *communicator);
 
+/** Pack the send buffers and start the communication
+ *
+ * The neighboring processors are divided among the OpenMP threads. With \c
+ * thread_multiple each thread posts the receive from a neighbor, packs the
+ * send buffers of the subdomains sending to it, and posts the send itself.
+ * Otherwise the threads pack and the master thread posts all the receives
+ * and sends.
+ *
+ * \param [in,out] communicator communicator
+ * \param [in]     pack         fills the send buffer of a subdomain (may be
+ *                              \c NULL when the buffers are already filled)
+ * \param [in]     arg          argument passed to \a pack
+ */
+void bfam_communicator_start(bfam_communicator_t *communicator,
+                             bfam_communicator_buffer_t pack, void *arg);
+
+/** Finish the communication and unpack the receive buffers
+ *
+ * With \c thread_multiple each thread waits on the receives from its share
+ * of the neighbors with \c MPI_Waitsome and unpacks them in the order they
+ * complete. Otherwise the master thread waits for all the receives and the
+ * threads unpack. In both cases \c recv_status[p] is the status of the
+ * receive from neighbor \c p. Returns when the sends have completed too.
+ *
+ * \param [in,out] communicator communicator
+ * \param [in]     unpack       reads the receive buffer of a subdomain (may
+ *                              be \c NULL)
+ * \param [in]     arg          argument passed to \a unpack
+ */
+void bfam_communicator_finish(bfam_communicator_t *communicator,
+                              bfam_communicator_buffer_t unpack, void *arg);
+
+// }}}
+
+// {{{ dag
+/**
+ * Task of a \c bfam_dag_t; \a index is the index given when the task was
+ * added
+ */
+typedef void (*bfam_dag_task_t)(void *arg, bfam_locidx_t index);
+
+/**
+ * node of a \c bfam_dag_t: either a task or the completion of an MPI request
+ */
+typedef struct bfam_dag_node
+{
+  bfam_dag_task_t task;  /**< task to run (\c NULL for a request node) */
+  void *arg;             /**< argument passed to \a task */
+  bfam_locidx_t index;   /**< index passed to \a task */
+  MPI_Request *request;  /**< request completing the node */
+  bfam_locidx_t pending; /**< number of unfinished dependencies */
+} bfam_dag_node_t;
+
+/**
+ * dependency graph of tasks and MPI requests
+ *
+ * The graph is run on the calling thread (the tasks themselves can be
+ * threaded). Of the nodes whose dependencies have finished the one added
+ * first is run first, and the requests are tested between tasks so that the
+ * work depending on a message starts as soon as it arrives.
+ */
+typedef struct bfam_dag
+{
+  bfam_dag_node_t *nodes;
+  bfam_locidx_t num_nodes;
+  bfam_locidx_t max_nodes;
+
+  bfam_locidx_t *edges; /**< pairs (before, after) */
+  bfam_locidx_t num_edges;
+  bfam_locidx_t max_edges;
+} bfam_dag_t;
+
+/** Initialize an empty graph
+ *
+ * \param [out] dag graph
+ */
+void bfam_dag_init(bfam_dag_t *dag);
+
+/** Free a graph
+ *
+ * \param [in,out] dag graph
+ */
+void bfam_dag_free(bfam_dag_t *dag);
+
+/** Remove all the nodes of a graph, keeping its memory
+ *
+ * \param [in,out] dag graph
+ */
+void bfam_dag_clear(bfam_dag_t *dag);
+
+/** Add a task to a graph
+ *
+ * \param [in,out] dag   graph
+ * \param [in]     task  task
+ * \param [in]     arg   argument passed to \a task
+ * \param [in]     index index passed to \a task
+ *
+ * \return the node number of the task
+ */
+bfam_locidx_t bfam_dag_add_task(bfam_dag_t *dag, bfam_dag_task_t task,
+                                void *arg, bfam_locidx_t index);
+
+/** Add a node which finishes when an MPI request completes
+ *
+ * The request is read when the dependencies of the node have finished, so
+ * it can be posted by one of them; it is set to \c MPI_REQUEST_NULL when it
+ * completes.
+ *
+ * \param [in,out] dag     graph
+ * \param [in]     request request
+ *
+ * \return the node number of the request
+ */
+bfam_locidx_t bfam_dag_add_request(bfam_dag_t *dag, MPI_Request *request);
+
+/** Add a dependency: node \a after starts once node \a before is finished
+ *
+ * \param [in,out] dag    graph
+ * \param [in]     before node number
+ * \param [in]     after  node number
+ */
+void bfam_dag_add_dependency(bfam_dag_t *dag, bfam_locidx_t before,
+                             bfam_locidx_t after);
+
+/** Run all the nodes of a graph
+ *
+ * \param [in,out] dag graph
+ */
+void bfam_dag_run(bfam_dag_t *dag);
+
+/**
+ * one stage of a time stepper as tasks around a communicator
+ */
+typedef struct bfam_communicator_stage
+{
+  bfam_communicator_buffer_t pack;    /**< fill the send buffer of a
+                                           subdomain (may be \c NULL) */
+  bfam_communicator_buffer_t unpack;  /**< read the receive buffer of a
+                                           subdomain (may be \c NULL) */
+  bfam_communicator_buffer_t surface; /**< flux on a subdomain of the
+                                           communicator once its data has
+                                           been unpacked (may be \c NULL) */
+  bfam_dag_task_t interior;           /**< work not needing communication,
+                                           called with index 0 to
+                                           \c num_interior - 1 */
+  bfam_locidx_t num_interior;         /**< number of \c interior tasks */
+  bfam_dag_task_t update;             /**< update after all the fluxes
+                                           (may be \c NULL) */
+  void *arg;                          /**< argument of the hooks */
+} bfam_communicator_stage_t;
+
+/** Run one stage of a time stepper around a communicator
+ *
+ * The stage is run as a \c bfam_dag_t: all the receives are posted, then
+ * for each neighbor the send buffers are packed and the send posted. The
+ * interior tasks run while the messages are in flight; when the message of
+ * a neighbor arrives its subdomains are unpacked and their surface fluxes
+ * computed before the next interior task. The update runs after the
+ * interior and all the surface fluxes, and this returns once the sends have
+ * completed.
+ *
+ * \param [in,out] communicator communicator
+ * \param [in]     stage        hooks of the stage
+ * \param [in,out] dag          graph to build the stage in (cleared first)
+ */
+void bfam_communicator_stage_run(bfam_communicator_t *communicator,
+                                 const bfam_communicator_stage_t *stage,
+                                 bfam_dag_t *dag);
 // }}}
 
 // {{{ domain pxest
@@ -1108,6 +1431,16 @@ typedef struct
 #endif
 } bfam_pxest_user_data_t;
 
+/**
+ * ordering of the elements within the dgx subdomains
+ */
+typedef enum bfam_pxest_elem_order {
+  BFAM_PXEST_ELEM_ORDER_SPLIT, /**< order the quadrants are visited in during
+                                    the split (Morton order within trees) */
+  BFAM_PXEST_ELEM_ORDER_RCM,   /**< reverse Cuthill-McKee ordering of the
+                                    subdomain element connectivity */
+} bfam_pxest_elem_order_t;
+
 /**
  * structure containing a domain managed by p4est
  */
@@ -1118,20 +1451,44 @@ typedef struct bfam_domain_pxest
   p4est_connectivity_t *conn; /** connectivity for p4est */
   p4est_t *pxest;             /** forest of quadtrees */
   bfam_dictionary_t *dgx_ops; /** Dictionary of dgx operators operators */
+  bfam_pxest_elem_order_t elem_order; /** element ordering used when the
+                                          subdomains are split */
+  MPI_Comm ops_comm; /** node communicator of the shared operator tables */
+  MPI_Win ops_win;   /** shared memory window of the operator tables */
+  char *ops_base;    /** start of the shared operator tables */
+  size_t ops_size;   /** size of the shared operator tables */
 } bfam_domain_pxest_t;
 
+/*
+ * Refined and coarsened quadrants may differ from their source by more than
+ * one level. The position of a fine quadrant inside of its coarse ancestor L
+ * levels up is stored as a path of child ids c_1 (child of the ancestor) to
+ * c_L (child id of the fine quadrant itself):
+ *
+ *   path = sum_{i=1}^{L} c_i << (P4EST_DIM * (L - i))
+ *
+ * For a single level of adaptation the path is just the child id.
+ */
 typedef struct
 {
   uint8_t *dst_to_adapt_flags;
   int8_t *dst_to_dst_chld_id;
   bfam_locidx_t *dst_to_src_subd_id;
   bfam_locidx_t *dst_to_src_elem_id;
+  int8_t *dst_to_src_lvl_diff; /* levels dst is refined from src */
+  uint64_t *dst_to_src_path;   /* path of the refined dst in src */
   bfam_locidx_t num_dst;
 
+  /* coarsened dst quadrant n gets data from the src quadrants
+   * coarse_dst_to_src_offset[n] to coarse_dst_to_src_offset[n+1]-1 */
+  bfam_locidx_t *coarse_dst_to_src_offset;
   int8_t *coarse_dst_to_src_chld_id;
   bfam_locidx_t *coarse_dst_to_src_subd_id;
   bfam_locidx_t *coarse_dst_to_src_elem_id;
+  int8_t *coarse_dst_to_src_lvl_diff; /* levels src is coarsened to dst */
+  uint64_t *coarse_dst_to_src_path;   /* path of the src in coarsened dst */
   bfam_locidx_t num_coarse_dst;
+  bfam_locidx_t num_coarse_src;
 } bfam_domain_pxest_transfer_maps_t;
 
 /** create a pxest managed domain
@@ -1160,12 +1517,64 @@ bfam_domain_pxest_t *bfam_domain_pxest_new_ext(MPI_Comm domComm,
 /** Clean up domain
  *
  * frees any memory allocated by the domain and calls free command on all
- * subdomains
+ * subdomains; collective over the ranks of a node if the operator tables are
+ * shared
  *
  * \param [in,out] domain domain to clean up
  */
 void bfam_domain_pxest_free(bfam_domain_pxest_t *domain);
 
+/** Share the dgx operator tables between the ranks of a node
+ *
+ * The 1D operators (\c lr_N, \c lV_N, \c Dr_N, ...) of the orders
+ * \a N_min to \a N_max and the interpolators between all pairs of these
+ * orders are stored once per node in a read-only MPI-3 shared memory window;
+ * the \c dgx_ops and \c N2N dictionaries of every rank point into the
+ * window. Tables of other orders
+ * are still created per rank when needed.
+ *
+ * The tables are computed once on rank 0 of the domain and sent to the other
+ * nodes. If \a filename is given they are read from this versioned binary
+ * cache instead, and the file is (re)written when it is missing or does not
+ * match the orders, the precision, or the version of the layout.
+ *
+ * This is collective over the domain communicator and has to be called
+ * before any subdomain of these orders is created, e.g., right after the
+ * domain is created.
+ *
+ * \param [in,out] domain   domain to share the tables of
+ * \param [in]     N_min    smallest order to share
+ * \param [in]     N_max    largest order to share
+ * \param [in]     filename operator cache file (or \c NULL)
+ */
+void bfam_domain_pxest_share_ops(bfam_domain_pxest_t *domain, int N_min,
+                                 int N_max, const char *filename);
+
+/** Precompute the dgx operator tables of a range of orders
+ *
+ * Like \c bfam_domain_pxest_share_ops but every rank keeps a private copy;
+ * the tables are computed (or read from \a filename) on rank 0 only and
+ * broadcast.
+ *
+ * \param [in,out] domain   domain to precompute the tables of
+ * \param [in]     N_min    smallest order to precompute
+ * \param [in]     N_max    largest order to precompute
+ * \param [in]     filename operator cache file (or \c NULL)
+ */
+void bfam_domain_pxest_load_ops(bfam_domain_pxest_t *domain, int N_min,
+                                int N_max, const char *filename);
+
+/** Autotune the Kronecker product kernels of the orders in a domain
+ *
+ * Calls \c bfam_kron_autotune with the orders of the dgx subdomains on any
+ * rank of the domain and points the subdomains to the tuned kernels.
+ *
+ * \param [in,out] domain   domain to tune the kernels of
+ * \param [in]     filename tuning cache file (or \c NULL)
+ */
+void bfam_domain_pxest_kron_autotune(bfam_domain_pxest_t *domain,
+                                     const char *filename);
+
 /** Fill a \c glueID based on tree ids.
  *
  * This fills a \c glueID array for the quadrants based on glue ids given for
@@ -1248,6 +1657,9 @@ void bfam_domain_pxest_compute_split(p4est_t *pxest, uint8_t pflags,
 void bfam_domain_pxest_mark_elements(bfam_domain_pxest_t *domain);
 
 /** Generate mesh transfer maps
+ *
+ * The source and destination forests must have the same local trees, but
+ * quadrants may be refined or coarsened any number of levels.
  *
  * \param [in,out] maps     pointer to the transfer maps to be filled
  * \param [in] domain_dst   destination domain
@@ -1264,6 +1676,29 @@ void bfam_domain_pxest_transfer_maps_init(
 void bfam_domain_pxest_transfer_maps_free(
     bfam_domain_pxest_transfer_maps_t *maps);
 
+/** Transfer volume fields from one mesh to another
+ *
+ * The destination elements are grouped by source subdomain, destination
+ * subdomain, and adaptation type so that the projection operators are applied
+ * to a batch of elements and fields at once with sum factorization. Elements
+ * refined or coarsened by more than one level use the composition of the
+ * single level projections.
+ *
+ * \param [in,out] domain_dst destination domain; the fields must already be
+ *                            added to its volume subdomains
+ * \param [in]     domain_src source domain
+ * \param [in]     maps       transfer maps from \a domain_src to
+ *                            \a domain_dst
+ * \param [in]     fields     \c NULL terminated list of fields to transfer
+ * \param [in]     wi_mass    if nonzero coarsened elements use the LGL mass
+ *                            inverse exact mass projection (\c wi_mass_prj)
+ *                            otherwise the projection (\c prj)
+ */
+void bfam_domain_pxest_transfer_fields(bfam_domain_pxest_t *domain_dst,
+                                       bfam_domain_pxest_t *domain_src,
+                                       bfam_domain_pxest_transfer_maps_t *maps,
+                                       const char **fields, int wi_mass);
+
 /* Callbacks for pxest quadrants */
 int bfam_domain_pxest_quadrant_coarsen(p4est_t *p4est,
                                        p4est_topidx_t which_tree,
@@ -1279,6 +1714,42 @@ void bfam_domain_pxest_quadrant_replace(p4est_t *p4est,
                                         int num_incoming,
                                         p4est_quadrant_t *incoming[]);
 
+/** Write a checkpoint of the domain
+ *
+ * The forest and the quadrant user data (order, root id, and glue ids) are
+ * written with \c p4est_save_ext and the volume fields are appended to the
+ * same file with collective MPI-IO using per-rank offsets.
+ *
+ * \param [in] domain   domain to checkpoint
+ * \param [in] filename name of the shared checkpoint file
+ * \param [in] fields   \c NULL terminated array of the volume fields to write
+ */
+void bfam_domain_pxest_checkpoint(bfam_domain_pxest_t *domain,
+                                  const char *filename, const char **fields);
+
+/** Create a domain from a checkpoint
+ *
+ * The checkpoint can be read on a different number of ranks than it was
+ * written with; the forest is repartitioned with the number of element nodes
+ * as the weight. The volume subdomains and glue grids are regenerated and all
+ * the fields in the checkpoint are added to the volume subdomains and filled.
+ *
+ * \param [in]  domComm      communicator for the domain
+ * \param [in]  filename     name of the checkpoint file
+ * \param [out] conn         connectivity read from the checkpoint; it is the
+ *                           callers responsibility to destroy this after the
+ *                           domain is freed
+ * \param [in]  glue_order   user callback function to allow the user to
+ *                           set the order of the glue grids
+ * \param [in]  go_user_args user argument for glue_order
+ *
+ * \return the newly created pxest managed domain
+ */
+bfam_domain_pxest_t *
+bfam_domain_pxest_restart(MPI_Comm domComm, const char *filename,
+                          p4est_connectivity_t **conn,
+                          bfam_glue_order_t glue_order, void *go_user_args);
+
 // }}}
 
 // {{{ subdomain dgx
@@ -1314,6 +1785,134 @@ void bfam_domain_pxest_quadrant_replace(p4est_t *p4est,
  *
  */
 
+/*
+ * Volume geometry layout: entry ID of node n of element k is stored at
+ * vgeo[NVGEO * Np * k + Np * ID + n], where ID_VGEO_JRiXj is J dr_i/dx_j and
+ * ID_VGEO_JINV is 1/J. The geometry is stored as bfam_metric_real_t.
+ */
+#if BFAM_DGX_DIMENSION == 2
+#define ID_VGEO_JR0X0 0
+#define ID_VGEO_JR0X1 1
+#define ID_VGEO_JR1X0 2
+#define ID_VGEO_JR1X1 3
+#define ID_VGEO_JINV 4
+#define ID_VGEO_W 5
+#define ID_VGEO_X0 6
+#define ID_VGEO_X1 7
+#define NVGEO 8
+#elif BFAM_DGX_DIMENSION == 3
+#define ID_VGEO_JR0X0 0
+#define ID_VGEO_JR0X1 1
+#define ID_VGEO_JR0X2 2
+#define ID_VGEO_JR1X0 3
+#define ID_VGEO_JR1X1 4
+#define ID_VGEO_JR1X2 5
+#define ID_VGEO_JINV 6
+#define ID_VGEO_JR2X0 7
+#define ID_VGEO_JR2X1 8
+#define ID_VGEO_JR2X2 9
+#define ID_VGEO_JINV2 10
+#define ID_VGEO_W 11
+#define ID_VGEO_X0 12
+#define ID_VGEO_X1 13
+#define ID_VGEO_X2 14
+#define NVGEO 15
+#else
+#error "bad dimension"
+#endif
+
+/* the metric terms are the entries of the volume geometry before ID_VGEO_W */
+#define NMGEO ID_VGEO_W
+
+/** Kronecker product kernel
+ *
+ * Applies a 1D operator \a A along one direction of the tensor product data
+ * \a x with \a N points per direction, for example \f$y = (I \otimes A) x\f$.
+ */
+typedef void (*bfam_kron_kernel_t)(const int N, const bfam_real_t *restrict A,
+                                   const bfam_real_t *restrict x,
+                                   bfam_real_t *restrict y);
+
+/**
+ * table of Kronecker product kernels; the names follow the operator with \c
+ * at for \f$A^T\f$ and \c _pe for kernels that add to \a y instead of
+ * overwriting it
+ */
+typedef struct bfam_kron_kernels
+{
+  int Nq; /**< number of points the kernels are specialized for (0 generic) */
+  int width; /**< number of interleaved elements the kernels act on */
+
+  /* 2D */
+  bfam_kron_kernel_t ixa, ixat, axi, atxi;
+  bfam_kron_kernel_t ixa_pe, ixat_pe, axi_pe, atxi_pe;
+
+  /* 3D */
+  bfam_kron_kernel_t axixi, atxixi, ixaxi, ixatxi, ixixa, ixixat;
+  bfam_kron_kernel_t axixi_pe, atxixi_pe, ixaxi_pe, ixatxi_pe, ixixa_pe,
+      ixixat_pe;
+} bfam_kron_kernels_t;
+
+/** Get the Kronecker product kernels for a polynomial order
+ *
+ * Kernels specialized at compile time are returned for orders 1 to 12 and
+ * kernels taking the number of points at runtime otherwise.
+ *
+ * \param [in] N polynomial order (the kernels are called with \c N+1 points)
+ *
+ * \return the table of kernels
+ */
+const bfam_kron_kernels_t *bfam_kron_get_kernels(const int N);
+
+/** Get the Kronecker product kernels taking the number of points at runtime
+ *
+ * These are the kernels \c bfam_kron_get_kernels falls back to for orders
+ * without a specialization; they work for any order and are mostly useful
+ * as a reference for the specialized kernels.
+ *
+ * \return the table of kernels
+ */
+const bfam_kron_kernels_t *bfam_kron_get_generic_kernels(void);
+
+/** Get element batched Kronecker product kernels
+ *
+ * The batched kernels act on \c width elements at once with the element
+ * data interleaved: node \c n of element \c e of the batch is stored at
+ * <tt>x[n * width + e]</tt>. The kernels are selected at runtime for the
+ * instruction set of the CPU (a width of one 512 bit register with AVX-512
+ * and one 256 bit register with AVX2, i.e., 8 and 4 doubles or 16 and 8
+ * floats); if neither is available the per element kernels with a width of 1
+ * are returned.
+ *
+ * \param [in] N polynomial order (the kernels are called with \c N+1 points)
+ *
+ * \return the table of kernels
+ */
+const bfam_kron_kernels_t *bfam_kron_get_batch_kernels(const int N);
+
+/** Autotune the loop order of the Kronecker product kernels
+ *
+ * For each of the orders \a N (1 to 12, others are ignored) the kernels of
+ * the volume and glue dimensions are timed on the root of \a comm with a few
+ * candidate loop orders, and the fastest ones are used for the tables
+ * returned by \c bfam_kron_get_kernels from then on. Tables already held by
+ * subdomains are not changed; \c bfam_domain_pxest_kron_autotune also
+ * updates those.
+ *
+ * If \a filename is given the loop orders found in this cache file are used
+ * without timing them, and the file is (re)written on the root when orders
+ * had to be timed. The file is specific to the machine it was tuned on.
+ *
+ * This is collective over \a comm and not thread safe.
+ *
+ * \param [in] comm     communicator to share the results over
+ * \param [in] num_N    number of orders
+ * \param [in] N        orders to tune
+ * \param [in] filename tuning cache file (or \c NULL)
+ */
+void bfam_kron_autotune(MPI_Comm comm, const int num_N, const int *N,
+                        const char *filename);
+
 struct bfam_subdomain_dgx;
 
 typedef struct bfam_subdomain_dgx_glue_data
@@ -1389,6 +1988,9 @@ typedef struct bfam_subdomain_dgx
   bfam_long_real_t *lw;  /* long format 1D LGL Nodal weights in [-1,1] */
   bfam_long_real_t *lDr; /* long format 1D LGL differentiation matrix */
   bfam_long_real_t *lV;  /* 1D Vandermonde matrix for this N */
+
+  /* Kronecker product kernels for this N */
+  const bfam_kron_kernels_t *kron;
   /* end of un-owned pointers */
 
   bfam_locidx_t K; /* Number of elements in the subdomain */
@@ -1419,6 +2021,898 @@ typedef struct bfam_subdomain_dgx
                           generator */
 } bfam_subdomain_dgx_t;
 
+/**
+ * Measured cost model used to weight the pxest partition.
+ *
+ * The cost of an element is modeled as a volume cost, which depends on the
+ * physics (the root id of the quadrant) and the order, plus a cost for each
+ * face of the element which is on a glue grid with a nonnegative id (e.g.,
+ * friction interfaces). The costs are calibrated from timings of the
+ * subdomain kernels accumulated over a window of steps.
+ *
+ * Each step the caller records the subdomain timings with \c
+ * bfam_domain_pxest_cost_add_time and then calls \c
+ * bfam_domain_pxest_cost_end_step on every rank; when that returns nonzero
+ * (it does so on all ranks or none) the imbalance is above the tolerance. By
+ * default the caller then repartitions, either the forest alone with \c
+ * bfam_domain_pxest_cost_partition (rebuilding the domain itself) or the
+ * whole domain with \c bfam_domain_pxest_cost_repartition, e.g.,
+ *
+ * \code
+ * if (bfam_domain_pxest_cost_end_step(&cost))
+ *   bfam_domain_pxest_cost_repartition(domain, &cost, fields, 1, NULL, NULL);
+ * \endcode
+ *
+ * After \c bfam_domain_pxest_cost_set_auto the model repartitions the domain
+ * itself inside of \c bfam_domain_pxest_cost_end_step, which then returns
+ * nonzero to tell the caller that the subdomains were rebuilt.
+ */
+typedef struct bfam_domain_pxest_cost
+{
+  bfam_dictionary_t model; /**< measured costs keyed by the element class */
+  MPI_Comm comm;           /**< communicator of the domain */
+  int window;              /**< number of steps between model updates */
+  int step;                /**< steps taken in the current window */
+  double tol;              /**< max/avg imbalance that triggers partitioning */
+  double imbalance;        /**< imbalance measured in the last window */
+  double resolution;       /**< seconds per unit of partition weight;
+                                zero until the model has been calibrated */
+  double node_cost;        /**< average volume cost per node; used for
+                                element classes that have not been timed */
+  double time;             /**< local time recorded in the current window */
+
+  /* arguments of bfam_domain_pxest_cost_repartition when the model
+   * repartitions by itself (see bfam_domain_pxest_cost_set_auto) */
+  bfam_domain_pxest_t *domain;  /**< domain to repartition (or \c NULL) */
+  const char **fields;          /**< volume fields moved with \a domain */
+  int allow_for_coarsening;     /**< passed to \c p4est_partition */
+  bfam_glue_order_t glue_order; /**< glue order callback for the rebuild */
+  void *go_user_args;           /**< user argument for \a glue_order */
+} bfam_domain_pxest_cost_t;
+
+/** Initialize a cost model
+ *
+ * \param [out] cost   cost model to initialize
+ * \param [in]  comm   communicator of the domain
+ * \param [in]  window number of steps timings are accumulated over before the
+ *                     model is updated
+ * \param [in]  tol    max/avg imbalance of the measured rank times above which
+ *                     a repartition is requested (e.g., 1.1)
+ */
+void bfam_domain_pxest_cost_init(bfam_domain_pxest_cost_t *cost, MPI_Comm comm,
+                                 int window, double tol);
+
+/** Free the memory used by a cost model
+ *
+ * \param [in,out] cost cost model to clean up
+ */
+void bfam_domain_pxest_cost_free(bfam_domain_pxest_cost_t *cost);
+
+/** Record the time spent in a subdomain during a step
+ *
+ * Volume subdomains (tagged \c _volume) calibrate the per-element cost for
+ * their uid and order, and glue subdomains (tagged \c _glue) with a
+ * nonnegative uid calibrate the per-face cost for their uid.
+ *
+ * \param [in,out] cost    cost model
+ * \param [in]     sub     subdomain the time was measured for
+ * \param [in]     seconds time spent on \a sub
+ */
+void bfam_domain_pxest_cost_add_time(bfam_domain_pxest_cost_t *cost,
+                                     bfam_subdomain_dgx_t *sub, double seconds);
+
+/** Mark the end of a step
+ *
+ * When the window is complete the times and counts of each element class
+ * are summed over the ranks to update the model, so every rank has the same
+ * costs, and the imbalance of the recorded times over the ranks is
+ * measured. This must be called collectively on the communicator of the
+ * model.
+ *
+ * \param [in,out] cost cost model
+ *
+ * \return nonzero if the measured imbalance is above the tolerance, i.e., the
+ *         caller should repartition (or, after \c
+ *         bfam_domain_pxest_cost_set_auto, the domain has been repartitioned)
+ */
+int bfam_domain_pxest_cost_end_step(bfam_domain_pxest_cost_t *cost);
+
+/** Let the cost model repartition a domain by itself
+ *
+ * From now on \c bfam_domain_pxest_cost_end_step calls \c
+ * bfam_domain_pxest_cost_repartition with these arguments whenever the
+ * imbalance is above the tolerance. Passing a \c NULL \a domain turns this
+ * off again.
+ *
+ * \param [in,out] cost                 cost model
+ * \param [in]     domain               domain to repartition
+ * \param [in]     fields               \c NULL terminated array of the volume
+ *                                      fields to move; must stay valid while
+ *                                      it is set
+ * \param [in]     allow_for_coarsening passed to \c p4est_partition
+ * \param [in]     glue_order           user callback function to allow the
+ *                                      user to set the order of the glue grids
+ * \param [in]     go_user_args         user argument for glue_order
+ */
+void bfam_domain_pxest_cost_set_auto(bfam_domain_pxest_cost_t *cost,
+                                     bfam_domain_pxest_t *domain,
+                                     const char **fields,
+                                     int allow_for_coarsening,
+                                     bfam_glue_order_t glue_order,
+                                     void *go_user_args);
+
+/** Partition a forest using the measured cost model
+ *
+ * Before the model has been calibrated elements are weighted by the number of
+ * nodes. The quadrant user data must be that of a split domain.
+ *
+ * \param [in,out] pxest forest to partition
+ * \param [in]     cost  cost model
+ * \param [in]     allow_for_coarsening passed to \c p4est_partition
+ */
+void bfam_domain_pxest_cost_partition(p4est_t *pxest,
+                                      bfam_domain_pxest_cost_t *cost,
+                                      int allow_for_coarsening);
+
+/** Repartition a domain using the measured cost model
+ *
+ * The forest is partitioned with \c bfam_domain_pxest_cost_partition, the
+ * volume subdomains and glue grids are regenerated for the new partition (as
+ * in \c bfam_domain_pxest_restart), and the given volume fields are moved to
+ * the ranks that now own their elements. Pointers to the old subdomains are
+ * invalid afterwards; other fields, tags, and glue data have to be set up
+ * again by the caller. This must be called collectively.
+ *
+ * \param [in,out] domain               domain to repartition
+ * \param [in]     cost                 cost model
+ * \param [in]     fields               \c NULL terminated array of the volume
+ *                                      fields to move
+ * \param [in]     allow_for_coarsening passed to \c p4est_partition
+ * \param [in]     glue_order           user callback function to allow the
+ *                                      user to set the order of the glue grids
+ * \param [in]     go_user_args         user argument for glue_order
+ */
+void bfam_domain_pxest_cost_repartition(bfam_domain_pxest_t *domain,
+                                        bfam_domain_pxest_cost_t *cost,
+                                        const char **fields,
+                                        int allow_for_coarsening,
+                                        bfam_glue_order_t glue_order,
+                                        void *go_user_args);
+
+/**
+ * parameters for the modal decay adaptation indicator
+ */
+typedef struct bfam_domain_pxest_indicator
+{
+  bfam_real_t refine_tol;   /**< refine if the relative size of the highest
+                                 modes is above this */
+  bfam_real_t coarsen_tol;  /**< coarsen if the relative size of the highest
+                                 modes is below this */
+  bfam_real_t smooth_decay; /**< elements whose modes decay faster than
+                                 \f$e^{-\sigma n}\f$ with \f$\sigma\f$ above
+                                 this are smooth and p-refined */
+  int num_fit;              /**< number of highest modes used to fit the
+                                 decay rate */
+  int N_min;                /**< minimum order */
+  int N_max;                /**< maximum order */
+  int lvl_min;              /**< minimum refinement level */
+  int lvl_max;              /**< maximum refinement level */
+} bfam_domain_pxest_indicator_t;
+
+/** Set the adaptation flags from the modal decay of a field
+ *
+ * The field is transformed to the Legendre modes of each element with the
+ * inverse of the Vandermonde matrix \c lV. The energy of the modes of the
+ * same maximum degree gives the relative size of the highest modes and, by a
+ * least squares fit of their logarithm, a decay rate. Under-resolved elements
+ * are p-refined if smooth and h-refined otherwise, and over-resolved elements
+ * are h-coarsened (p-coarsened at \c lvl_min). Elements with \f$N < 2\f$
+ * have too few modes for the fit and are treated as smooth. Each element only
+ * uses its own data, so the result does not depend on the partition.
+ *
+ * The \c hadapt and \c padapt arrays of the volume subdomains are set and
+ * can then be passed to the forest with \c bfam_domain_pxest_mark_elements.
+ *
+ * \param [in,out] domain pxest domain
+ * \param [in]     field  name of the volume field to use
+ * \param [in]     params thresholds and limits for the adaptation
+ */
+void bfam_domain_pxest_modal_indicator(
+    bfam_domain_pxest_t *domain, const char *field,
+    const bfam_domain_pxest_indicator_t *params);
+
+/** Volume metric terms of a dgx subdomain with affine elements compressed
+ *
+ * Only the \c NMGEO metric entries of the \c ID_VGEO layout are kept. An
+ * element whose metric terms are constant (an affine element, e.g., every
+ * element of a brick mesh) stores a single tuple of \c NMGEO values, all
+ * other elements store the \c NMGEO * \c Np values of the \c ID_VGEO
+ * layout. The data of element \c k is <tt>mgeo[offset[k]:offset[k+1]]</tt>.
+ *
+ * The surface terms (the \c NSGEO layout of the device kernels) are not
+ * compressed: the host library does not store surface geometry, so callers
+ * which keep normals and surface Jacobians keep them per face node.
+ */
+typedef struct bfam_subdomain_dgx_geo
+{
+  bfam_locidx_t K;          /**< number of elements */
+  int Np;                   /**< nodes per element */
+  bfam_locidx_t num_affine; /**< number of affine elements */
+  bfam_locidx_t *offset;    /**< K+1 offsets of the elements into mgeo */
+  bfam_metric_real_t *mgeo; /**< metric terms */
+} bfam_subdomain_dgx_geo_t;
+
+/** Build the compressed metric terms of a volume subdomain
+ *
+ * \param [out] geo  compressed metric terms
+ * \param [in]  sub  volume subdomain
+ * \param [in]  vgeo metric terms of \a sub in the \c ID_VGEO layout
+ * \param [in]  tol  an element is affine if each of its metric terms differs
+ *                   from its value at the first node by at most \a tol times
+ *                   the largest magnitude of that term over the element; if
+ *                   negative no element is compressed
+ */
+void bfam_subdomain_dgx_geo_init(bfam_subdomain_dgx_geo_t *geo,
+                                 bfam_subdomain_dgx_t *sub,
+                                 const bfam_metric_real_t *restrict vgeo,
+                                 bfam_metric_real_t tol);
+
+/** Free the compressed metric terms of a volume subdomain
+ *
+ * \param [in,out] geo compressed metric terms to free
+ */
+void bfam_subdomain_dgx_geo_free(bfam_subdomain_dgx_geo_t *geo);
+
+/** Compute the gradient of a volume field
+ *
+ * The derivatives along the reference directions are taken with the
+ * Kronecker product kernels of the subdomain (sum factorization) and
+ * combined with the metric terms in \a geo, i.e.,
+ * \f$\partial u/\partial x_j = J^{-1} \sum_i (J r_{i,x_j}) D_i u\f$.
+ *
+ * \param [in]  sub  volume subdomain
+ * \param [in]  geo  metric terms of \a sub
+ * \param [in]  u    field to differentiate
+ * \param [out] grad components of the gradient of \a u
+ */
+void bfam_subdomain_dgx_grad(bfam_subdomain_dgx_t *sub,
+                             const bfam_subdomain_dgx_geo_t *geo,
+                             const bfam_real_t *restrict u,
+                             bfam_real_t *const *grad);
+
+/** Compute the gradients of a field of the matching volume subdomains
+ *
+ * The elements of all the subdomains are cut into chunks and run in a single
+ * threaded pass (see \c bfam_parallel_for_subdomains), so that the work is
+ * balanced across the subdomains. The arrays are indexed by the position of
+ * the subdomain among the matching subdomains, i.e., the order of
+ * \c bfam_domain_get_subdomains.
+ *
+ * \param [in]  domain domain
+ * \param [in]  match  type of match for \a tags
+ * \param [in]  tags   \c NULL terminated tags of the volume subdomains
+ * \param [in]  geo    metric terms of each subdomain
+ * \param [in]  u      field of each subdomain to differentiate
+ * \param [out] grad   components of the gradient of each subdomain
+ */
+void bfam_domain_dgx_grad(bfam_domain_t *domain, bfam_domain_match_t match,
+                          const char **tags,
+                          const bfam_subdomain_dgx_geo_t *geo,
+                          const bfam_real_t *const *u,
+                          bfam_real_t *const *const *grad);
+
+/** Compute the divergence of a volume vector field
+ *
+ * The divergence is taken in conservative form,
+ * \f$\nabla\cdot v = J^{-1} \sum_i D_i \sum_j (J r_{i,x_j}) v_j\f$.
+ *
+ * \param [in]  sub  volume subdomain
+ * \param [in]  geo  metric terms of \a sub
+ * \param [in]  v    components of the vector field
+ * \param [out] div  divergence of \a v
+ */
+void bfam_subdomain_dgx_div(bfam_subdomain_dgx_t *sub,
+                            const bfam_subdomain_dgx_geo_t *geo,
+                            const bfam_real_t *const *v,
+                            bfam_real_t *restrict div);
+
+/** Compute the weak divergence of a volume vector field
+ *
+ * This is the volume term \f$M^{-1} \int \nabla \phi \cdot v\f$ of a
+ * weak form DG method,
+ * \f$(JW)^{-1} \sum_i D_i^T W \sum_j (J r_{i,x_j}) v_j\f$ with \f$W\f$
+ * the LGL quadrature weights.
+ *
+ * \param [in]  sub  volume subdomain
+ * \param [in]  geo  metric terms of \a sub
+ * \param [in]  v    components of the vector field
+ * \param [out] div  weak divergence of \a v
+ */
+void bfam_subdomain_dgx_weak_div(bfam_subdomain_dgx_t *sub,
+                                 const bfam_subdomain_dgx_geo_t *geo,
+                                 const bfam_real_t *const *v,
+                                 bfam_real_t *restrict div);
+
+/** Compute the divergences of a vector field of the matching volume
+ * subdomains in a single threaded pass
+ *
+ * See \c bfam_subdomain_dgx_div and \c bfam_domain_dgx_grad.
+ *
+ * \param [in]  domain domain
+ * \param [in]  match  type of match for \a tags
+ * \param [in]  tags   \c NULL terminated tags of the volume subdomains
+ * \param [in]  geo    metric terms of each subdomain
+ * \param [in]  v      components of the vector field of each subdomain
+ * \param [out] div    divergence of each subdomain
+ */
+void bfam_domain_dgx_div(bfam_domain_t *domain, bfam_domain_match_t match,
+                         const char **tags,
+                         const bfam_subdomain_dgx_geo_t *geo,
+                         const bfam_real_t *const *const *v,
+                         bfam_real_t *const *div);
+
+/** Compute the weak divergences of a vector field of the matching volume
+ * subdomains in a single threaded pass
+ *
+ * See \c bfam_subdomain_dgx_weak_div and \c bfam_domain_dgx_grad.
+ *
+ * \param [in]  domain domain
+ * \param [in]  match  type of match for \a tags
+ * \param [in]  tags   \c NULL terminated tags of the volume subdomains
+ * \param [in]  geo    metric terms of each subdomain
+ * \param [in]  v      components of the vector field of each subdomain
+ * \param [out] div    weak divergence of each subdomain
+ */
+void bfam_domain_dgx_weak_div(bfam_domain_t *domain, bfam_domain_match_t match,
+                              const char **tags,
+                              const bfam_subdomain_dgx_geo_t *geo,
+                              const bfam_real_t *const *const *v,
+                              bfam_real_t *const *div);
+
+/** Operators of a dgx glue subdomain applied by
+ * bfam_subdomain_dgx_glue_apply
+ */
+typedef enum bfam_subdomain_dgx_glue_op {
+  BFAM_DGX_GLUE_INTERPOLATION,  /**< minus side face to the glue */
+  BFAM_DGX_GLUE_PROJECTION,     /**< glue to the minus side face */
+  BFAM_DGX_GLUE_MASSPROJECTION, /**< glue to the minus side face times the
+                                     face mass matrix */
+} bfam_subdomain_dgx_glue_op_t;
+
+/** Elements of a dgx glue subdomain sorted by (hanging number, orientation)
+ *
+ * The elements of bucket \c h*num_orient+o are
+ * <tt>elems[offset[h*num_orient+o]:offset[h*num_orient+o+1]]</tt>, all of
+ * which share the same glue operators.
+ */
+typedef struct bfam_subdomain_dgx_glue_buckets
+{
+  int num_hanging;       /**< hanging numbers: 3 for edges, 5 for faces */
+  int num_orient;        /**< orientations of the plus side */
+  bfam_locidx_t *offset; /**< num_hanging*num_orient+1 bucket offsets */
+  bfam_locidx_t *elems;  /**< glue elements in bucket order */
+} bfam_subdomain_dgx_glue_buckets_t;
+
+/** Sort the elements of a dgx glue subdomain into operator buckets
+ *
+ * \param [out] buckets buckets to initialize
+ * \param [in]  sub     glue subdomain (with both \c glue_m and \c glue_p)
+ */
+void bfam_subdomain_dgx_glue_buckets_init(
+    bfam_subdomain_dgx_glue_buckets_t *buckets, bfam_subdomain_dgx_t *sub);
+
+/** Free the buckets of a dgx glue subdomain
+ *
+ * \param [in,out] buckets buckets to free
+ */
+void bfam_subdomain_dgx_glue_buckets_free(
+    bfam_subdomain_dgx_glue_buckets_t *buckets);
+
+/** Apply a glue operator to all the elements of a dgx glue subdomain
+ *
+ * Each bucket is applied as one batched tensor product small matrix product
+ * over groups of interleaved elements, instead of element by element. The
+ * element data are stored with \c Np contiguous nodes per element (minus side
+ * face nodes in the order of the minus side, glue nodes in the order of the
+ * glue).
+ *
+ * \param [in]  sub     glue subdomain
+ * \param [in]  buckets buckets of \a sub
+ * \param [in]  op      operator to apply
+ * \param [in]  orient  if nonzero the glue side nodes are permuted by the
+ *                      plus side orientation (\c mapOp) of each element
+ * \param [in]  in      input element data
+ * \param [out] out     output element data
+ */
+void bfam_subdomain_dgx_glue_apply(
+    bfam_subdomain_dgx_t *sub, const bfam_subdomain_dgx_glue_buckets_t *buckets,
+    bfam_subdomain_dgx_glue_op_t op, int orient,
+    const bfam_real_t *restrict in, bfam_real_t *restrict out);
+
+/** Apply a glue operator to all the elements of the matching dgx glue
+ * subdomains in a single threaded pass
+ *
+ * See \c bfam_subdomain_dgx_glue_apply and \c bfam_domain_dgx_grad.
+ *
+ * \param [in]  domain  domain
+ * \param [in]  match   type of match for \a tags
+ * \param [in]  tags    \c NULL terminated tags of the glue subdomains
+ * \param [in]  buckets buckets of each subdomain
+ * \param [in]  op      operator to apply
+ * \param [in]  orient  if nonzero the glue side nodes are permuted by the
+ *                      plus side orientation of each element
+ * \param [in]  in      input element data of each subdomain
+ * \param [out] out     output element data of each subdomain
+ */
+void bfam_domain_dgx_glue_apply(
+    bfam_domain_t *domain, bfam_domain_match_t match, const char **tags,
+    const bfam_subdomain_dgx_glue_buckets_t *buckets,
+    bfam_subdomain_dgx_glue_op_t op, int orient, const bfam_real_t *const *in,
+    bfam_real_t *const *out);
+
+/** Face-major trace storage of a dgx subdomain
+ *
+ * Face \c fk (face \c f of element \c k is <tt>fk = k*Nfaces+f</tt>) stores
+ * its \c Nfp values contiguously at <tt>fk*Nfp</tt>, in the same order as
+ * \c vmapM and \c vmapP, so that flux kernels stream the traces linearly
+ * instead of gathering through the maps. The plus side of each face is a
+ * permuted copy of the minus side trace of the face it is connected to.
+ */
+typedef struct bfam_subdomain_dgx_trace
+{
+  int Nfp;              /**< nodes per face */
+  int Nfaces;           /**< faces per element */
+  bfam_locidx_t *faceP; /**< plus side face (k*Nfaces+f) of each face */
+  int8_t *permP;        /**< plus side permutation of each face */
+  int num_perm;         /**< number of distinct permutations */
+  int *perm;            /**< num_perm permutations of length Nfp */
+} bfam_subdomain_dgx_trace_t;
+
+/** Build the face-major trace storage of a dgx subdomain
+ *
+ * \param [out] trace trace storage to initialize
+ * \param [in]  sub   subdomain (with \c vmapM and \c vmapP)
+ */
+void bfam_subdomain_dgx_trace_init(bfam_subdomain_dgx_trace_t *trace,
+                                   bfam_subdomain_dgx_t *sub);
+
+/** Free the face-major trace storage of a dgx subdomain
+ *
+ * \param [in,out] trace trace storage to free
+ */
+void bfam_subdomain_dgx_trace_free(bfam_subdomain_dgx_trace_t *trace);
+
+/** Lift a volume field to its face traces
+ *
+ * On return <tt>qM[fk*Nfp+n] = q[vmapM[fk*Nfp+n]]</tt> and (if \a qP is not
+ * \c NULL) <tt>qP[fk*Nfp+n] = q[vmapP[fk*Nfp+n]]</tt>.
+ *
+ * \param [in]  sub   subdomain
+ * \param [in]  trace trace storage of \a sub
+ * \param [in]  q     volume field
+ * \param [out] qM    minus side traces, \c K*Nfaces*Nfp values
+ * \param [out] qP    plus side traces, \c K*Nfaces*Nfp values, or \c NULL
+ */
+void bfam_subdomain_dgx_trace_lift(bfam_subdomain_dgx_t *sub,
+                                   const bfam_subdomain_dgx_trace_t *trace,
+                                   const bfam_real_t *restrict q,
+                                   bfam_real_t *restrict qM,
+                                   bfam_real_t *restrict qP);
+
+/** Lift a volume field of the matching subdomains to their face traces
+ *
+ * The minus sides of all the subdomains are lifted in one threaded pass and
+ * the plus sides in a second one. See \c bfam_subdomain_dgx_trace_lift and
+ * \c bfam_domain_dgx_grad.
+ *
+ * \param [in]  domain domain
+ * \param [in]  match  type of match for \a tags
+ * \param [in]  tags   \c NULL terminated tags of the subdomains
+ * \param [in]  trace  trace storage of each subdomain
+ * \param [in]  q      volume field of each subdomain
+ * \param [out] qM     minus side traces of each subdomain
+ * \param [out] qP     plus side traces of each subdomain (or \c NULL, or
+ *                     \c NULL entries, to skip them)
+ */
+void bfam_domain_dgx_trace_lift(bfam_domain_t *domain,
+                                bfam_domain_match_t match, const char **tags,
+                                const bfam_subdomain_dgx_trace_t *trace,
+                                const bfam_real_t *const *q,
+                                bfam_real_t *const *qM, bfam_real_t *const *qP);
+// }}}
+
+// {{{ parallel for
+/**
+ * Kernel run by \c bfam_domain_parallel_for on the elements \a k_begin to
+ * \a k_end - 1 of the dgx subdomain \a sub (number \a s in the list of
+ * subdomains) by thread \a thread (from 0 to \c bfam_parallel_max_threads()
+ * - 1); a thread runs one chunk at a time, so per thread data indexed by
+ * \a thread needs no synchronization
+ */
+typedef void (*bfam_parallel_kernel_t)(bfam_subdomain_t *sub, bfam_locidx_t s,
+                                       bfam_locidx_t k_begin,
+                                       bfam_locidx_t k_end, int thread,
+                                       void *arg);
+
+/** Number of threads the parallel loops can run on
+ *
+ * \return the OpenMP max number of threads (1 without OpenMP)
+ */
+int bfam_parallel_max_threads(void);
+
+/** Run a kernel over all the elements of a list of dgx subdomains
+ *
+ * The subdomains are cut into chunks of elements of roughly equal cost (the
+ * number of nodes \c K*Np), so that a subdomain of a few high order elements
+ * and one of millions of low order elements are split alike. The chunks are
+ * dealt out to the threads in contiguous blocks, and a thread which runs out
+ * of chunks steals half of the remaining block of another thread. The
+ * scratch arena of the thread (\c bfam_scratch_arena()) is released after
+ * each chunk. This returns when all the chunks have been run.
+ *
+ * \param [in] subs     subdomains to loop over
+ * \param [in] num_subs number of subdomains
+ * \param [in] kernel   kernel to run on each chunk
+ * \param [in] arg      argument passed to \a kernel
+ */
+void bfam_parallel_for_subdomains(bfam_subdomain_t **subs,
+                                  bfam_locidx_t num_subs,
+                                  bfam_parallel_kernel_t kernel, void *arg);
+
+/** Run a kernel over all the elements of the matching dgx subdomains
+ *
+ * See \c bfam_parallel_for_subdomains.
+ *
+ * \param [in] domain domain to loop over
+ * \param [in] match  type of match for \a tags
+ * \param [in] tags   \c NULL terminated array of the tags to match
+ * \param [in] kernel kernel to run on each chunk
+ * \param [in] arg    argument passed to \a kernel
+ */
+void bfam_domain_parallel_for(bfam_domain_t *domain, bfam_domain_match_t match,
+                              const char **tags, bfam_parallel_kernel_t kernel,
+                              void *arg);
+// }}}
+
+// {{{ cfl
+/**
+ * Returns the largest wave speed of element \a k of a volume subdomain; when
+ * called from a fused pass the fields of the element have just been updated.
+ * It is called concurrently by several threads (for different elements), so
+ * it must be thread safe.
+ */
+typedef bfam_real_t (*bfam_domain_cfl_speed_t)(bfam_subdomain_dgx_t *sub,
+                                               bfam_locidx_t k,
+                                               void *user_data);
+
+/**
+ * cached global stable time step rate of the dgx volume subdomains of a
+ * domain
+ */
+typedef struct bfam_domain_cfl
+{
+  MPI_Comm comm;
+  bfam_domain_cfl_speed_t speed;
+  void *user_data;
+
+  bfam_subdomain_dgx_t **subs; /**< volume subdomains */
+  bfam_locidx_t num_subs;
+  double **inv_len; /**< inverse length scale of each element */
+
+  int recompute; /**< compute the rate with the next pass */
+  int pending;   /**< reduction of \c loc_rate in flight */
+  MPI_Request req;
+  double loc_rate; /**< rate of the local elements */
+  double rate;     /**< rate of the domain */
+} bfam_domain_cfl_t;
+
+/** Initialize a time step rate cache
+ *
+ * The inverse length scale of an element is computed once from the
+ * coordinates \c _grid_x* as
+ * \f$\frac{N^2}{2} \max_n \sum_i |\nabla r_i|\f$
+ * and the rate of the domain is the maximum over the elements of the wave
+ * speed times the inverse length scale, i.e., a stable time step is
+ * <tt>cfl / rate</tt>.
+ *
+ * \param [out] cfl          rate cache
+ * \param [in]  dom          domain
+ * \param [in]  subdom_match type of match for \a subdom_tags
+ * \param [in]  subdom_tags  \c NULL terminated tags of the dgx volume
+ *                           subdomains to use
+ * \param [in]  speed        wave speed of an element
+ * \param [in]  user_data    passed to \a speed
+ */
+void bfam_domain_cfl_init(bfam_domain_cfl_t *cfl, bfam_domain_t *dom,
+                          bfam_domain_match_t subdom_match,
+                          const char **subdom_tags,
+                          bfam_domain_cfl_speed_t speed, void *user_data);
+
+/** Free the memory used by a time step rate cache
+ *
+ * \param [in,out] cfl rate cache to clean up
+ */
+void bfam_domain_cfl_free(bfam_domain_cfl_t *cfl);
+
+/** Flag the rate for recomputation with the next pass, e.g., after the wave
+ * speeds changed
+ *
+ * \param [in,out] cfl rate cache
+ */
+void bfam_domain_cfl_flag(bfam_domain_cfl_t *cfl);
+
+/** Start the computation of a flagged rate
+ *
+ * All elements are visited in one threaded pass and the global maximum is
+ * started with a nonblocking reduction; nothing is done if the rate is not
+ * flagged.
+ *
+ * \param [in,out] cfl rate cache
+ */
+void bfam_domain_cfl_start(bfam_domain_cfl_t *cfl);
+
+/** Get the rate, waiting for a pending reduction
+ *
+ * \param [in,out] cfl rate cache
+ *
+ * \return the cached rate of the domain
+ */
+double bfam_domain_cfl_rate(bfam_domain_cfl_t *cfl);
+// }}}
+
+// {{{ ts lsrk
+typedef enum bfam_ts_lsrk_method {
+  BFAM_TS_LSRK_KC54,
+  BFAM_TS_LSRK_FE,
+  BFAM_TS_LSRK_HEUN,
+  BFAM_TS_LSRK_W33,
+  BFAM_TS_LSRK_NOOP,
+} bfam_ts_lsrk_method_t;
+
+/**
+ * Creates the rate fields \c prefix+field for a subdomain
+ */
+typedef void (*bfam_ts_lsrk_aux_rates_t)(bfam_subdomain_t *thisSubdomain,
+                                         const char *prefix, void *user_data);
+
+/**
+ * Adds the rate of a subdomain at time \a t to the rate fields
+ * \c rate_prefix+field; the rate fields must not be overwritten
+ */
+typedef void (*bfam_ts_lsrk_rhs_t)(bfam_subdomain_t *thisSubdomain,
+                                   const char *rate_prefix,
+                                   const bfam_long_real_t t, void *user_data);
+
+/**
+ * Starts or finishes the communication for the stage at time \a t
+ */
+typedef void (*bfam_ts_lsrk_comm_t)(const bfam_long_real_t t,
+                                    void *user_data);
+
+/**
+ * hooks called by the low storage Runge-Kutta driver; any of them can be
+ * \c NULL
+ */
+typedef struct bfam_ts_lsrk_hooks
+{
+  bfam_ts_lsrk_aux_rates_t aux_rates; /**< create the rate fields */
+  bfam_ts_lsrk_rhs_t intra_rhs;       /**< rate that does not need data from
+                                           other subdomains */
+  bfam_ts_lsrk_comm_t comm_start;     /**< start the communication, called
+                                           before \c intra_rhs */
+  bfam_ts_lsrk_comm_t comm_finish;    /**< finish the communication, called
+                                           after \c intra_rhs */
+  bfam_ts_lsrk_rhs_t inter_rhs;       /**< rate that needs the communicated
+                                           data */
+  void *user_data;                    /**< passed to the hooks */
+} bfam_ts_lsrk_hooks_t;
+
+/**
+ * low storage Runge-Kutta time stepper for host dgx subdomains
+ */
+typedef struct bfam_ts_lsrk
+{
+  int n_stages;
+  bfam_long_real_t *A;
+  bfam_long_real_t *B;
+  bfam_long_real_t *C;
+  bfam_long_real_t t; /**< current time */
+
+  bfam_subdomain_t **subs; /**< subdomains being stepped */
+  bfam_locidx_t num_subs;
+  int num_fields;
+
+  bfam_real_t **q;  /**< fields, num_fields per subdomain (NULL if missing) */
+  bfam_real_t **dq; /**< rate fields, same layout as q */
+
+  char rate_prefix[BFAM_BUFSIZ];
+  bfam_ts_lsrk_hooks_t hooks;
+
+  bfam_domain_cfl_t *cfl;  /**< rate computed with the last stage (or NULL) */
+  bfam_locidx_t *cfl_sub; /**< index of each subdomain in cfl (or -1) */
+} bfam_ts_lsrk_t;
+
+/** Initialize a low storage Runge-Kutta time stepper
+ *
+ * The rate fields are created with the \c aux_rates hook and zeroed. A stage
+ * calls \c comm_start, \c intra_rhs, \c comm_finish, and \c inter_rhs, which
+ * add to the rate fields, and then updates all fields of all subdomains in
+ * a single pass over the elements that also scales the rates by the \c A
+ * coefficient of the next stage.
+ *
+ * \param [out] ts           time stepper
+ * \param [in]  dom          domain to step
+ * \param [in]  method       Runge-Kutta scheme
+ * \param [in]  subdom_match type of match for \a subdom_tags
+ * \param [in]  subdom_tags  \c NULL terminated tags of the dgx subdomains to
+ *                           step
+ * \param [in]  fields       \c NULL terminated names of the fields to step;
+ *                           fields not in a subdomain are skipped
+ * \param [in]  rate_prefix  prefix of the rate fields
+ * \param [in]  hooks        hooks for the rates and communication
+ */
+void bfam_ts_lsrk_init(bfam_ts_lsrk_t *ts, bfam_domain_t *dom,
+                       bfam_ts_lsrk_method_t method,
+                       bfam_domain_match_t subdom_match,
+                       const char **subdom_tags, const char **fields,
+                       const char *rate_prefix,
+                       const bfam_ts_lsrk_hooks_t *hooks);
+
+/** Free the memory used by a low storage Runge-Kutta time stepper
+ *
+ * \param [in,out] ts time stepper to clean up
+ */
+void bfam_ts_lsrk_free(bfam_ts_lsrk_t *ts);
+
+/** Compute a flagged time step rate with the update of the last stage
+ *
+ * The wave speed of an element is evaluated right after its fields are
+ * updated, so the fields are only read once, and the reduction is started
+ * at the end of the step; \c bfam_domain_cfl_rate waits for it. Subdomains
+ * of \a cfl not stepped by \a ts are visited after the update. The wave
+ * speed callback of \a cfl is then called from the threads of the stage
+ * update, concurrently for different elements, so it must be thread safe.
+ *
+ * \param [in,out] ts  time stepper
+ * \param [in]     cfl rate cache (or \c NULL to stop computing it)
+ */
+void bfam_ts_lsrk_set_cfl(bfam_ts_lsrk_t *ts, bfam_domain_cfl_t *cfl);
+
+/** Take one step
+ *
+ * \param [in,out] ts time stepper
+ * \param [in]     dt time step size
+ */
+void bfam_ts_lsrk_step(bfam_ts_lsrk_t *ts, const bfam_long_real_t dt);
+// }}}
+
+// {{{ ts mrab
+/* maximum order of the multirate Adams-Bashforth scheme */
+#define BFAM_TS_MRAB_MAX_ORDER 4
+
+/**
+ * Adds the rate at time \a t of the elements \a elems of a subdomain to the
+ * rate fields \c rate_prefix+field; for glue subdomains \a elems are faces
+ * and the rates are those of the minus side elements
+ */
+typedef void (*bfam_ts_mrab_rhs_t)(bfam_subdomain_t *thisSubdomain,
+                                   const char *rate_prefix,
+                                   const bfam_long_real_t t,
+                                   const bfam_locidx_t *elems,
+                                   const bfam_locidx_t num_elems,
+                                   void *user_data);
+
+/**
+ * hooks called by the multirate Adams-Bashforth driver; any of them can be
+ * \c NULL
+ */
+typedef struct bfam_ts_mrab_hooks
+{
+  bfam_ts_lsrk_aux_rates_t aux_rates; /**< create the rate fields, called
+                                           once for each stored rate */
+  bfam_ts_mrab_rhs_t intra_rhs;       /**< rate that does not need data from
+                                           other subdomains */
+  bfam_ts_lsrk_comm_t comm_start;     /**< start the communication, called
+                                           before \c intra_rhs */
+  bfam_ts_lsrk_comm_t comm_finish;    /**< finish the communication, called
+                                           after \c intra_rhs */
+  bfam_ts_mrab_rhs_t inter_rhs;       /**< rate that needs the communicated
+                                           data */
+  void *user_data;                    /**< passed to the hooks */
+} bfam_ts_mrab_hooks_t;
+
+/**
+ * multirate Adams-Bashforth time stepper for host dgx subdomains where the
+ * elements take time steps based on their stable time step
+ */
+typedef struct bfam_ts_mrab
+{
+  int order;    /**< order of the Adams-Bashforth scheme */
+  int num_lvls; /**< number of rate levels; level j steps with 2^j dt_f */
+  bfam_long_real_t t; /**< current time */
+
+  bfam_subdomain_t **subs; /**< subdomains being stepped */
+  bfam_locidx_t num_subs;
+  int num_fields;
+
+  bfam_real_t **q;  /**< fields, num_fields per subdomain (NULL if missing) */
+  bfam_real_t **dq; /**< rates, order*num_fields per subdomain */
+
+  bfam_locidx_t *lvl_offset; /**< num_lvls+1 offsets into lvl_elems per
+                                  subdomain */
+  bfam_locidx_t *lvl_elems;  /**< elements of the subdomains by level */
+
+  int *head;              /**< rate slot holding the newest rate of each
+                               level */
+  bfam_long_real_t *coef; /**< Adams-Bashforth weights of each level and
+                               fine step within its step, in units of the
+                               fine step */
+
+  int num_start;          /**< coarse steps left to the starter */
+  bfam_ts_lsrk_t starter; /**< Runge-Kutta starter (if \c order > 1) */
+
+  char rate_prefix[BFAM_BUFSIZ];
+  bfam_ts_mrab_hooks_t hooks;
+} bfam_ts_mrab_t;
+
+/** Initialize a multirate Adams-Bashforth time stepper
+ *
+ * The level of a volume element is the largest \c j below \a max_lvls for
+ * which \c 2^j times its rate (wave speed times inverse length scale, see
+ * \c bfam_domain_cfl_init) is at most the largest rate of the domain, so
+ * that it can take steps of \c 2^j dt_f whenever the fine step \c dt_f is
+ * stable for the fastest element; glue faces follow their minus side
+ * element. The rates are only evaluated for the elements starting a step,
+ * while the states of all elements are advanced to each fine time with the
+ * Adams-Bashforth polynomial of their level, so that the rate evaluations
+ * see consistent neighbor states.
+ *
+ * Rates are stored in the fields \c rate_prefix+i+"_"+field for <tt>i = 0,
+ * ..., order-1</tt>, created with the \c aux_rates hook. The first
+ * <tt>order-1</tt> steps are taken with a fourth order low storage
+ * Runge-Kutta scheme at the fine step for all elements, which fills the rate
+ * history of every level (using the rate fields of slot <tt>order-1</tt>
+ * for its own stages), so that the scheme keeps its order.
+ *
+ * \param [out] ts           time stepper
+ * \param [in]  dom          domain to step
+ * \param [in]  order        order of the scheme (1 to
+ *                           \c BFAM_TS_MRAB_MAX_ORDER)
+ * \param [in]  max_lvls     maximum number of rate levels
+ * \param [in]  cfl          rate cache of the volume subdomains stepped
+ *                           (and of the minus sides of the glue subdomains)
+ * \param [in]  subdom_match type of match for \a subdom_tags
+ * \param [in]  subdom_tags  \c NULL terminated tags of the dgx volume and
+ *                           glue subdomains to step
+ * \param [in]  fields       \c NULL terminated names of the fields to step;
+ *                           fields not in a subdomain are skipped
+ * \param [in]  rate_prefix  prefix of the rate fields
+ * \param [in]  hooks        hooks for the rates and communication
+ */
+void bfam_ts_mrab_init(bfam_ts_mrab_t *ts, bfam_domain_t *dom, int order,
+                       int max_lvls, bfam_domain_cfl_t *cfl,
+                       bfam_domain_match_t subdom_match,
+                       const char **subdom_tags, const char **fields,
+                       const char *rate_prefix,
+                       const bfam_ts_mrab_hooks_t *hooks);
+
+/** Free the memory used by a multirate Adams-Bashforth time stepper
+ *
+ * \param [in,out] ts time stepper to clean up
+ */
+void bfam_ts_mrab_free(bfam_ts_mrab_t *ts);
+
+/** Take one step of the coarsest level
+ *
+ * The finest level takes <tt>2^(num_lvls-1)</tt> steps of size
+ * <tt>dt / 2^(num_lvls-1)</tt>, which has to be stable for the fastest
+ * element, e.g., <tt>dt = 2^(num_lvls-1) c / rate</tt> with the rate of the
+ * \c cfl cache and a Courant number \c c.
+ *
+ * \param [in,out] ts time stepper
+ * \param [in]     dt time step size of the coarsest level
+ */
+void bfam_ts_mrab_step(bfam_ts_mrab_t *ts, const bfam_long_real_t dt);
 // }}}
 
 // {{{ vtk
@@ -1459,6 +2953,158 @@ void bfam_vtk_write_file(bfam_domain_t *domain, bfam_domain_match_t match,
 
 // }}}
 
+// {{{ pio
+/*
+ * Single file parallel output
+ *
+ * A step is written to one file by all the ranks with MPI-IO. All integers
+ * are int64_t and everything is in the byte order of the writer:
+ *
+ *   offset 0              bfam_pio_header_t (128 bytes)
+ *   names_offset          num_fields names, each '\0' terminated
+ *   index_offset          num_pieces bfam_pio_piece_t, in rank order
+ *   cells_offset          num_corners point numbers of the cell corners
+ *   data_offset           num_fields arrays of num_points reals
+ *
+ * The fields are _grid_x0, _grid_x1, _grid_x2 (zero when a subdomain does
+ * not have the coordinate) followed by the requested fields. Node n of
+ * element k of a piece is point point_offset + k * (N+1)^dim + n of each
+ * field array, in the node order of the subdomain.
+ *
+ * Each element is split into N^dim linear cells between its nodes, so the
+ * points and cells form an unstructured mesh of lines, quadrilaterals, or
+ * hexahedra. Cell m of a piece is cell cell_offset + m of the file and its
+ * 2^dim corners are entries corner_offset + m * 2^dim to
+ * corner_offset + (m + 1) * 2^dim - 1 of the corners, in the VTK order:
+ * (i,j,k), (i+1,j,k), (i+1,j+1,k), (i,j+1,k), and then the same with k+1,
+ * where i, j, k are the node indices in the element.
+ */
+
+/**
+ * header of a pio file
+ */
+typedef struct bfam_pio_header
+{
+  char magic[8];        /**< "bfampio" */
+  int64_t version;      /**< format version (2) */
+  int64_t byte_order;   /**< 0x0102030405060708 in the writer's byte order */
+  int64_t real_size;    /**< size of a real (4 or 8) */
+  int64_t num_fields;   /**< number of fields */
+  int64_t num_pieces;   /**< number of pieces (subdomains) */
+  int64_t num_points;   /**< number of points of each field */
+  double time;          /**< time of the step */
+  int64_t names_offset; /**< byte offset of the field names */
+  int64_t index_offset; /**< byte offset of the pieces */
+  int64_t data_offset;  /**< byte offset of the field data */
+  int64_t num_cells;    /**< number of cells */
+  int64_t num_corners;  /**< number of cell corners */
+  int64_t cells_offset; /**< byte offset of the cell corners */
+  int64_t reserved[2];
+} bfam_pio_header_t;
+
+/**
+ * index entry of a subdomain in a pio file
+ */
+typedef struct bfam_pio_piece
+{
+  int64_t rank;          /**< rank which wrote the subdomain */
+  int64_t id;            /**< subdomain id */
+  int64_t uid;           /**< subdomain user id (root id) */
+  int64_t dim;           /**< dimension of the elements */
+  int64_t N;             /**< polynomial order */
+  int64_t K;             /**< number of elements */
+  int64_t point_offset;  /**< first point of the subdomain */
+  int64_t cell_offset;   /**< first cell of the subdomain */
+  int64_t corner_offset; /**< first cell corner of the subdomain */
+} bfam_pio_piece_t;
+
+/** Write the matching dgx subdomains to one file with collective MPI-IO
+ *
+ * Each rank finds the offset of its pieces, points, cells, and cell corners
+ * with an exclusive scan of their counts and writes its part of the index,
+ * of the cell corners, and of each field collectively; rank 0 writes the
+ * header and the field names.
+ *
+ * \param [in] domain    domain to output
+ * \param [in] match     type of match for \a tags
+ * \param [in] tags      \c NULL terminated array of the tags to match
+ * \param [in] directory directory for the file (may be \c NULL)
+ * \param [in] prefix    the file is named \c prefix.pio
+ * \param [in] time      time of the step
+ * \param [in] fields    \c NULL terminated array of the fields to write
+ */
+void bfam_pio_write_file(bfam_domain_t *domain, bfam_domain_match_t match,
+                         const char **tags, const char *directory,
+                         const char *prefix, bfam_real_t time,
+                         const char **fields);
+
+/**
+ * pio file opened for reading
+ */
+typedef struct bfam_pio_file
+{
+  MPI_File fh;
+  bfam_pio_header_t header;
+  char *names;              /**< the field names */
+  const char **field_names; /**< name of each field */
+  bfam_pio_piece_t *pieces; /**< index of the pieces */
+} bfam_pio_file_t;
+
+/** Open a pio file for reading
+ *
+ * Collective over \a comm; rank 0 reads the header, the names, and the index
+ * and broadcasts them.
+ *
+ * \param [out] file     opened file
+ * \param [in]  comm     communicator of the readers
+ * \param [in]  filename name of the file
+ */
+void bfam_pio_open(bfam_pio_file_t *file, MPI_Comm comm, const char *filename);
+
+/** Close a pio file
+ *
+ * Collective over the communicator the file was opened with.
+ *
+ * \param [in,out] file file to close
+ */
+void bfam_pio_close(bfam_pio_file_t *file);
+
+/** Look up a field of a pio file
+ *
+ * \param [in] file file
+ * \param [in] name name of the field
+ *
+ * \return the field number or -1 if the file does not have the field.
+ */
+int bfam_pio_field(const bfam_pio_file_t *file, const char *name);
+
+/** Read points of a field of a pio file
+ *
+ * Each rank reads independently; the reals are converted if the file was
+ * written with a different precision.
+ *
+ * \param [in]  file  file
+ * \param [in]  field field number
+ * \param [in]  first first point to read
+ * \param [in]  count number of points to read
+ * \param [out] data  the points
+ */
+void bfam_pio_read(bfam_pio_file_t *file, int field, int64_t first,
+                   int64_t count, bfam_real_t *data);
+
+/** Read cell corners of a pio file
+ *
+ * Each rank reads independently.
+ *
+ * \param [in]  file    file
+ * \param [in]  first   first corner to read
+ * \param [in]  count   number of corners to read
+ * \param [out] corners the point numbers of the corners
+ */
+void bfam_pio_read_corners(bfam_pio_file_t *file, int64_t first, int64_t count,
+                           int64_t *corners);
+// }}}
+
 // {{{ pcg32
 // *Really* minimal PCG32 code / (c) 2014 M.E. O'Neill / pcg-random.org
 // Licensed under Apache License 2.0 (NO WARRANTY, etc. see website)
@@ -1494,7 +3140,7 @@ uint32_t bfam_pcg32_boundedrand_r(bfam_pcg32_random_t *rng, uint32_t bound);
 /* TODO: Determine why SINGLE doesn't work */
 
 #ifdef BFAMO_REAL_DOUBLE
-typedef double metric_real_t;
+typedef bfam_metric_real_t metric_real_t;
 #define occaMetric occaDouble
 typedef double bfamo_real_t;
 #define occaReal occaDouble
@@ -1506,7 +3152,7 @@ typedef double bfamo_real_t;
 #else
 typedef float bfamo_real_t;
 #define occaMetric occaDouble
-typedef double metric_real_t;
+typedef bfam_metric_real_t metric_real_t;
 #define occaReal occaFloat
 #define BFAMO_REAL_MAX FLT_MAX
 #define BFAMO_REAL(x) BFAM_APPEND(x, f)
@@ -1532,16 +3178,6 @@ typedef double metric_real_t;
 #define BFAMO_PXEST_CONNECT P4EST_CONNECT_FULL
 #define BFAMO_DIM 2
 
-#define ID_VGEO_JR0X0 0
-#define ID_VGEO_JR0X1 1
-#define ID_VGEO_JR1X0 2
-#define ID_VGEO_JR1X1 3
-#define ID_VGEO_JINV 4
-#define ID_VGEO_W 5
-#define ID_VGEO_X0 6
-#define ID_VGEO_X1 7
-#define NVGEO 8
-
 #define ID_SGEO_NX0 0
 #define ID_SGEO_NX1 1
 #define ID_SGEO_SJWJ 2
@@ -1561,23 +3197,6 @@ typedef double metric_real_t;
 #define BFAMO_PXEST_CONNECT P8EST_CONNECT_FULL
 #define BFAMO_DIM 3
 
-#define ID_VGEO_JR0X0 0
-#define ID_VGEO_JR0X1 1
-#define ID_VGEO_JR0X2 2
-#define ID_VGEO_JR1X0 3
-#define ID_VGEO_JR1X1 4
-#define ID_VGEO_JR1X2 5
-#define ID_VGEO_JINV 6
-#define ID_VGEO_JR2X0 7
-#define ID_VGEO_JR2X1 8
-#define ID_VGEO_JR2X2 9
-#define ID_VGEO_JINV2 10
-#define ID_VGEO_W 11
-#define ID_VGEO_X0 12
-#define ID_VGEO_X1 13
-#define ID_VGEO_X2 14
-#define NVGEO 15
-
 #define ID_SGEO_NX0 0
 #define ID_SGEO_NX1 1
 #define ID_SGEO_NX2 2
@@ -0,0 +1,42 @@
+/*
+  This file is part of p4est.
+  p4est is a C library to manage a collection (a forest) of multiple
+  connected adaptive quadtrees or octrees in parallel.
+
+  Copyright (C) 2010 The University of Texas System
+  Written by Carsten Burstedde, Lucas C. Wilcox, and Tobin Isaac
+
+  p4est is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  p4est is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with p4est; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include <p8est_trilinear.h>
+
+void
+p8est_trilinear_mesh_destroy (trilinear_mesh_t * mesh)
+{
+  P4EST_ASSERT (mesh->destructor == p8est_trilinear_mesh_destroy);
+  P4EST_ASSERT (mesh->extra_info == NULL);
+
+  P4EST_FREE (mesh->elem_table);
+  P4EST_FREE (mesh->node_table);
+  P4EST_FREE (mesh->fvnid_count_table);
+  P4EST_FREE (mesh->fvnid_interval_table);
+  sc_mempool_destroy (mesh->sharer_pool);
+
+  P4EST_FREE (mesh->elem_pids);
+  P4EST_FREE (mesh->node_pids);
+
+  P4EST_FREE (mesh);
+}
@@ -0,0 +1,43 @@
+/*
+  This file is part of p4est.
+  p4est is a C library to manage a collection (a forest) of multiple
+  connected adaptive quadtrees or octrees in parallel.
+
+  Copyright (C) 2010 The University of Texas System
+  Written by Carsten Burstedde, Lucas C. Wilcox, and Tobin Isaac
+
+  p4est is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  p4est is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with p4est; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+/********************************************************************
+ *                          IMPORTANT NOTE                          *
+ *                                                                  *
+ * The p4est_points functionality depends on sc/src/sc_sort.        *
+ * That parallel bitonic sort is still buggy (see sc/bugs).         *
+ * If you want to use this code you have to fix the sort first.     *
+ ********************************************************************/
+
+/*
+ * Usage: p8est_points <configuration> <level> <prefix>
+ *        possible configurations:
+ *        o unit      The unit cube.
+ *        o periodic  The unit cube with all-periodic boundary conditions.
+ *        o rotwrap   The unit cube with various self-periodic b.c.
+ *        o twocubes  Two connected cubes.
+ *        o rotcubes  A collection of four connected rotated cubes.
+ */
+
+#include <p4est_to_p8est.h>
+#include "points2.c"
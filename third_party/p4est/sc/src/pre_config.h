@@ -0,0 +1,294 @@
+/* src/pre_config.h.  Generated from pre_config.h.in by configure.  */
+/* src/pre_config.h.in.  Generated from configure.ac by autoheader.  */
+
+/* Define if building universal (internal helper macro) */
+/* #undef AC_APPLE_UNIVERSAL_BUILD */
+
+/* C compiler */
+#define CC "mpicc"
+
+/* C compiler flags */
+#define CFLAGS "-g -O2"
+
+/* C preprocessor */
+#define CPP "mpicc -E"
+
+/* C preprocessor flags */
+#define CPPFLAGS ""
+
+/* CXX compiler */
+#define CXX "mpicxx"
+
+/* CXX compiler flags */
+#define CXXFLAGS "-g -O2"
+
+/* Define to 1 if your C++ compiler doesn't accept -c and -o together. */
+/* #undef CXX_NO_MINUS_C_MINUS_O */
+
+/* DEPRECATED (use SC_ENABLE_DEBUG instead) */
+/* #undef DEBUG */
+
+/* enable debug mode (assertions and extra checks) */
+/* #undef ENABLE_DEBUG */
+
+/* Define to 1 if we are using MPI */
+#define ENABLE_MPI 1
+
+/* Define to 1 if we are using MPI I/O */
+#define ENABLE_MPIIO 1
+
+/* Define to 1 if we are using MPI_Init_thread */
+#define ENABLE_MPITHREAD 1
+
+/* enable POSIX threads (optionally use --enable-pthread=<PTHREAD_CFLAGS>) */
+/* #undef ENABLE_PTHREAD */
+
+/* F77 compiler */
+#define F77 "mpif77"
+
+/* Define to dummy `main' function (if any) required to link to the Fortran
+   libraries. */
+/* #undef F77_DUMMY_MAIN */
+
+/* Define to a macro mangling the given C identifier (in lower and upper
+   case), which must not contain underscores, for linking with Fortran. */
+#define F77_FUNC(name,NAME) name ## _
+
+/* As F77_FUNC, but for C identifiers containing underscores. */
+#define F77_FUNC_(name,NAME) name ## _
+
+/* Define to 1 if your Fortran compiler doesn't accept -c and -o together. */
+/* #undef F77_NO_MINUS_C_MINUS_O */
+
+/* FC compiler */
+#define FC "mpif90"
+
+/* FC compiler flags */
+#define FCFLAGS "-g -O2"
+
+/* Define to dummy `main' function (if any) required to link to the Fortran
+   libraries. */
+/* #undef FC_DUMMY_MAIN */
+
+/* Define if F77 and FC dummy `main' functions are identical. */
+/* #undef FC_DUMMY_MAIN_EQ_F77 */
+
+/* Define to a macro mangling the given C identifier (in lower and upper
+   case), which must not contain underscores, for linking with Fortran. */
+#define FC_FUNC(name,NAME) name ## _
+
+/* As FC_FUNC, but for C identifiers containing underscores. */
+#define FC_FUNC_(name,NAME) name ## _
+
+/* Define to 1 if your Fortran compiler doesn't accept -c and -o together. */
+/* #undef FC_NO_MINUS_C_MINUS_O */
+
+/* F77 compiler flags */
+#define FFLAGS "-g -O2"
+
+/* Define to 1 if you have the `backtrace' function. */
+#define HAVE_BACKTRACE 1
+
+/* Define to 1 if you have the `backtrace_symbols' function. */
+#define HAVE_BACKTRACE_SYMBOLS 1
+
+/* Define to 1 if you have the <dlfcn.h> header file. */
+#define HAVE_DLFCN_H 1
+
+/* Define to 1 if you have the <execinfo.h> header file. */
+#define HAVE_EXECINFO_H 1
+
+/* Define to 1 if you have the <inttypes.h> header file. */
+#define HAVE_INTTYPES_H 1
+
+/* Have we found function pthread_create. */
+#define HAVE_LPTHREAD 1
+
+/* Have we found function lua_createtable. */
+/* #undef HAVE_LUA */
+
+/* Define to 1 if you have the <lua5.1/lua.h> header file. */
+/* #undef HAVE_LUA5_1_LUA_H */
+
+/* Define to 1 if you have the <lua5.2/lua.h> header file. */
+/* #undef HAVE_LUA5_2_LUA_H */
+
+/* Define to 1 if you have the <lua.h> header file. */
+/* #undef HAVE_LUA_H */
+
+/* Define to 1 if you have the <memory.h> header file. */
+#define HAVE_MEMORY_H 1
+
+/* Define to 1 if you have the <signal.h> header file. */
+#define HAVE_SIGNAL_H 1
+
+/* Define to 1 if you have the <stdint.h> header file. */
+#define HAVE_STDINT_H 1
+
+/* Define to 1 if you have the <stdlib.h> header file. */
+#define HAVE_STDLIB_H 1
+
+/* Define to 1 if you have the <strings.h> header file. */
+#define HAVE_STRINGS_H 1
+
+/* Define to 1 if you have the <string.h> header file. */
+#define HAVE_STRING_H 1
+
+/* Define to 1 if you have the `strtol' function. */
+#define HAVE_STRTOL 1
+
+/* Define to 1 if you have the `strtoll' function. */
+#define HAVE_STRTOLL 1
+
+/* Define to 1 if you have the <sys/stat.h> header file. */
+#define HAVE_SYS_STAT_H 1
+
+/* Define to 1 if you have the <sys/time.h> header file. */
+#define HAVE_SYS_TIME_H 1
+
+/* Define to 1 if you have the <sys/types.h> header file. */
+#define HAVE_SYS_TYPES_H 1
+
+/* Define to 1 if you have the <time.h> header file. */
+#define HAVE_TIME_H 1
+
+/* Define to 1 if you have the <unistd.h> header file. */
+#define HAVE_UNISTD_H 1
+
+/* Have we found function adler32_combine. */
+#define HAVE_ZLIB 1
+
+/* Define to 1 on a bigendian machine */
+/* #undef IS_BIGENDIAN */
+
+/* Linker flags */
+#define LDFLAGS ""
+
+/* Libraries */
+#define LIBS "  -lz -lm   "
+
+/* minimal log priority */
+/* #undef LOG_PRIORITY */
+
+/* Define to the sub-directory in which libtool stores uninstalled libraries.
+   */
+#define LT_OBJDIR ".libs/"
+
+/* DEPRECATED (use SC_ENABLE_MPI instead) */
+#define MPI 1
+
+/* DEPRECATED (use SC_ENABLE_MPIIO instead) */
+#define MPIIO 1
+
+/* Define to 1 if your C compiler doesn't accept -c and -o together. */
+/* #undef NO_MINUS_C_MINUS_O */
+
+/* Name of package */
+#define PACKAGE "libsc"
+
+/* Define to the address where bug reports for this package should be sent. */
+#define PACKAGE_BUGREPORT "p4est@librelist.com"
+
+/* Define to the full name of this package. */
+#define PACKAGE_NAME "libsc"
+
+/* Define to the full name and version of this package. */
+#define PACKAGE_STRING "libsc 1.1"
+
+/* Define to the one symbol short name of this package. */
+#define PACKAGE_TARNAME "libsc"
+
+/* Define to the home page for this package. */
+#define PACKAGE_URL ""
+
+/* Define to the version of this package. */
+#define PACKAGE_VERSION "1.1"
+
+/* DEPRECATED (use SC_WITH_PAPI instead) */
+/* #undef PAPI */
+
+/* Use builtin getopt */
+/* #undef PROVIDE_GETOPT */
+
+/* Use builtin obstack */
+/* #undef PROVIDE_OBSTACK */
+
+/* DEPRECATED (use SC_ENABLE_PTHREAD instead) */
+/* #undef PTHREAD */
+
+/* The size of `long', as computed by sizeof. */
+#define SIZEOF_LONG 8
+
+/* The size of `long long', as computed by sizeof. */
+#define SIZEOF_LONG_LONG 8
+
+/* The size of `unsigned long', as computed by sizeof. */
+#define SIZEOF_UNSIGNED_LONG 8
+
+/* The size of `unsigned long long', as computed by sizeof. */
+#define SIZEOF_UNSIGNED_LONG_LONG 8
+
+/* Define to 1 if you have the ANSI C header files. */
+#define STDC_HEADERS 1
+
+/* Version number of package */
+#define VERSION "1.1"
+
+/* Package major version */
+#define VERSION_MAJOR 1
+
+/* Package minor version */
+#define VERSION_MINOR 1
+
+/* Package point version */
+#define VERSION_POINT 1.1
+
+/* Define to 1 if BLAS is used */
+/* #undef WITH_BLAS */
+
+/* Define to 1 if LAPACK is used */
+/* #undef WITH_LAPACK */
+
+/* enable Flop counting with papi */
+/* #undef WITH_PAPI */
+
+/* Define WORDS_BIGENDIAN to 1 if your processor stores words with the most
+   significant byte first (like Motorola and SPARC, unlike Intel). */
+#if defined AC_APPLE_UNIVERSAL_BUILD
+# if defined __BIG_ENDIAN__
+#  define WORDS_BIGENDIAN 1
+# endif
+#else
+# ifndef WORDS_BIGENDIAN
+/* #  undef WORDS_BIGENDIAN */
+# endif
+#endif
+
+/* Define to empty if `const' does not conform to ANSI C. */
+/* #undef const */
+
+/* Define to `__inline__' or `__inline' if that's what the C compiler
+   calls it, or to nothing if 'inline' is not supported under any name.  */
+#ifndef __cplusplus
+/* #undef inline */
+#endif
+
+/* Define to the equivalent of the C99 'restrict' keyword, or to
+   nothing if this is not supported.  Do not define if restrict is
+   supported directly.  */
+#define restrict __restrict
+/* Work around a bug in Sun C++: it does not support _Restrict or
+   __restrict__, even though the corresponding Sun C compiler ends up with
+   "#define restrict _Restrict" or "#define restrict __restrict__" in the
+   previous line.  Perhaps some future version of Sun C++ will work with
+   restrict; if so, hopefully it defines __RESTRICT like Sun C does.  */
+#if defined __SUNPRO_CC && !defined __RESTRICT
+# define _Restrict
+# define __restrict__
+#endif
+
+/* Define to `unsigned int' if <sys/types.h> does not define. */
+/* #undef size_t */
+
+/* Define to `int' if <sys/types.h> does not define. */
+/* #undef ssize_t */